@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ * A C interface to render MPM performances of MSM scores, e.g. for WebAssembly and FFI hosts.
+ *
+ * The result of a rendering is held as flat arrays, one entry per note, that the host can view
+ * in place (e.g. as typed arrays over the WebAssembly memory) instead of parsing XML. All arrays
+ * of a rendering have the same length, the number of notes; entry i of each array belongs to the
+ * same note. The notes are sorted by their milliseconds onset, simultaneous notes are in part
+ * and document order.
+ *
+ * Objects are created by the meico_*_load*() and meico_render*() functions and must be released
+ * with the matching meico_*_free() function. The arrays and strings that are returned stay valid
+ * until the object they belong to is freed. Functions that fail return NULL (or 0) and set an
+ * error message that meico_last_error() returns; no exceptions cross the interface.
+ *
+ * Loaded MSM and MPM objects are only read by the rendering functions, so one MSM and one MPM
+ * can be rendered from several threads at once. Freeing an object while another thread uses it
+ * is not allowed. The error message is kept per thread.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/emscripten.h>
+#define MEICO_API EMSCRIPTEN_KEEPALIVE
+#elif defined(__GNUC__)
+#define MEICO_API __attribute__((visibility("default")))
+#else
+#define MEICO_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct meico_msm meico_msm;                 /* an MSM score */
+typedef struct meico_mpm meico_mpm;                 /* an MPM document with one or more performances */
+typedef struct meico_rendering meico_rendering;     /* the rendered notes of a performance */
+
+/* the version of this interface, incremented when a function changes incompatibly */
+#define MEICO_API_VERSION 1
+
+MEICO_API int meico_api_version(void);
+
+/* the message of the last error of the calling thread, an empty string if there was none */
+MEICO_API const char* meico_last_error(void);
+
+/* load an MSM from UTF-8 XML code of the given length in bytes, or from a file */
+MEICO_API meico_msm* meico_msm_load(const char* xml, size_t length);
+MEICO_API meico_msm* meico_msm_load_file(const char* path);
+MEICO_API void meico_msm_free(meico_msm* msm);
+
+/* load an MPM from UTF-8 XML code of the given length in bytes, or from a file */
+MEICO_API meico_mpm* meico_mpm_load(const char* xml, size_t length);
+MEICO_API meico_mpm* meico_mpm_load_file(const char* path);
+MEICO_API void meico_mpm_free(meico_mpm* mpm);
+
+/* the performances of an MPM */
+MEICO_API size_t meico_mpm_performance_count(const meico_mpm* mpm);
+MEICO_API const char* meico_mpm_performance_name(const meico_mpm* mpm, size_t index);
+
+/*
+ * Render a performance of an MPM into an MSM, addressed by its index or its name. The MSM is
+ * not modified, the MPM and MSM can be freed after the call.
+ */
+MEICO_API meico_rendering* meico_render(const meico_mpm* mpm, size_t performance, const meico_msm* msm);
+MEICO_API meico_rendering* meico_render_by_name(const meico_mpm* mpm, const char* performance, const meico_msm* msm);
+MEICO_API void meico_rendering_free(meico_rendering* rendering);
+
+/* the number of notes, i.e. the length of each of the note arrays */
+MEICO_API size_t meico_rendering_note_count(const meico_rendering* rendering);
+
+/* the note arrays; each function writes the number of entries to length if it is not NULL */
+MEICO_API const double* meico_rendering_onsets(const meico_rendering* rendering, size_t* length);       /* onsets in milliseconds */
+MEICO_API const double* meico_rendering_durations(const meico_rendering* rendering, size_t* length);    /* durations in milliseconds */
+MEICO_API const double* meico_rendering_pitches(const meico_rendering* rendering, size_t* length);      /* MIDI pitches */
+MEICO_API const double* meico_rendering_velocities(const meico_rendering* rendering, size_t* length);   /* velocities */
+MEICO_API const uint32_t* meico_rendering_parts(const meico_rendering* rendering, size_t* length);      /* MSM part indices */
+
+/* the MSM parts that the part indices refer to; the channel is -1 if the part has none */
+MEICO_API size_t meico_rendering_part_count(const meico_rendering* rendering);
+MEICO_API const char* meico_rendering_part_name(const meico_rendering* rendering, size_t part);
+MEICO_API int meico_rendering_part_channel(const meico_rendering* rendering, size_t part);
+
+#ifdef __cplusplus
+}
+#endif
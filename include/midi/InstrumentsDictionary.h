@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace meico {
+namespace midi {
+
+/**
+ * A helper class to map instrument names to General MIDI program change numbers and back.
+ * Ported from Java InstrumentsDictionary class. The Java version searches a dictionary of
+ * instrument names (resources/instuments.dict) by string similarity; this port knows only the
+ * 128 General MIDI default names, which it compares case-insensitively.
+ * @author Axel Berndt (original Java), C++ port
+ */
+class InstrumentsDictionary {
+public:
+    static const char* const DEFAULT_NAMES[128];    // the General MIDI names in the order of the program change numbers
+
+    /**
+     * Get the program change number of an instrument name
+     * @param name an instrument's name string
+     * @return the program change number; if the instrument is unknown, 0 (Acoustic Grand Piano)
+     */
+    static int getProgramChange(std::string_view name);
+
+    /**
+     * Get the General MIDI name of a program change number
+     * @param programChangeNumber the program change number
+     * @return the instrument's name or an empty string if the number is not in [0, 127]
+     */
+    static std::string getInstrumentName(int programChangeNumber);
+};
+
+} // namespace midi
+} // namespace meico
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace meico {
+namespace msm {
+class Msm;
+}
+namespace midi {
+
+/**
+ * This class holds a Standard MIDI File as its bytes, e.g. the result of Msm::exportMidi().
+ * Ported from Java Midi class; the Java version holds a javax.sound.midi.Sequence instead.
+ * @author Axel Berndt (original Java), C++ port
+ */
+class Midi {
+private:
+    std::vector<uint8_t> data;                  // the bytes of the file
+    std::string file;                           // the file path
+
+public:
+    /**
+     * Default constructor, an empty MIDI
+     */
+    Midi() = default;
+
+    /**
+     * Constructor
+     * @param data the bytes of a Standard MIDI File
+     * @param file the file path or an empty string
+     */
+    explicit Midi(std::vector<uint8_t> data, const std::string& file = "");
+
+    /**
+     * Constructor, reads a Standard MIDI File
+     * @param filePath the file path
+     */
+    explicit Midi(const std::string& filePath);
+
+    /**
+     * Check if there is no data
+     * @return true if empty
+     */
+    bool isEmpty() const { return data.empty(); }
+
+    /**
+     * Get the bytes of the file
+     * @return the bytes
+     */
+    const std::vector<uint8_t>& getData() const { return data; }
+
+    /**
+     * Get the size of the file
+     * @return the number of bytes
+     */
+    size_t size() const { return data.size(); }
+
+    /**
+     * Get the file path
+     * @return file path
+     */
+    const std::string& getFile() const { return file; }
+
+    /**
+     * Set the file path
+     * @param filePath the file path
+     */
+    void setFile(const std::string& filePath) { file = filePath; }
+
+    /**
+     * Get the timing resolution from the file header
+     * @return the pulses per quarter or 0 if the data has no valid header
+     */
+    int getPPQ() const;
+
+    /**
+     * Get the number of tracks from the file header
+     * @return the number of tracks or 0 if the data has no valid header
+     */
+    int getTrackCount() const;
+
+    /**
+     * Write the MIDI file to the file path
+     * @return true if successful
+     */
+    bool writeMidi() const;
+
+    /**
+     * Write the MIDI file
+     * @param filename the output file path
+     * @return true if successful
+     */
+    bool writeMidi(const std::string& filename) const;
+
+    /**
+     * Convert the MIDI data to MSM, see Midi2MsmConverter
+     * @param useDefaultInstrumentNames if true, parts without a track name are named after the General MIDI instrument of their first program change
+     * @param cleanup if true, empty maps and parts without notes are removed
+     * @return the MSM or nullptr if the data cannot be converted
+     */
+    std::unique_ptr<msm::Msm> exportMsm(bool useDefaultInstrumentNames = true, bool cleanup = true) const;
+};
+
+} // namespace midi
+} // namespace meico
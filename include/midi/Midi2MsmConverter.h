@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+
+namespace meico {
+namespace msm {
+class Msm;
+}
+namespace midi {
+
+class Midi;
+
+/**
+ * This class does the conversion from MIDI to MSM, see Midi::exportMsm().
+ * Ported from Java Midi2MsmConverter class. The file is decoded with an SmfReader directly from
+ * the bytes of the Midi object and the MSM is built in the same pass: each channel of each track
+ * becomes a part, a note on opens a note element that the matching note off closes. Open notes
+ * are kept on a stack per channel and pitch, so overlapping notes of the same pitch are closed
+ * from the latest one.
+ *
+ * MSM is symbolic, tempo events are not converted. A text event immediately before a note on at
+ * the same tick is read as the note's id, that is how Msm::exportMidi() writes the ids.
+ * @author Axel Berndt (original Java), C++ port
+ */
+class Midi2MsmConverter {
+public:
+    /**
+     * Convert MIDI to MSM
+     * @param midi the MIDI data
+     * @param useDefaultInstrumentNames if true, parts without a track name are named after the General MIDI instrument of their first program change
+     * @param cleanup if true, empty maps and parts without notes are removed
+     * @return the MSM or nullptr if the data is not a Standard MIDI File with PPQ timing
+     */
+    static std::unique_ptr<msm::Msm> convert(const Midi& midi, bool useDefaultInstrumentNames, bool cleanup);
+};
+
+} // namespace midi
+} // namespace meico
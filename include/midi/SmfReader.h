@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace meico {
+namespace midi {
+
+/**
+ * A reader for Standard MIDI Files (formats 0 and 1) over a memory buffer. Nothing is copied:
+ * the tracks are walked with cursors that decode one event at a time, the payloads of meta and
+ * system exclusive events are views into the buffer. So the buffer must outlive the reader and
+ * its events.
+ *
+ * The tracks are located when the reader is constructed; a truncated or malformed track ends at
+ * the defect, its cursor reports the error.
+ */
+class SmfReader {
+public:
+    static const uint8_t META_EVENT = 0xFF;
+    static const uint8_t SYSTEM_EXCLUSIVE = 0xF0;
+    static const uint8_t SYSTEM_EXCLUSIVE_CONTINUATION = 0xF7;
+
+    /**
+     * A decoded event
+     */
+    struct Event {
+        int64_t tick;                           // the absolute tick within the track
+        uint8_t status;                         // channel message status byte with the channel, META_EVENT or a system exclusive status
+        uint8_t data1;                          // first data byte or meta type
+        uint8_t data2;                          // second data byte, 0 for messages with one data byte
+        const uint8_t* data;                    // the payload of a meta or system exclusive event in the buffer
+        uint32_t dataLength;
+
+        bool isMeta() const { return status == META_EVENT; }
+        bool isChannelMessage() const { return status < SYSTEM_EXCLUSIVE; }
+        int getCommand() const { return status & 0xF0; }
+        int getChannel() const { return status & 0x0F; }
+
+        /**
+         * Get the payload as text, e.g. of a track name
+         * @return a view into the buffer
+         */
+        std::string_view getText() const { return std::string_view(reinterpret_cast<const char*>(data), dataLength); }
+    };
+
+    /**
+     * A cursor over the events of one track
+     */
+    class Track {
+    private:
+        const uint8_t* position = nullptr;
+        const uint8_t* end = nullptr;
+        int64_t tick = 0;
+        uint8_t runningStatus = 0;
+        bool error = false;
+
+    public:
+        Track() = default;
+        Track(const uint8_t* begin, const uint8_t* end) : position(begin), end(end) {}
+
+        /**
+         * Decode the next event
+         * @param event receives the event
+         * @return false at the end of the track, after its end of track event or at a defect
+         */
+        bool next(Event& event);
+
+        /**
+         * Check if the track ended at a defect instead of its end
+         * @return true if the track is malformed or truncated
+         */
+        bool hasError() const { return error; }
+
+        /**
+         * Get the tick of the last decoded event
+         * @return the tick
+         */
+        int64_t getTick() const { return tick; }
+
+    private:
+        bool readVariableLength(uint32_t& value);
+    };
+
+private:
+    int format = -1;
+    int division = 0;
+    std::vector<std::pair<const uint8_t*, const uint8_t*>> tracks;   // the begin and end of each track chunk's data
+
+public:
+    /**
+     * Constructor
+     * @param data the bytes of the file, they are not copied
+     * @param size the number of bytes
+     */
+    SmfReader(const uint8_t* data, size_t size);
+
+    /**
+     * Check if the buffer starts with a valid header chunk
+     * @return true if valid
+     */
+    bool isValid() const { return format >= 0; }
+
+    /**
+     * Get the file format
+     * @return 0 (one track), 1 (simultaneous tracks), 2 (independent tracks) or -1 if invalid
+     */
+    int getFormat() const { return format; }
+
+    /**
+     * Get the timing resolution
+     * @return the pulses per quarter or 0 for SMPTE timing or an invalid file
+     */
+    int getPPQ() const { return (division & 0x8000) ? 0 : division; }
+
+    /**
+     * Get the number of track chunks found in the buffer
+     * @return the number of tracks
+     */
+    size_t getTrackCount() const { return tracks.size(); }
+
+    /**
+     * Get a cursor at the beginning of a track
+     * @param index the index of the track
+     * @return the cursor
+     */
+    Track getTrack(size_t index) const { return Track(tracks[index].first, tracks[index].second); }
+};
+
+} // namespace midi
+} // namespace meico
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace meico {
+namespace midi {
+
+/**
+ * A writer for Standard MIDI Files (format 1). The events are collected as fixed-size records,
+ * the payloads of the meta events go to one shared byte pool, so adding an event does not
+ * allocate once the capacity has been reserved. When the file is written, the events are sorted
+ * by track and tick, the exact size of the file is computed and the bytes are written into one
+ * buffer of that size.
+ *
+ * Events at the same tick keep the order in which they were added, like in a javax.sound.midi
+ * Track. The channel messages are written with running status.
+ */
+class SmfWriter {
+public:
+    // meta event types, see the Java EventMaker
+    static const uint8_t META_TEXT_EVENT = 0x01;
+    static const uint8_t META_TRACK_NAME = 0x03;
+    static const uint8_t META_INSTRUMENT_NAME = 0x04;
+    static const uint8_t META_MARKER = 0x06;
+    static const uint8_t META_MIDI_CHANNEL_PREFIX = 0x20;
+    static const uint8_t META_MIDI_PORT = 0x21;
+    static const uint8_t META_END_OF_TRACK = 0x2F;
+    static const uint8_t META_SET_TEMPO = 0x51;
+    static const uint8_t META_TIME_SIGNATURE = 0x58;
+    static const uint8_t META_KEY_SIGNATURE = 0x59;
+
+    // channel message status bytes without the channel
+    static const uint8_t NOTE_OFF = 0x80;
+    static const uint8_t NOTE_ON = 0x90;
+    static const uint8_t CONTROL_CHANGE = 0xB0;
+    static const uint8_t PROGRAM_CHANGE = 0xC0;
+
+private:
+    static const uint8_t META_EVENT = 0xFF;
+
+    /**
+     * An event; channel messages carry their data bytes, meta events refer to their payload in the pool
+     */
+    struct Event {
+        int64_t tick;
+        uint32_t track;
+        uint32_t sequence;                      // the order in which the events were added
+        uint32_t dataOffset;                    // the payload of a meta event in the pool
+        uint32_t dataLength;
+        uint8_t status;                         // channel message status byte or META_EVENT
+        uint8_t data1;                          // first data byte or meta type
+        uint8_t data2;
+    };
+
+    int ppq;
+    uint32_t trackCount = 0;
+    std::vector<Event> events;
+    std::vector<uint8_t> pool;
+    bool sorted = true;
+
+public:
+    /**
+     * Constructor
+     * @param ppq the pulses per quarter of the ticks
+     */
+    explicit SmfWriter(int ppq);
+
+    /**
+     * Get the timing resolution
+     * @return the pulses per quarter
+     */
+    int getPPQ() const { return ppq; }
+
+    /**
+     * Reserve capacity, so that adding events does not allocate
+     * @param eventCount the number of events
+     * @param payloadBytes the total number of bytes of the meta events' texts and data
+     */
+    void reserve(size_t eventCount, size_t payloadBytes);
+
+    /**
+     * Start a new track, all further events are added to it
+     * @return the index of the track
+     */
+    uint32_t addTrack();
+
+    /**
+     * Get the number of tracks
+     * @return the number of tracks
+     */
+    uint32_t getTrackCount() const { return trackCount; }
+
+    /**
+     * Get the number of events, without the end of track events
+     * @return the number of events
+     */
+    size_t getEventCount() const { return events.size(); }
+
+    // channel messages; negative ticks are written at tick 0, data bytes are clamped to [0, 127]
+    void addNoteOn(int64_t tick, int channel, int pitch, int velocity);
+    void addNoteOff(int64_t tick, int channel, int pitch, int velocity);
+    void addControlChange(int64_t tick, int channel, int controller, int value);
+    void addProgramChange(int64_t tick, int channel, int program);
+
+    /**
+     * Add a tempo event
+     * @param tick the tick
+     * @param bpm beats per minute
+     * @param beatLength the length of one beat, e.g. 0.25 for quarters
+     */
+    void addTempo(int64_t tick, double bpm, double beatLength);
+
+    /**
+     * Add a time signature event
+     * @param tick the tick
+     * @param numerator the numerator
+     * @param denominator the denominator, a power of 2
+     */
+    void addTimeSignature(int64_t tick, int numerator, int denominator);
+
+    /**
+     * Add a key signature event
+     * @param tick the tick
+     * @param accidentals the number of sharps (positive) or flats (negative)
+     */
+    void addKeySignature(int64_t tick, int accidentals);
+
+    /**
+     * Add a text meta event, e.g. a track name or a marker
+     * @param tick the tick
+     * @param type the meta type, e.g. META_TRACK_NAME
+     * @param text the text
+     */
+    void addText(int64_t tick, uint8_t type, std::string_view text);
+
+    void addMidiPort(int64_t tick, int port);
+    void addChannelPrefix(int64_t tick, int channel);
+
+    /**
+     * Compute the exact size of the file
+     * @return the number of bytes
+     */
+    size_t getSize();
+
+    /**
+     * Write the file into a buffer
+     * @param buffer the buffer
+     * @param capacity the size of the buffer, at least getSize()
+     * @return the number of bytes written or 0 if the buffer is too small
+     */
+    size_t write(uint8_t* buffer, size_t capacity);
+
+    /**
+     * Write the file into a byte vector that is sized once
+     * @return the file
+     */
+    std::vector<uint8_t> toBytes();
+
+private:
+    void addChannelMessage(int64_t tick, uint8_t status, int channel, int data1, int data2);
+    void addMeta(int64_t tick, uint8_t type, const uint8_t* data, size_t length);
+
+    /**
+     * Sort the events by track and tick if events have been added since the last sort
+     */
+    void sort();
+
+    /**
+     * Encode the file; the same pass computes the size when no output is given
+     * @param out the buffer or nullptr to count the bytes only
+     * @return the number of bytes
+     */
+    size_t encode(uint8_t* out) const;
+};
+
+} // namespace midi
+} // namespace meico
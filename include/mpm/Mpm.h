@@ -3,6 +3,9 @@
 #include "msm/AbstractMsm.h"
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace meico {
 namespace mpm {
@@ -45,8 +48,22 @@ public:
     static const std::string IMPRECISION_MAP_TUNING;
 
 private:
+    /**
+     * An entry of the performance index. Parsing the document only records the name, id and
+     * element of each performance; the Performance object with its maps is built from the
+     * element when it is accessed for the first time.
+     */
+    struct PerformanceEntry {
+        std::string name;                           // the name attribute, or the name of an added performance
+        std::string id;                             // the xml:id attribute
+        Element xml;                                // the performance element, empty for added performances
+        std::unique_ptr<Performance> performance;   // nullptr until the performance is materialized
+    };
+
     std::unique_ptr<Metadata> metadata;
-    std::vector<std::unique_ptr<Performance>> performances;
+    mutable std::vector<PerformanceEntry> performances;
+    std::unordered_map<std::string, size_t> performanceIndex;  // the index of the first performance of each name
+    mutable std::mutex materializeMutex;            // performances may be materialized by concurrent const accesses
 
 public:
     /**
@@ -99,19 +116,49 @@ public:
     static std::unique_ptr<Mpm> createMpm();
 
     /**
-     * Get the number of performances
+     * Get the number of performances; this does not materialize any of them
      * @return number of performances
      */
     size_t size() const;
 
     /**
-     * Get performance by index
+     * Get performance by index; it is materialized from the document if this is the first access
      * @param index the performance index
      * @return performance or nullptr if index out of bounds
      */
     Performance* getPerformance(size_t index);
     const Performance* getPerformance(size_t index) const;
 
+    /**
+     * Get a performance by name; it is materialized from the document if this is the first access.
+     * If the mpm holds more than one performance with this name, this method returns only the first.
+     * @param name the name
+     * @return the performance or nullptr if there is no performance with this name
+     */
+    Performance* getPerformance(const std::string& name);
+    const Performance* getPerformance(const std::string& name) const;
+
+    /**
+     * Get the name of a performance without materializing it
+     * @param index the performance index
+     * @return the name or an empty string if index out of bounds
+     */
+    std::string getPerformanceName(size_t index) const;
+
+    /**
+     * Get the xml:id of a performance without materializing it
+     * @param index the performance index
+     * @return the id or an empty string if index out of bounds or the performance has no id
+     */
+    std::string getPerformanceId(size_t index) const;
+
+    /**
+     * Check if a performance has been materialized already
+     * @param index the performance index
+     * @return true if the Performance object exists
+     */
+    bool isPerformanceMaterialized(size_t index) const;
+
     /**
      * Add a performance
      * @param performance the performance to add
@@ -138,9 +185,23 @@ private:
     void init();
 
     /**
-     * Parse data from XML document
+     * Parse data from XML document; this builds the performance index with one shallow pass over the root's children
      */
     void parseData();
+
+    /**
+     * Get a performance, build it from its element if it does not exist yet
+     * @param index the performance index
+     * @return the performance or nullptr if index out of bounds
+     */
+    Performance* materializePerformance(size_t index) const;
+
+    /**
+     * Find the first performance with a name
+     * @param name the name
+     * @return the index or -1 if there is no such performance
+     */
+    long findPerformance(const std::string& name) const;
 };
 
 } // namespace mpm
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
+namespace mpm {
+
+// Forward declarations
+class Performance;
+class Dated;
+
+/**
+ * A binary cache of compiled performances. It holds everything a performance has derived from
+ * its MPM source: the date-sorted map entries with their resolved values, the end dates, the
+ * Bézier control points of dynamics and movement transitions and the tempo map's milliseconds
+ * timing. Loading it restores the maps without parsing, sorting or numerical integration; the
+ * file is memory mapped and the entries are read from the mapping in one pass.
+ *
+ * The cache stores the hash of the MPM source it was compiled from. load() recompiles the
+ * performance from the MPM file and rewrites the cache if the hash does not match, if the cache
+ * was written by another format version or on a host with another byte order.
+ *
+ * A performance that is read from the cache is detached from the XML: getXml() of it and of its
+ * maps returns an empty element.
+ */
+class PerformanceCache {
+public:
+    static const char MAGIC[8];                 // the first bytes of a cache file
+    static const uint32_t VERSION;              // increment this when the layout of a record changes
+
+    /**
+     * Compute the 64 bit FNV-1a hash of a byte sequence
+     * @param data the bytes
+     * @param length the number of bytes
+     * @param seed the hash to continue, e.g. of the preceding bytes
+     * @return the hash
+     */
+    static uint64_t hash(const char* data, size_t length, uint64_t seed = 14695981039346656037ULL);
+
+    /**
+     * Compute the hash of a file's content
+     * @param filePath the file path
+     * @param hashValue receives the hash
+     * @return false if the file cannot be read
+     */
+    static bool hashFile(const std::string& filePath, uint64_t& hashValue);
+
+    /**
+     * Compile a performance into the cache format. The maps are prepared for rendering at the
+     * performance's ppq first, so the cache holds their compiled state.
+     * @param performance the performance
+     * @param sourceHash the hash of the source that the performance was compiled from
+     * @return the cache data
+     */
+    static std::string serialize(const Performance& performance, uint64_t sourceHash);
+
+    /**
+     * Restore a performance from cache data
+     * @param data the cache data
+     * @param length the number of bytes
+     * @param sourceHash the hash of the current source; the cache is stale if it was compiled from another one
+     * @return the performance or nullptr if the data is stale, of another version or invalid
+     */
+    static std::unique_ptr<Performance> deserialize(const char* data, size_t length, uint64_t sourceHash);
+
+    /**
+     * Write a performance to a cache file
+     * @param performance the performance
+     * @param cachePath the cache file path
+     * @param sourceHash the hash of the source that the performance was compiled from
+     * @return true if the file was written
+     */
+    static bool writeToFile(const Performance& performance, const std::string& cachePath, uint64_t sourceHash);
+
+    /**
+     * Read a performance from a cache file
+     * @param cachePath the cache file path
+     * @param sourceHash the hash of the current source
+     * @return the performance or nullptr if there is no valid, up to date cache
+     */
+    static std::unique_ptr<Performance> readFromFile(const std::string& cachePath, uint64_t sourceHash);
+
+    /**
+     * Load a performance of an MPM file through its cache. If the cache is missing or stale, the
+     * performance is compiled from the MPM file and the cache is rewritten.
+     * @param mpmPath the MPM file path
+     * @param cachePath the cache file path
+     * @param performanceIndex the index of the performance in the MPM
+     * @return the performance or nullptr if the MPM file has no such performance
+     * @throws ParsingException if the MPM file has to be parsed and is not well-formed
+     */
+    static std::unique_ptr<Performance> load(const std::string& mpmPath, const std::string& cachePath, size_t performanceIndex = 0);
+
+private:
+    /**
+     * Write cache data to a file; it is written to a temporary file first and renamed, so that
+     * concurrent readers never see a partial cache
+     * @param data the cache data
+     * @param cachePath the cache file path
+     * @return true if the file was written
+     */
+    static bool writeData(const std::string& data, const std::string& cachePath);
+
+    /**
+     * Write the maps of a dated container, each one as its type followed by a length-prefixed record
+     * @param writer the writer
+     * @param dated the container or nullptr
+     */
+    static void writeDated(supplementary::BinaryWriter& writer, const Dated* dated);
+
+    /**
+     * Read the maps of a dated container
+     * @param reader the reader
+     * @param dated the container that receives the maps
+     * @return false if the data is invalid
+     */
+    static bool readDated(supplementary::BinaryReader& reader, Dated& dated);
+};
+
+} // namespace mpm
+} // namespace meico
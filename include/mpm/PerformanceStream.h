@@ -0,0 +1,159 @@
+#pragma once
+
+#include "msm/NoteTable.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace meico {
+namespace msm {
+    class Msm;
+}
+
+namespace mpm {
+
+// Forward declarations
+class Performance;
+class GenericMap;
+class TempoMap;
+
+/**
+ * A stream of the MIDI events of a performance for playback. It is pulled in time slices:
+ * each call of next() returns the note and control change events of the next milliseconds in
+ * time order. The notes are rendered incrementally, the score of each part is cut into windows
+ * of symbolic time (see setWindowLength()) and a window is rendered with the part's maps when
+ * the stream reaches it. So the first events are available after the first window has been
+ * rendered, not after the whole piece.
+ *
+ * The maps are local in symbolic time, windows end between dates, so the rendered notes are the
+ * same as those of Performance::performOverlay(). A part is rendered ahead until the earliest
+ * note of its last rendered window lies behind the requested time. A note that a map moves
+ * before that, e.g. by a large asynchrony, is returned with the next call and its original time.
+ *
+ * In contrast to the expressive MIDI export the velocities are clamped to the MIDI range instead
+ * of being compressed, because the range of the whole piece is not known in advance. The channel
+ * volume events of sub-note dynamics are rendered when the stream is opened.
+ */
+class PerformanceStream {
+public:
+    /**
+     * The types of the events, in the order in which simultaneous events are returned
+     */
+    enum class EventType : uint8_t {
+        CONTROL_CHANGE,
+        NOTE_OFF,
+        NOTE_ON
+    };
+
+    /**
+     * An event; the channel and port are those of the MSM part
+     */
+    struct Event {
+        double milliseconds;                    // the time of the event
+        EventType type;
+        uint8_t channel;
+        uint8_t data1;                          // the pitch or the controller number
+        uint8_t data2;                          // the velocity or the controller value
+        uint16_t part;                          // the index of the MSM part
+        uint16_t port;
+    };
+
+    static const int CC_CHANNEL_VOLUME = 7;
+
+private:
+    /**
+     * The rendering state of one MSM part
+     */
+    struct PartStream {
+        msm::NoteTable score;                   // the compiled notes of the part
+        std::vector<size_t> rows;               // the rows with a date, in date order
+        size_t nextRow = 0;                     // the first row that has not been rendered
+        std::vector<GenericMap*> maps;
+        const TempoMap* tempoMap = nullptr;
+        double frontier;                        // the earliest milliseconds date of the last rendered window
+        uint16_t part;
+        uint8_t channel;
+        uint16_t port;
+    };
+
+    /**
+     * An event in the queue, the sequence keeps simultaneous events of the same type in the order they were rendered
+     */
+    struct QueuedEvent {
+        Event event;
+        uint64_t sequence;
+    };
+
+    const Performance& performance;
+    std::vector<PartStream> parts;
+    msm::NoteTable window;                      // the notes of the window that is rendered, reused for all windows
+    std::vector<QueuedEvent> queue;             // a min-heap of the rendered events that have not been returned
+    uint64_t sequence = 0;
+    double position = 0.0;                      // the end of the last time slice
+    double windowLength;                        // in ticks
+    size_t renderedWindows = 0;
+
+public:
+    /**
+     * Constructor; the parts are compiled and the channel volume of sub-note dynamics is rendered,
+     * the notes are rendered on demand. The performance and the MSM must outlive the stream.
+     * @param performance the performance
+     * @param msm the input MSM; parts without a MIDI channel are skipped like in the MIDI export
+     */
+    PerformanceStream(const Performance& performance, const msm::Msm& msm);
+
+    /**
+     * Render the events of the next time slice and append them to a vector
+     * @param milliseconds the length of the time slice
+     * @param events receives the events with a time before the end of the slice, in time order
+     * @return the number of events appended
+     */
+    size_t next(double milliseconds, std::vector<Event>& events);
+
+    /**
+     * Check if all events have been returned
+     * @return true at the end of the piece
+     */
+    bool isFinished() const;
+
+    /**
+     * Get the current position of the stream
+     * @return the end of the last time slice in milliseconds
+     */
+    double getPosition() const { return position; }
+
+    /**
+     * Get the length of the windows in which the notes are rendered
+     * @return the length in ticks of the performance's ppq
+     */
+    double getWindowLength() const { return windowLength; }
+
+    /**
+     * Set the length of the windows in which the notes are rendered; shorter windows give the
+     * first events earlier, longer ones render with less overhead. The default is one whole note.
+     * @param ticks the length in ticks of the performance's ppq, greater than 0
+     */
+    void setWindowLength(double ticks);
+
+    /**
+     * Get the number of windows that have been rendered so far, summed over the parts
+     * @return the number of windows
+     */
+    size_t getRenderedWindowCount() const { return renderedWindows; }
+
+private:
+    /**
+     * Render the next window of a part into the queue
+     * @param part the part
+     */
+    void renderWindow(PartStream& part);
+
+    /**
+     * Add an event to the queue
+     * @param event the event
+     */
+    void push(const Event& event);
+};
+
+} // namespace mpm
+} // namespace meico
@@ -13,7 +13,7 @@ class GenericMap;
 
 /**
  * This class represents a dated container for maps in MPM.
- * Placeholder implementation for MPM Dated element.
+ * Its maps are created by MapFactory from the child elements of the dated element.
  */
 class Dated : public xml::AbstractXmlSubtree {
 private:
@@ -30,6 +30,13 @@ public:
      */
     virtual ~Dated() = default;
 
+    /**
+     * Dated environment factory, this parses the maps of an existing dated element
+     * @param xml the dated element
+     * @return new Dated instance
+     */
+    static std::unique_ptr<Dated> createDated(const Element& xml);
+
     /**
      * Add a map to this dated container
      * @param map the map to add
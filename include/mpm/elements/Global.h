@@ -11,7 +11,7 @@ class Dated;
 
 /**
  * This class represents global performance information.
- * Placeholder implementation for MPM Global element.
+ * Of the global element, the maps in its dated environment are parsed.
  */
 class Global : public xml::AbstractXmlSubtree {
 private:
@@ -28,6 +28,13 @@ public:
      */
     virtual ~Global() = default;
 
+    /**
+     * Global environment factory, this parses an existing global element
+     * @param xml the global element
+     * @return new Global instance
+     */
+    static std::unique_ptr<Global> createGlobal(const Element& xml);
+
     /**
      * Get the dated container
      * @return dated container or nullptr
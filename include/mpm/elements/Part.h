@@ -12,7 +12,7 @@ class Dated;
 
 /**
  * This class represents a part in MPM performance.
- * Placeholder implementation for MPM Part element.
+ * Of the part element, the attributes and the maps in its dated environment are parsed.
  */
 class Part : public xml::AbstractXmlSubtree {
 private:
@@ -47,6 +47,13 @@ public:
      */
     static std::unique_ptr<Part> createPart(const std::string& partName, int partNumber, int channel, int port);
 
+    /**
+     * Factory method to create a part from an existing part element
+     * @param xml the part element
+     * @return new Part instance or nullptr if the number, midi.channel or midi.port attribute is missing
+     */
+    static std::unique_ptr<Part> createPart(const Element& xml);
+
     /**
      * Get the part name
      * @return part name
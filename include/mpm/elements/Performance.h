@@ -4,10 +4,18 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <ostream>
 
 namespace meico {
 namespace msm {
     class Msm; // Forward declaration
+    class NoteTable;
+    class MsmStreamWriter;
+    class MsmOverlay;
+}
+
+namespace supplementary {
+    class ThreadPool; // Forward declaration
 }
 
 namespace mpm {
@@ -16,6 +24,9 @@ namespace mpm {
 class Global;
 class Part;
 class GenericMap;
+class TempoMap;
+class DynamicsMap;
+class PerformanceStream;
 
 /**
  * This class represents an MPM performance.
@@ -24,12 +35,25 @@ class GenericMap;
  * @author Axel Berndt (original Java), C++ port
  */
 class Performance : public xml::AbstractXmlSubtree {
+    friend class PerformanceStream;             // renders the parts window by window with the same maps
+
+public:
+    /**
+     * How the maps of a part are applied to its notes
+     */
+    enum class MapApplication {
+        SEQUENTIAL,     // each map traverses all notes on its own
+        FUSED           // consecutive sweepable maps are rendered in one sweep over the notes in date order
+    };
+
 private:
     std::string name;                                    // the name of the performance
     int pulsesPerQuarter;                               // the timing resolution of symbolic time
     std::unique_ptr<Global> global;                     // the global performance information
     std::vector<std::unique_ptr<Part>> parts;          // the local performance information
     std::string id;                                     // the id attribute
+    MapApplication mapApplication;                      // how the maps are applied in perform()
+    std::shared_ptr<supplementary::ThreadPool> threadPool;  // renders the parts concurrently in perform(), nullptr for serial rendering
 
 public:
     /**
@@ -108,12 +132,81 @@ public:
     void addPart(std::unique_ptr<Part> part);
 
     /**
-     * Apply this performance to an MSM and return the result
+     * Get the map application mode
+     * @return the mode
+     */
+    MapApplication getMapApplication() const;
+
+    /**
+     * Set the map application mode; both modes produce the same result
+     * @param mode the mode
+     */
+    void setMapApplication(MapApplication mode);
+
+    /**
+     * Get the thread pool that renders the parts
+     * @return the thread pool or nullptr
+     */
+    std::shared_ptr<supplementary::ThreadPool> getThreadPool() const;
+
+    /**
+     * Set a thread pool to render the MSM parts concurrently in perform(); the result is
+     * the same as with serial rendering. The pool can be shared with other performances.
+     * @param threadPool the thread pool or nullptr for serial rendering
+     */
+    void setThreadPool(std::shared_ptr<supplementary::ThreadPool> threadPool);
+
+    /**
+     * Prepare all maps of this performance for rendering at its timing resolution, so that the
+     * rendering methods do not modify them and can be called from several threads at once, as
+     * long as the performance is not edited meanwhile.
+     */
+    void prepareForRendering();
+
+    /**
+     * Apply this performance to an MSM and return the result. This renders into a deep copy of
+     * the input; use performOverlay() to render without copying it.
      * @param msm the input MSM
      * @return the modified MSM
      */
     std::unique_ptr<msm::Msm> perform(const msm::Msm& msm) const;
 
+    /**
+     * Apply this performance to an MSM and stream the result to a writer. The input is not
+     * copied; each part is compiled, rendered and written before the next one, so only one
+     * part's notes are held in memory. The output is the same as writing the MSM that
+     * perform(msm) returns. The parts are rendered serially, a thread pool is not used.
+     * @param msm the input MSM
+     * @param writer the writer that receives the result, it is finished at the end
+     * @return true if the output was written successfully
+     */
+    bool perform(const msm::Msm& msm, msm::MsmStreamWriter& writer) const;
+
+    /**
+     * Apply this performance to an MSM without copying it. The result references the input and
+     * holds only the rendered notes; writing it or materializing it as an Msm gives the same
+     * document as perform(msm). The input must outlive the result.
+     * @param msm the input MSM
+     * @return the rendered overlay of the input
+     */
+    std::unique_ptr<msm::MsmOverlay> performOverlay(const msm::Msm& msm) const;
+
+    /**
+     * Apply this performance to an MSM without copying it, see performOverlay(msm)
+     * @param msm the input MSM
+     * @param log the stream that receives the progress messages instead of std::cout
+     * @return the rendered overlay of the input
+     */
+    std::unique_ptr<msm::MsmOverlay> performOverlay(const msm::Msm& msm, std::ostream& log) const;
+
+    /**
+     * Open a stream that renders this performance of an MSM incrementally and returns its MIDI
+     * events in time order, see PerformanceStream. This performance and the MSM must outlive the stream.
+     * @param msm the input MSM
+     * @return the stream, positioned at 0 ms
+     */
+    std::unique_ptr<PerformanceStream> performStream(const msm::Msm& msm) const;
+
 protected:
     /**
      * Parse data from XML element (from AbstractXmlSubtree)
@@ -128,11 +221,78 @@ private:
     void init();
 
     /**
-     * Apply maps to an MSM part
-     * @param msmPart the MSM part element
-     * @param maps the maps to apply
+     * Apply maps to the compiled notes of an MSM part
+     * @param notes the note table of the MSM part
+     * @param maps the maps to apply, in order
+     * @param log the stream that receives the progress messages
+     */
+    void applyMapsToNoteTable(msm::NoteTable& notes, const std::vector<GenericMap*>& maps, std::ostream& log) const;
+
+    /**
+     * Collect the maps that apply to an MSM part, the global maps followed by those of the performance part with the same name
+     * @param msmPart the MSM part
+     * @param perfPart receives the matching performance part or nullptr
+     * @return the maps in the order they are applied
+     */
+    std::vector<GenericMap*> collectMaps(const Element& msmPart, const Part*& perfPart) const;
+
+    /**
+     * Render the maps of an MSM part and its milliseconds timing into its notes
+     * @param notes the note table of the MSM part
+     * @param maps the maps, see collectMaps()
+     * @param perfPart the matching performance part or nullptr
+     * @param log the stream that receives the progress messages
+     */
+    void renderNoteTable(msm::NoteTable& notes, const std::vector<GenericMap*>& maps, const Part* perfPart, std::ostream& log) const;
+
+    /**
+     * Find the maps that time the milliseconds dates and the channel volume of a part; maps that come later take precedence
+     * @param maps the maps, see collectMaps()
+     * @param tempoMap receives the tempoMap or nullptr
+     * @param dynamicsMap receives the dynamicsMap or nullptr
+     */
+    static void findTimingMaps(const std::vector<GenericMap*>& maps, const TempoMap*& tempoMap, const DynamicsMap*& dynamicsMap);
+
+    /**
+     * Compile and render the notes of MSM parts, concurrently if a thread pool is set
+     * @param msmParts the MSM parts
+     * @param msmPPQ the timing resolution of the parts; their notes are converted to the performance's ppq
+     * @param log the stream that receives the progress messages
+     * @return the rendered notes of each part, they are not written back
+     */
+    std::vector<msm::NoteTable> renderParts(const std::vector<Element>& msmParts, int msmPPQ, std::ostream& log) const;
+
+    /**
+     * Compile the notes of an MSM part at the performance's timing resolution
+     * @param msmPart the MSM part
+     * @param msmPPQ the timing resolution of the part
+     * @return the note table
+     */
+    msm::NoteTable compileNoteTable(const Element& msmPart, int msmPPQ) const;
+
+    /**
+     * Get the file name of a rendered MSM, the input's file name with the performance name appended
+     * @param msmFile the input's file name
+     * @return the file name or an empty string if the input has none
+     */
+    std::string getResultFile(const std::string& msmFile) const;
+
+    /**
+     * Apply one map to the compiled notes of an MSM part; the summary of an ornamentationMap goes to the log
+     * @param map the map
+     * @param notes the note table of the MSM part
+     * @param log the stream that receives the progress messages
+     * @return true if the map modified any note
+     */
+    static bool applyMap(GenericMap& map, msm::NoteTable& notes, std::ostream& log);
+
+    /**
+     * Render a run of sweepable maps in one sweep over the notes in date order
+     * @param notes the note table of the MSM part
+     * @param maps the maps, all of them must support the note sweep
+     * @param modified receives for each map whether it modified any note
      */
-    void applyMapsToMsmPart(Element msmPart, const std::vector<std::unique_ptr<GenericMap>>& maps) const;
+    static void sweepMaps(msm::NoteTable& notes, const std::vector<GenericMap*>& maps, std::vector<bool>& modified);
 };
 
 } // namespace mpm
@@ -3,10 +3,11 @@
 #include "mpm/elements/maps/GenericMap.h"
 #include "mpm/elements/maps/data/ArticulationData.h"
 #include "supplementary/KeyValue.h"
+#include "supplementary/IdIndex.h"
 #include <vector>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
 namespace meico {
 namespace mpm {
@@ -23,6 +24,17 @@ class ArticulationMap : public GenericMap {
 private:
     std::vector<ArticulationData> articulationData;
 
+    // the note-targeted articulations by the id of the note (without leading #): the index finds the first
+    // one in map order, nextForNote chains the others; it is built on demand and invalidated when
+    // articulation data is added
+    supplementary::IdIndex noteIdIndex;
+    std::vector<long> nextForNote;
+    bool hasNoteTargets = false;
+    bool noteIdIndexValid = false;
+
+    // articulations apply to notes whose date differs less than this
+    static constexpr double DATE_TOLERANCE = 0.001;
+
 public:
     /**
      * Constructor
@@ -40,6 +52,13 @@ public:
      */
     static std::unique_ptr<ArticulationMap> createArticulationMap();
 
+    /**
+     * ArticulationMap factory
+     * @param xml
+     * @return
+     */
+    static std::unique_ptr<ArticulationMap> createArticulationMap(const Element& xml);
+
     /**
      * Add an articulation element to the map
      * @param date musical time (in PPQ units)
@@ -93,6 +112,12 @@ public:
      */
     int addArticulation(const ArticulationData& data);
 
+    /**
+     * Add a batch of articulation and style elements in any order; they are sorted once
+     * @param batch the articulation data to add
+     */
+    void addArticulation(std::vector<ArticulationData> batch);
+
     /**
      * Add a style switch (an MPM style element)
      * @param date musical time
@@ -126,11 +151,32 @@ public:
     void renderArticulationToMap_millisecondModifiers(GenericMap& map);
 
     /**
-     * Apply this articulation map to modify notes in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Apply this articulation map to the compiled notes of an MSM part
+     * @param notes the note table to modify
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
+
+    /**
+     * This map can be rendered in a fused note sweep
+     * @return true
+     */
+    bool supportsNoteSweep() const override;
+
+    /**
+     * Apply this articulation map to a single note of a fused sweep
+     * @param notes the note table to modify
+     * @param row the row of the note
+     * @param cursor the sweep cursor into the articulation entries
+     * @return true if the note was modified
+     */
+    bool applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) override;
+
+    /**
+     * Build the note id index in advance
+     * @param ppq the pulses per quarter timing resolution of the notes
+     */
+    void prepareForRendering(int ppq) override;
 
     /**
      * Get the number of elements in this map
@@ -138,6 +184,19 @@ public:
      */
     size_t size() const { return articulationData.size(); }
 
+    /**
+     * Write the articulation entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the articulation entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
+
 protected:
     /**
      * Parse data from XML element
@@ -161,12 +220,13 @@ private:
     void findStyle(int index, ArticulationData& ad);
 
     /**
-     * Apply articulation data to a note element
-     * @param note the note element to modify
+     * Apply articulation data to a note
+     * @param notes the note table
+     * @param row the row of the note to modify
      * @param data the articulation data to apply
      * @return true if the note was modified
      */
-    bool applyArticulationToNote(Element& note, const ArticulationData& data) const;
+    bool applyArticulationToNote(msm::NoteTable& notes, size_t row, const ArticulationData& data) const;
 
     /**
      * Get the current style that applies at the given index
@@ -174,6 +234,25 @@ private:
      * @return the style name or empty string if none applies
      */
     std::string findStyleAt(size_t index) const;
+
+    /**
+     * Insert articulation data at its position in the date-sorted map
+     * @param data the articulation data
+     * @return the index at which it has been inserted
+     */
+    int insertArticulationData(const ArticulationData& data);
+
+    /**
+     * Build the note id index if it is not up to date
+     */
+    void updateNoteIdIndex();
+
+    /**
+     * Get the id of the note that an articulation refers to
+     * @param index the index of the articulation
+     * @return the id without leading # or an empty view if the articulation applies by date
+     */
+    std::string_view getTargetNoteId(size_t index) const;
 };
 
 } // namespace mpm
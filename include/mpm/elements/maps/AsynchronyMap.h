@@ -1,7 +1,7 @@
 #pragma once
 
 #include "mpm/elements/maps/GenericMap.h"
-#include "supplementary/KeyValue.h"
+#include "supplementary/Timeline.h"
 #include <memory>
 #include <vector>
 
@@ -24,7 +24,7 @@ struct AsynchronyData {
  */
 class AsynchronyMap : public GenericMap {
 private:
-    std::vector<supplementary::KeyValue<double, std::unique_ptr<AsynchronyData>>> asynchronyData;
+    supplementary::Timeline<std::unique_ptr<AsynchronyData>> asynchronyData;
 
 public:
     /**
@@ -58,6 +58,12 @@ public:
      */
     int addAsynchrony(double date, double millisecondsOffset);
 
+    /**
+     * Add a batch of asynchrony instructions in any order; they are sorted once
+     * @param batch the asynchrony data
+     */
+    void addAsynchrony(const std::vector<AsynchronyData>& batch);
+
     /**
      * get the asynchrony, i.e. the milliseconds offset, at the specified date
      * @param date
@@ -66,11 +72,11 @@ public:
     double getAsynchronyAt(double date) const;
 
     /**
-     * Apply this asynchrony map to modify notes in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Apply this asynchrony map to the compiled notes of an MSM part
+     * @param notes the note table to modify
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
 
     /**
      * on the basis of this asynchronyMap, add the corresponding offsets to the millisecond.date and millisecond.date.end attributes of each map element
@@ -85,6 +91,19 @@ public:
      */
     static void renderAsynchronyToMap(GenericMap& map, AsynchronyMap* asynchronyMap);
 
+    /**
+     * Write the asynchrony entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the asynchrony entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
+
 protected:
     /**
      * Parse data from XML element
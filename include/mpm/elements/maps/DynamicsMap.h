@@ -2,20 +2,22 @@
 
 #include "mpm/elements/maps/GenericMap.h"
 #include "mpm/elements/maps/data/DynamicsData.h"
-#include "supplementary/KeyValue.h"
+#include "supplementary/Timeline.h"
 #include <vector>
 #include <memory>
 
 namespace meico {
 namespace mpm {
 
+class TempoMap;
+
 /**
  * This class represents a dynamics map in MPM.
  * Maps musical time to dynamic levels (velocity).
  */
 class DynamicsMap : public GenericMap {
 private:
-    std::vector<supplementary::KeyValue<double, std::unique_ptr<DynamicsData>>> dynamicsData;
+    supplementary::Timeline<std::unique_ptr<DynamicsData>> dynamicsData;
 
 public:
     /**
@@ -34,6 +36,13 @@ public:
      */
     static std::unique_ptr<DynamicsMap> createDynamicsMap();
 
+    /**
+     * DynamicsMap factory
+     * @param xml
+     * @return
+     */
+    static std::unique_ptr<DynamicsMap> createDynamicsMap(const Element& xml);
+
     /**
      * Add a dynamics entry with full parameters
      * @param date the musical time (in PPQ units)
@@ -54,6 +63,12 @@ public:
      */
     void addDynamics(std::unique_ptr<DynamicsData> data);
 
+    /**
+     * Add a batch of dynamics entries in any order; they are sorted once and the end dates are set in one pass
+     * @param batch the dynamics data
+     */
+    void addDynamics(std::vector<std::unique_ptr<DynamicsData>> batch);
+
     /**
      * Get dynamics data at a specific time (finds the relevant dynamics instruction)
      * @param date the musical time
@@ -76,11 +91,56 @@ public:
     double getDynamicsAt(double date) const;
 
     /**
-     * Apply this dynamics map to modify notes in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Render the sub-note dynamics of this map into channel volume events of a note table, at most
+     * one event per Msm::CONTROL_CHANGE_DENSITY milliseconds, see DynamicsData::renderSubNoteDynamics().
+     * Instructions without sub-note dynamics reset the channel volume to the default of 100. Like
+     * in Java, the last instruction has no sub-note dynamics as it has no end.
+     * @param notes the rendered notes, they receive the events
+     * @param tempoMap the tempoMap that converts the dates to milliseconds or nullptr for one tick per millisecond, like TempoMap::renderTempoToNoteTable()
+     * @return true if events were generated, false if no instruction has sub-note dynamics
+     */
+    bool renderSubNoteDynamics(msm::NoteTable& notes, const TempoMap* tempoMap) const;
+
+    /**
+     * Apply this dynamics map to the compiled notes of an MSM part
+     * @param notes the note table to modify
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
+
+    /**
+     * This map can be rendered in a fused note sweep
+     * @return true
+     */
+    bool supportsNoteSweep() const override;
+
+    /**
+     * Apply this dynamics map to a single note of a fused sweep
+     * @param notes the note table to modify
+     * @param row the row of the note
+     * @param cursor the sweep cursor into the dynamics entries
+     * @return true if the note was modified
+     */
+    bool applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) override;
+
+    /**
+     * Compute the Bézier control points of all dynamics transitions in advance
+     * @param ppq the pulses per quarter timing resolution of the notes
+     */
+    void prepareForRendering(int ppq) override;
+
+    /**
+     * Write the dynamics entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the dynamics entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
 
 protected:
     /**
@@ -97,12 +157,26 @@ private:
      */
     int getElementIndexBeforeAt(double date) const;
 
+    /**
+     * Compute the velocity of a note; notes that sound during sub-note dynamics keep the default
+     * velocity, their loudness is controlled by the channel volume
+     * @param index the index of the last instruction at or before the date
+     * @param date the date of the note
+     * @return the velocity
+     */
+    double getNoteVelocity(int index, double date) const;
+
     /**
      * Get the end date for a dynamics instruction (date of next instruction or max value)
      * @param index the index of the current dynamics instruction
      * @return the end date
      */
     double getEndDate(int index) const;
+
+    /**
+     * Set the end dates of all dynamics instructions
+     */
+    void updateEndDates();
 };
 
 } // namespace mpm
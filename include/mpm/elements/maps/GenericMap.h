@@ -2,8 +2,19 @@
 
 #include "xml/AbstractXmlSubtree.h"
 #include <string>
+#include <string_view>
+#include <cstddef>
 
 namespace meico {
+namespace msm {
+    class NoteTable; // Forward declaration
+}
+
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace mpm {
 
 /**
@@ -33,13 +44,69 @@ public:
     const std::string& getMapType() const;
 
     /**
-     * Apply this map to modify notes in an MSM part
+     * Apply this map to modify notes in an MSM part.
+     * This compiles the part into a NoteTable, renders into it and writes the result back.
+     * The part's document is not known here, call its markModified() afterwards.
      * @param msmPart the MSM part element to modify
      * @return true if any modifications were made
      */
-    virtual bool applyToMsmPart(Element msmPart) = 0;
+    virtual bool applyToMsmPart(Element msmPart);
+
+    /**
+     * Apply this map to the compiled notes of an MSM part
+     * @param notes the note table to modify
+     * @return true if any modifications were made
+     */
+    virtual bool applyToNoteTable(msm::NoteTable& notes) = 0;
+
+    /**
+     * Check if this map can be applied note by note in a fused sweep (see applyToNote())
+     * @return true if applyToNote() is implemented
+     */
+    virtual bool supportsNoteSweep() const;
+
+    /**
+     * Apply this map to a single note. This is used by the fused pipeline that renders
+     * several maps in one sweep over the notes in date order; each map keeps its own
+     * cursor into its entries so that the lookup advances instead of searching.
+     * Applying it to every row must give the same result as applyToNoteTable().
+     * @param notes the note table to modify
+     * @param row the row of the note
+     * @param cursor the map's sweep cursor, initialize with 0 before the first note of a sweep
+     * @return true if the note was modified
+     */
+    virtual bool applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor);
+
+    /**
+     * Build everything that the map would otherwise compute lazily while it is applied. Performance
+     * calls this before the parts are rendered; afterwards applying the map does not modify it,
+     * so it can be applied to several parts concurrently.
+     * @param ppq the pulses per quarter timing resolution of the notes
+     */
+    virtual void prepareForRendering(int ppq);
+
+    /**
+     * Write the entries of this map with everything that has been computed from them to a
+     * performance cache, see PerformanceCache. Maps without entries write nothing.
+     * @param writer the writer
+     */
+    virtual void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore the entries that writeToCache() has written. The entries are in map order already
+     * and are taken over without sorting, validation or recomputation.
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    virtual bool readFromCache(supplementary::BinaryReader& reader);
 
 protected:
+    /**
+     * Set the map type, e.g. when a map's type depends on its parsed element name
+     * @param type the map type
+     */
+    void setMapType(std::string_view type);
+
     /**
      * Parse data from XML element
      * @param xmlElement the XML element to parse
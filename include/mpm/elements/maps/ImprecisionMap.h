@@ -22,6 +22,8 @@ private:
     static const int TONEDURATION = 3;
     static const int TUNING = 4;
 
+    std::string domain;                         // the part of the local name after "imprecisionMap.", parsed once
+
 public:
     /**
      * ImprecisionMap factory
@@ -47,7 +49,7 @@ public:
      * get the domain of this imprecisionMap
      * @return
      */
-    std::string getDomain() const;
+    const std::string& getDomain() const;
 
     /**
      * for a tuning imprecision map, specify the unit
@@ -228,11 +230,11 @@ public:
     static void renderImprecisionToMap(GenericMap& map, ImprecisionMap* imprecisionMap, bool shakePolyphonicPart);
 
     /**
-     * Apply this imprecision map to modify notes in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Apply this imprecision map to the compiled notes of an MSM part
+     * @param notes the note table to modify
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
 
 protected:
     /**
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "xml/AbstractXmlSubtree.h"
+#include <memory>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace meico {
+namespace mpm {
+
+// Forward declaration
+class GenericMap;
+
+/**
+ * Creates the map objects of MPM's dated environments from their element local names
+ * ("tempoMap", "dynamicsMap", "imprecisionMap.timing", ...). The known names are registered
+ * by their hash at compile time; a lookup hashes the name once, switches on the hash and
+ * confirms the match with one comparison. The lookup does not allocate or copy the name;
+ * only an imprecisionMap copies its domain, the part after the dot, into the new map.
+ */
+class MapFactory {
+public:
+    /**
+     * Compute the 64 bit FNV-1a hash of a map type
+     * @param mapType the map type
+     * @return the hash
+     */
+    static constexpr uint64_t hash(std::string_view mapType) {
+        uint64_t value = 14695981039346656037ULL;
+        for (char c : mapType) {
+            value ^= static_cast<unsigned char>(c);
+            value *= 1099511628211ULL;
+        }
+        return value;
+    }
+
+    /**
+     * Check if a local name denotes a map type that this factory can create
+     * @param mapType the local name
+     * @return true if createMap() creates a map for it
+     */
+    static bool isMapType(std::string_view mapType);
+
+    /**
+     * Create an empty map of a type
+     * @param mapType the map type, e.g. "tempoMap" or "imprecisionMap.timing"
+     * @return the map or nullptr for an unknown type
+     */
+    static std::unique_ptr<GenericMap> createMap(std::string_view mapType);
+
+    /**
+     * Create a map from its xml element, the type is given by the element's local name
+     * @param xml the map element
+     * @return the map or nullptr if the element is no map of a known type or cannot be parsed
+     */
+    static std::unique_ptr<GenericMap> createMap(const Element& xml);
+
+private:
+    /**
+     * The registered map types
+     */
+    enum class Type {
+        UNKNOWN,
+        ARTICULATION,
+        ASYNCHRONY,
+        DYNAMICS,
+        IMPRECISION,
+        METRICAL_ACCENTUATION,
+        MOVEMENT,
+        ORNAMENTATION,
+        RUBATO,
+        TEMPO
+    };
+
+    /**
+     * Look up the type of a local name
+     * @param mapType the local name
+     * @return the type or UNKNOWN
+     */
+    static Type lookup(std::string_view mapType);
+};
+
+} // namespace mpm
+} // namespace meico
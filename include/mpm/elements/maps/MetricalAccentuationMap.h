@@ -39,6 +39,13 @@ public:
      */
     static std::unique_ptr<MetricalAccentuationMap> createMetricalAccentuationMap();
 
+    /**
+     * MetricalAccentuationMap factory
+     * @param xml
+     * @return
+     */
+    static std::unique_ptr<MetricalAccentuationMap> createMetricalAccentuationMap(const Element& xml);
+
     /**
      * Add an accentuationPattern element to the map
      * @param date musical time
@@ -79,6 +86,12 @@ public:
      */
     int addAccentuationPattern(const MetricalAccentuationData& data);
 
+    /**
+     * Add a batch of accentuationPattern elements in any order; they are sorted once
+     * @param batch the accentuation data to add
+     */
+    void addAccentuationPattern(std::vector<MetricalAccentuationData> batch);
+
     /**
      * Get metrical accentuation data of a specified element in this map
      * @param index element index
@@ -95,11 +108,26 @@ public:
     void renderMetricalAccentuationToMap(GenericMap& map, GenericMap* timeSignatureMap, int ppq);
 
     /**
-     * Apply this accentuation map to modify notes in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Apply this accentuation map to the compiled notes of an MSM part
+     * @param notes the note table to modify
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
+
+    /**
+     * This map can be rendered in a fused note sweep
+     * @return true
+     */
+    bool supportsNoteSweep() const override;
+
+    /**
+     * Apply this metrical accentuation map to a single note of a fused sweep
+     * @param notes the note table to modify
+     * @param row the row of the note
+     * @param cursor the sweep cursor into the metrical accentuation entries
+     * @return true if the note was modified
+     */
+    bool applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) override;
 
     /**
      * Get the number of elements in this map
@@ -107,6 +135,19 @@ public:
      */
     size_t size() const { return accentuationData.size(); }
 
+    /**
+     * Write the accentuation entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the accentuation entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
+
 protected:
     /**
      * Parse data from XML element
@@ -137,6 +178,15 @@ private:
      */
     double computeAccentuationAt(double beat, const MetricalAccentuationData& data) const;
 
+    /**
+     * Apply an accentuation pattern to a note
+     * @param notes the note table
+     * @param row the row of the note, it must have a date and a velocity
+     * @param data the accentuation pattern that applies at the note's date
+     * @return true if the note's velocity was changed
+     */
+    bool applyAccentuationToNote(msm::NoteTable& notes, size_t row, const MetricalAccentuationData& data) const;
+
     /**
      * Simple beat-based accentuation pattern (simplified implementation)
      * @param beat the beat position
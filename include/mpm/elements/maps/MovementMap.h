@@ -2,7 +2,7 @@
 
 #include "mpm/elements/maps/GenericMap.h"
 #include "mpm/elements/maps/data/MovementData.h"
-#include "supplementary/KeyValue.h"
+#include "supplementary/Timeline.h"
 #include <vector>
 #include <memory>
 
@@ -16,7 +16,7 @@ namespace mpm {
  */
 class MovementMap : public GenericMap {
 private:
-    std::vector<supplementary::KeyValue<double, std::unique_ptr<MovementData>>> movementData;
+    supplementary::Timeline<std::unique_ptr<MovementData>> movementData;
 
 public:
     /**
@@ -35,6 +35,13 @@ public:
      */
     static std::unique_ptr<MovementMap> createMovementMap();
 
+    /**
+     * MovementMap factory
+     * @param xml
+     * @return
+     */
+    static std::unique_ptr<MovementMap> createMovementMap(const Element& xml);
+
     /**
      * Add a movement entry with full parameters
      * @param date the musical time (in PPQ units)
@@ -66,6 +73,12 @@ public:
      */
     void addMovement(std::unique_ptr<MovementData> data);
 
+    /**
+     * Add a batch of movement instructions in any order; they are sorted once
+     * @param batch the movement data
+     */
+    void addMovement(std::vector<std::unique_ptr<MovementData>> batch);
+
     /**
      * Get movement data at a specific time (finds the relevant movement instruction)
      * @param date the musical time
@@ -88,11 +101,11 @@ public:
     double getPositionAt(double date) const;
 
     /**
-     * Apply this movement map to create a position map in MSM
-     * @param msmPart the MSM part element to modify
+     * Apply this movement map to the compiled notes of an MSM part; it creates a position map rather than modifying notes
+     * @param notes the note table of the MSM part
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
 
     /**
      * Render movement to map - creates a positionMap with movement data
@@ -107,6 +120,19 @@ public:
      */
     static std::unique_ptr<GenericMap> renderMovementToMap(MovementMap* movementMap);
 
+    /**
+     * Write the movement entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the movement entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
+
 protected:
     /**
      * Parse data from XML element
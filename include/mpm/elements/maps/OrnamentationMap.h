@@ -2,7 +2,7 @@
 
 #include "mpm/elements/maps/GenericMap.h"
 #include "mpm/elements/maps/data/OrnamentData.h"
-#include "supplementary/KeyValue.h"
+#include "supplementary/Timeline.h"
 #include "xml/XmlBase.h"
 #include <vector>
 #include <string>
@@ -17,8 +17,22 @@ namespace mpm {
  * @author Axel Berndt (original Java), C++ port
  */
 class OrnamentationMap : public GenericMap {
+public:
+    /**
+     * Summary of an application of the map to a note table
+     */
+    struct Report {
+        size_t ornaments = 0;       // number of ornaments that matched a chord
+        size_t chords = 0;          // number of ornamented chords
+        size_t notes = 0;           // number of notes in these chords
+        bool modified = false;      // true if any attributes were added
+    };
+
 private:
-    std::vector<supplementary::KeyValue<double, std::unique_ptr<OrnamentData>>> ornamentData;
+    supplementary::Timeline<std::unique_ptr<OrnamentData>> ornamentData;
+
+    // ornaments apply to notes whose date differs less than this, notes that close form a chord
+    static constexpr double DATE_TOLERANCE = 1e-6;
 
 public:
     /**
@@ -36,6 +50,13 @@ public:
      * @return new OrnamentationMap instance
      */
     static std::unique_ptr<OrnamentationMap> createOrnamentationMap();
+
+    /**
+     * OrnamentationMap factory
+     * @param xml
+     * @return
+     */
+    static std::unique_ptr<OrnamentationMap> createOrnamentationMap(const Element& xml);
     
     /**
      * Add an ornament element to the ornamentationMap
@@ -56,6 +77,12 @@ public:
      */
     int addOrnament(const OrnamentData& data);
     
+    /**
+     * Add a batch of ornament elements in any order; they are sorted once
+     * @param batch ornament data
+     */
+    void addOrnament(const std::vector<OrnamentData>& batch);
+    
     /**
      * Get ornament data at a specific time
      * @param date the musical time
@@ -83,11 +110,33 @@ public:
     bool isEmpty() const;
     
     /**
-     * Apply this ornamentation map to modify notes in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Apply this ornamentation map to the compiled notes of an MSM part
+     * @param notes the note table to modify
+     * @return true if any modifications were made
+     */
+    bool applyToNoteTable(msm::NoteTable& notes) override;
+
+    /**
+     * Apply this ornamentation map to the compiled notes of an MSM part and summarize what was done;
+     * parts may be rendered concurrently, so the summary is returned instead of being kept in the map
+     * @param notes the note table to modify
+     * @param report receives the summary of this call
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes, Report& report) const;
+
+    /**
+     * Write the ornament entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the ornament entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
 
 protected:
     /**
@@ -106,12 +155,13 @@ private:
     int insertOrnamentData(double date, std::unique_ptr<OrnamentData> data);
     
     /**
-     * Apply ornament modifications to a note element
-     * @param note the note element to modify
+     * Apply ornament modifications to the notes of a chord
+     * @param notes the note table
+     * @param chord the rows of the simultaneous notes to modify
      * @param ornamentData the ornament data to apply
-     * @return true if modifications were made
+     * @param report receives whether attributes were added
      */
-    bool applyOrnamentToNote(Element note, const OrnamentData& ornamentData);
+    static void applyOrnamentToChord(msm::NoteTable& notes, const std::vector<size_t>& chord, const OrnamentData& ornamentData, Report& report);
     
     /**
      * Get the index of the ornament element at or before the given date
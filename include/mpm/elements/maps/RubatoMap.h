@@ -2,7 +2,7 @@
 
 #include "mpm/elements/maps/GenericMap.h"
 #include "mpm/elements/maps/data/RubatoData.h"
-#include "supplementary/KeyValue.h"
+#include "supplementary/Timeline.h"
 #include <vector>
 #include <memory>
 
@@ -15,7 +15,7 @@ namespace mpm {
  */
 class RubatoMap : public GenericMap {
 private:
-    std::vector<supplementary::KeyValue<double, std::unique_ptr<RubatoData>>> rubatoData;
+    supplementary::Timeline<std::unique_ptr<RubatoData>> rubatoData;
 
 public:
     /**
@@ -34,6 +34,13 @@ public:
      */
     static std::unique_ptr<RubatoMap> createRubatoMap();
 
+    /**
+     * RubatoMap factory
+     * @param xml
+     * @return
+     */
+    static std::unique_ptr<RubatoMap> createRubatoMap(const Element& xml);
+
     /**
      * Add a rubato element to the map (with direct attributes)
      * @param date musical time
@@ -65,6 +72,12 @@ public:
      */
     int addRubato(const RubatoData& data);
 
+    /**
+     * Add a batch of rubato elements in any order; they are sorted once and the end dates are set in one pass
+     * @param batch the rubato data
+     */
+    void addRubato(const std::vector<RubatoData>& batch);
+
     /**
      * Get rubato data at the specified date
      * @param date musical time
@@ -93,11 +106,26 @@ public:
     static void renderRubatoToMap(GenericMap& map, RubatoMap& rubatoMap);
 
     /**
-     * Apply this rubato map to modify elements in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Apply this rubato map to the compiled notes of an MSM part
+     * @param notes the note table to modify
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
+
+    /**
+     * This map can be rendered in a fused note sweep
+     * @return true
+     */
+    bool supportsNoteSweep() const override;
+
+    /**
+     * Apply this rubato map to a single note of a fused sweep
+     * @param notes the note table to modify
+     * @param row the row of the note
+     * @param cursor the sweep cursor into the rubato entries
+     * @return true if the note was modified
+     */
+    bool applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) override;
 
     /**
      * Compute the rubato transformation for a given date
@@ -107,6 +135,19 @@ public:
      */
     static double computeRubatoTransformation(double date, const RubatoData& rubatoData);
 
+    /**
+     * Write the rubato entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the rubato entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
+
 protected:
     /**
      * Parse data from XML element
@@ -136,6 +177,13 @@ private:
      * @return end date
      */
     double getEndDate(int index);
+
+    /**
+     * Copy rubato data for insertion into the map and ensure its boundaries
+     * @param data the rubato data
+     * @return the copy
+     */
+    static std::unique_ptr<RubatoData> prepareRubatoData(const RubatoData& data);
 };
 
 }  // namespace mpm
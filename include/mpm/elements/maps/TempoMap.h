@@ -2,7 +2,7 @@
 
 #include "mpm/elements/maps/GenericMap.h"
 #include "mpm/elements/maps/data/TempoData.h"
-#include "supplementary/KeyValue.h"
+#include "supplementary/Timeline.h"
 #include <vector>
 #include <memory>
 
@@ -14,8 +14,31 @@ namespace mpm {
  * Ported from Java TempoMap class
  */
 class TempoMap : public GenericMap {
+public:
+    /**
+     * The numerical integration of continuous tempo transitions
+     */
+    enum class Integration {
+        SIMPSON,            // Simpson's rule with 16th note steps, as in the Java original; the cost grows with the segment length
+        GAUSS_LEGENDRE      // closed form for linear transitions, otherwise 15 point Gauss-Kronrod (7 point Gauss-Legendre with error estimate)
+    };
+
 private:
-    std::vector<supplementary::KeyValue<double, std::unique_ptr<TempoData>>> tempoData;
+    supplementary::Timeline<std::unique_ptr<TempoData>> tempoData;
+    Integration integration = Integration::GAUSS_LEGENDRE;
+
+    /**
+     * One tempo instruction of the compiled timing with the milliseconds date at which it starts
+     */
+    struct TimingSegment {
+        double startDate;
+        double startMilliseconds;
+        const TempoData* data;
+    };
+
+    // the compiled timing, it is built on demand for one ppq and invalidated when tempo data is added
+    mutable std::vector<TimingSegment> timing;
+    mutable int timingPpq = 0;
 
 public:
     /**
@@ -34,6 +57,13 @@ public:
      */
     static std::unique_ptr<TempoMap> createTempoMap();
 
+    /**
+     * TempoMap factory
+     * @param xml
+     * @return
+     */
+    static std::unique_ptr<TempoMap> createTempoMap(const Element& xml);
+
     /**
      * Add a tempo element to the map
      * @param date musical time
@@ -63,6 +93,12 @@ public:
      */
     int addTempo(std::unique_ptr<TempoData> data);
 
+    /**
+     * Add a batch of tempo elements in any order; they are sorted once
+     * @param batch the tempo data
+     */
+    void addTempo(std::vector<std::unique_ptr<TempoData>> batch);
+
     /**
      * Get tempo data at a specific time (finds the relevant tempo instruction)
      * @param date the musical time
@@ -114,16 +150,107 @@ public:
      * @param date musical time
      * @param ppq pulses per quarter timing resolution
      * @param tempoData a TempoData instance or nullptr (if no tempo information is given)
+     * @param integration the numerical integration of tempo transitions
      * @return date in milliseconds
      */
-    static double computeDiffTiming(double date, int ppq, const TempoData* tempoData);
+    static double computeDiffTiming(double date, int ppq, const TempoData* tempoData, Integration integration = Integration::GAUSS_LEGENDRE);
 
     /**
-     * Apply this tempo map to modify elements in an MSM part
-     * @param msmPart the MSM part element to modify
+     * Timing computation for continuous tempo transition with Gauss-Legendre quadrature; the cost
+     * does not depend on the length of the transition
+     * @param date musical time
+     * @param ppq pulses per quarter
+     * @param tempoData tempo data of a tempo transition
+     * @param errorEstimate returns an estimate of the absolute integration error in milliseconds
+     * @return the milliseconds difference between tempoData.startDate and date
+     */
+    static double integrateTempoTransition(double date, int ppq, const TempoData* tempoData, double& errorEstimate);
+
+    /**
+     * Get the numerical integration that is used for tempo transitions
+     * @return the integration method
+     */
+    Integration getIntegration() const;
+
+    /**
+     * Set the numerical integration that is used for tempo transitions
+     * @param integration the integration method
+     */
+    void setIntegration(Integration integration);
+
+    /**
+     * Compile the tempo instructions into a table of segments with the cumulative milliseconds date
+     * of each segment start. This is done on demand by getMillisecondsAt(); calling it in advance
+     * makes the subsequent queries read-only.
+     * @param ppq pulses per quarter timing resolution
+     */
+    void compileTiming(int ppq) const;
+
+    /**
+     * Compute the milliseconds date of a tick date; this is a binary search in the compiled timing
+     * and one evaluation within the tempo segment
+     * @param date musical time
+     * @param ppq pulses per quarter timing resolution
+     * @return date in milliseconds
+     */
+    double getMillisecondsAt(double date, int ppq) const;
+
+    /**
+     * Compute the tick date of a milliseconds date, this is the inverse of getMillisecondsAt(); the segment is
+     * found by a binary search in the compiled timing and the date within it by Newton's method with bisection fallback
+     * @param milliseconds date in milliseconds
+     * @param ppq pulses per quarter timing resolution
+     * @return musical time
+     */
+    double getDateAtMilliseconds(double milliseconds, int ppq) const;
+
+    /**
+     * Compute the milliseconds dates and end dates of all notes of a note table
+     * @param notes the note table, its ppq is the timing resolution
+     * @param tempoMap the tempoMap that is the basis of these computations, or nullptr (1 tick = 1 millisecond)
+     */
+    static void renderTempoToNoteTable(msm::NoteTable& notes, const TempoMap* tempoMap);
+
+    /**
+     * Apply this tempo map to the compiled notes of an MSM part
+     * @param notes the note table to modify
      * @return true if any modifications were made
      */
-    bool applyToMsmPart(Element msmPart) override;
+    bool applyToNoteTable(msm::NoteTable& notes) override;
+
+    /**
+     * This map can be rendered in a fused note sweep
+     * @return true
+     */
+    bool supportsNoteSweep() const override;
+
+    /**
+     * Apply this tempo map to a single note of a fused sweep
+     * @param notes the note table to modify
+     * @param row the row of the note
+     * @param cursor the sweep cursor into the tempo entries
+     * @return true if the note was modified
+     */
+    bool applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) override;
+
+    /**
+     * Set the end dates of the tempo instructions and compile the timing in advance
+     * @param ppq the pulses per quarter timing resolution of the notes
+     */
+    void prepareForRendering(int ppq) override;
+
+    /**
+     * Write the tempo entries to a performance cache
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const override;
+
+    /**
+     * Restore the tempo entries from a performance cache
+     * @param reader the reader
+     * @return false if the data is invalid
+     */
+    bool readFromCache(supplementary::BinaryReader& reader) override;
 
 protected:
     /**
@@ -171,6 +298,26 @@ private:
      */
     static double computeMillisecondsForConstantTempo(double date, int ppq, const TempoData* tempoData);
 
+    /**
+     * Find the date within a tempo transition at which the milliseconds difference to its start is reached
+     * @param milliseconds the milliseconds difference to the start of the tempo instruction
+     * @param ppq pulses per quarter
+     * @param tempoData tempo data of a tempo transition
+     * @param integration the numerical integration method
+     * @return musical time
+     */
+    static double solveTempoTransition(double milliseconds, int ppq, const TempoData* tempoData, Integration integration);
+
+    /**
+     * Timing computation for continuous tempo transition
+     * @param date musical time
+     * @param ppq pulses per quarter
+     * @param tempoData tempo data
+     * @param integration the numerical integration method
+     * @return the milliseconds difference between tempoData.startDate and date
+     */
+    static double computeMillisecondsForTempoTransition(double date, int ppq, const TempoData* tempoData, Integration integration);
+
     /**
      * Timing computation for continuous tempo transition using Simpson's rule for numerical integration
      * @param date musical time
@@ -178,7 +325,7 @@ private:
      * @param tempoData tempo data
      * @return the milliseconds difference between tempoData.startDate and date
      */
-    static double computeMillisecondsForTempoTransition(double date, int ppq, const TempoData* tempoData);
+    static double computeMillisecondsForTempoTransitionSimpson(double date, int ppq, const TempoData* tempoData);
 };
 
 } // namespace mpm
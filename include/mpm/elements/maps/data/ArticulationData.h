@@ -5,6 +5,11 @@
 #include <memory>
 
 namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace mpm {
 
 // Forward declarations
@@ -60,6 +65,18 @@ public:
      */
     ArticulationData clone() const;
 
+    /**
+     * Write this entry to a performance cache record
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore this entry from a performance cache record, see writeToCache()
+     * @param reader the reader
+     */
+    void readFromCache(supplementary::BinaryReader& reader);
+
     /**
      * Apply this articulationData to the specified MSM note element
      * @param note the note element to modify
@@ -1,10 +1,19 @@
 #pragma once
 
 #include "xml/XmlBase.h"
+#include <functional>
 #include <memory>
 #include <vector>
 
 namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+namespace msm {
+    class NoteTable;
+}
+
 namespace mpm {
 
 // Forward declarations
@@ -61,6 +70,18 @@ public:
      */
     std::unique_ptr<DynamicsData> clone() const;
 
+    /**
+     * Write this entry to a performance cache record
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore this entry from a performance cache record, see writeToCache()
+     * @param reader the reader
+     */
+    void readFromCache(supplementary::BinaryReader& reader);
+
     /**
      * Check whether this represents a constant dynamics instruction
      * @return true if constant dynamics
@@ -82,15 +103,29 @@ public:
      */
     std::vector<std::pair<double, double>> getSubNoteDynamicsSegment(double maxStepSize);
 
-private:
+    /**
+     * Render the transition into channel volume events for sub-note dynamics. In contrast to
+     * getSubNoteDynamicsSegment() the curve is bisected only where the values at both ends of an
+     * interval round to controller values more than one step apart; the curve is monotonic, so in
+     * between it stays within that step and no event is needed. Intervals shorter than twice
+     * minInterval are not bisected, so the events are at least minInterval apart. The first event
+     * is mandatory, the last one reaches the target volume.
+     * @param notes the table that receives the events
+     * @param toMilliseconds converts a date to milliseconds
+     * @param minInterval the minimal distance of two events in milliseconds
+     */
+    void renderSubNoteDynamics(msm::NoteTable& notes, const std::function<double(double)>& toMilliseconds, double minInterval);
+
     /**
      * For continuous dynamics transitions the dynamics curve is constructed from 
      * a cubic, S-shaped Bézier curve (P0, P1, P2, P3): _/̅
      * This method derives the x-coordinates of the inner two control points from 
      * the values of curvature and protraction. All other coordinates are fixed.
+     * It is called on demand by getDynamicsAt().
      */
     void computeInnerControlPointsXPositions();
 
+private:
     /**
      * Compute parameter t of the Bézier curve that corresponds to time position date
      * @param date time position
@@ -5,6 +5,11 @@
 #include <memory>
 
 namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace mpm {
 
 // Forward declarations
@@ -48,6 +53,18 @@ public:
      * @return cloned MetricalAccentuationData
      */
     MetricalAccentuationData clone() const;
+
+    /**
+     * Write this entry to a performance cache record
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore this entry from a performance cache record, see writeToCache()
+     * @param reader the reader
+     */
+    void readFromCache(supplementary::BinaryReader& reader);
 };
 
 } // namespace mpm
@@ -5,6 +5,11 @@
 #include <vector>
 
 namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace mpm {
 
 // Forward declarations
@@ -53,6 +58,18 @@ public:
      */
     std::unique_ptr<MovementData> clone() const;
 
+    /**
+     * Write this entry to a performance cache record
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore this entry from a performance cache record, see writeToCache()
+     * @param reader the reader
+     */
+    void readFromCache(supplementary::BinaryReader& reader);
+
     /**
      * Compute the movement position value at the given tick position
      * @param date the time position
@@ -6,6 +6,11 @@
 #include <memory>
 
 namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace mpm {
 
 // Forward declarations
@@ -57,6 +62,18 @@ public:
      * @return cloned object
      */
     std::unique_ptr<OrnamentData> clone() const;
+
+    /**
+     * Write this entry to a performance cache record
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore this entry from a performance cache record, see writeToCache()
+     * @param reader the reader
+     */
+    void readFromCache(supplementary::BinaryReader& reader);
     
     /**
      * Apply the ornament to the given chord/note sequence. This will only add
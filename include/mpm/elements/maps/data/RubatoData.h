@@ -5,6 +5,11 @@
 #include <string>
 
 namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace mpm {
 
 // Forward declarations
@@ -67,6 +72,18 @@ public:
      * @return clone of this RubatoData
      */
     std::unique_ptr<RubatoData> clone() const;
+
+    /**
+     * Write this entry to a performance cache record
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore this entry from a performance cache record, see writeToCache()
+     * @param reader the reader
+     */
+    void readFromCache(supplementary::BinaryReader& reader);
 };
 
 }  // namespace mpm
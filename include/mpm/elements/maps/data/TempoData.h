@@ -5,6 +5,11 @@
 #include <string>
 
 namespace meico {
+namespace supplementary {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace mpm {
 
 // Forward declarations
@@ -55,6 +60,18 @@ public:
      */
     std::unique_ptr<TempoData> clone() const;
 
+    /**
+     * Write this entry to a performance cache record
+     * @param writer the writer
+     */
+    void writeToCache(supplementary::BinaryWriter& writer) const;
+
+    /**
+     * Restore this entry from a performance cache record, see writeToCache()
+     * @param reader the reader
+     */
+    void readFromCache(supplementary::BinaryReader& reader);
+
     /**
      * Check whether this represents a constant tempo instruction
      * @return true if constant tempo (no transition or same bpm and transitionTo)
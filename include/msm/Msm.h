@@ -1,19 +1,35 @@
 #pragma once
 
 #include "msm/AbstractMsm.h"
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
 
 namespace meico {
+namespace midi {
+class Midi;
+}
 namespace msm {
 
+class NoteTable;
+
 /**
  * This class holds data in MSM format (Musical Sequence Markup).
  * Ported from Java Msm class.
  * @author Axel Berndt (original Java), C++ port
  */
 class Msm : public AbstractMsm {
+public:
+    static const int CONTROL_CHANGE_DENSITY = 10; // in MPM-to-MIDI export control change density limit, the minimal distance of two controller events in milliseconds
+
 private:
-    static const int CONTROL_CHANGE_DENSITY = 10; // in MPM-to-MIDI export control change density limit
+
+    // the date, date.end and duration attributes of the document, built on first use for the document revision
+    mutable std::vector<Attribute> timingAttributes;
+    mutable uint64_t timingRevision = UINT64_MAX;
+    mutable std::mutex timingMutex;
 
 public:
     /**
@@ -87,11 +103,22 @@ public:
     int getPPQ() const;
 
     /**
-     * Convert PPQ (pulses per quarter note) of this MSM
+     * Convert PPQ (pulses per quarter note) of this MSM. Only the date, date.end and duration
+     * attributes are visited; they are scaled exactly by newPPQ/oldPPQ, see TimingScale.
      * @param ppq the new PPQ value
      */
     void convertPPQ(int ppq);
 
+    /**
+     * Compute the minimal integer timing resolution that represents all dates and durations of
+     * this MSM, i.e. the PPQ divided by the greatest common divisor of the PPQ and all (rounded)
+     * date, date.end and duration values. In contrast to the Java version this is not limited to
+     * binary subdivisions, triplets are represented as well. Like convertPPQ() it visits only the
+     * timing attributes.
+     * @return the minimal PPQ
+     */
+    int getMinimalPPQ() const;
+
     /**
      * Get global element
      * @return global element
@@ -112,6 +139,40 @@ public:
      */
     bool writeMsm(const std::string& filename);
 
+    /**
+     * Convert the MSM into a Standard MIDI File. The notes are written with velocity 100 at their
+     * symbolic dates; one tempo event with the specified bpm is generated at the beginning, the beat
+     * length is taken from the denominator of the first global time signature.
+     * @param bpm the tempo of the MIDI file
+     * @param generateProgramChanges if true, program change events are generated from the part names unless a programChangeMap specifies the initial program
+     * @return the MIDI or nullptr if this MSM is empty
+     */
+    std::unique_ptr<midi::Midi> exportMidi(double bpm = 120.0, bool generateProgramChanges = true) const;
+
+    /**
+     * Convert a rendered MSM, i.e. one with milliseconds.date and milliseconds.date.end attributes
+     * at its notes, into a Standard MIDI File with one tick per millisecond. Velocities beyond
+     * [0, 127] are compressed into this range; the source is not changed.
+     * @param generateProgramChanges if true, program change events are generated from the part names unless a programChangeMap specifies the initial program
+     * @return the MIDI or nullptr if this MSM is empty
+     */
+    std::unique_ptr<midi::Midi> exportExpressiveMidi(bool generateProgramChanges = true) const;
+
+    /**
+     * Convert the MSM into a Standard MIDI File with the notes taken from note tables, e.g. the
+     * rendered notes of an MsmOverlay. Each part with a midi.channel becomes a track, the global
+     * maps go to the first track. The events are collected in an SmfWriter and written into one
+     * buffer; no XML is generated.
+     * @param ppq the pulses per quarter of the note tables
+     * @param bpm the initial tempo, ignored in expressive mode
+     * @param generateProgramChanges if true, program change events are generated from the part names
+     * @param exportExpressiveMidi if true, the milliseconds dates of the notes are used, one tick is one millisecond
+     * @param partNotes returns the notes of a part by its index and element, or nullptr to compile them from the part
+     * @return the MIDI or nullptr if this MSM is empty
+     */
+    std::unique_ptr<midi::Midi> renderMidi(int ppq, double bpm, bool generateProgramChanges, bool exportExpressiveMidi,
+                                           const std::function<const NoteTable*(size_t, const Element&)>& partNotes) const;
+
     /**
      * Cleanup - static utility method
      * @param msmList list of MSM objects to cleanup
@@ -132,11 +193,11 @@ private:
     static std::string generateUUID();
 
     /**
-     * Convert timing attributes recursively
-     * @param element the element to process
-     * @param scaleFactor the scale factor for conversion
+     * Get the timing attributes of the document; they are collected in one traversal and kept
+     * until the document revision changes
+     * @return the date, date.end and duration attributes in document order
      */
-    void convertTimingAttributes(Element element, double scaleFactor);
+    const std::vector<Attribute>& getTimingAttributes() const;
 };
 
 } // namespace msm
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "common/common.h"
+#include "msm/NoteTable.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace meico {
+namespace midi {
+class Midi;
+}
+namespace msm {
+
+class Msm;
+class MsmStreamWriter;
+
+/**
+ * A rendered MSM that is not a copy of its score. It references the source MSM, which stays
+ * unaltered, and holds only the rendered notes of each part: a NoteTable whose changed columns
+ * and pending attributes are the deltas to the source. Everything else, i.e. the headers, maps
+ * and rests, is read from the source when the result is written.
+ *
+ * Several performances can be rendered into overlays of the same score without copying it;
+ * a full Msm is built only when materialize() is called. The source must outlive the overlay.
+ */
+class MsmOverlay {
+private:
+    const Msm* source;
+    int ppq;
+    std::string file;
+    std::vector<Element> parts;                 // the part elements of the source in document order
+    std::vector<NoteTable> notes;               // the rendered notes of each part, at ppq
+
+public:
+    /**
+     * Constructor
+     * @param source the source MSM
+     * @param ppq the pulses per quarter of the rendered notes
+     * @param parts the part elements of the source in document order
+     * @param notes the rendered notes of each part
+     */
+    MsmOverlay(const Msm& source, int ppq, std::vector<Element> parts, std::vector<NoteTable> notes);
+
+    /**
+     * Get the source MSM
+     * @return the source
+     */
+    const Msm& getSource() const { return *source; }
+
+    /**
+     * Get the timing resolution of the result
+     * @return the pulses per quarter
+     */
+    int getPPQ() const { return ppq; }
+
+    /**
+     * Get the file path of the result
+     * @return the file path
+     */
+    const std::string& getFile() const { return file; }
+
+    /**
+     * Set the file path of the result
+     * @param filePath the file path
+     */
+    void setFile(const std::string& filePath) { file = filePath; }
+
+    /**
+     * Get the number of parts
+     * @return the number of parts
+     */
+    size_t getPartCount() const { return parts.size(); }
+
+    /**
+     * Get the source element of a part
+     * @param index the part index
+     * @return the part element
+     */
+    Element getPart(size_t index) const { return parts[index]; }
+
+    /**
+     * Get the rendered notes of a part
+     * @param index the part index
+     * @return the note table
+     */
+    NoteTable& getNoteTable(size_t index) { return notes[index]; }
+    const NoteTable& getNoteTable(size_t index) const { return notes[index]; }
+
+    /**
+     * Write the result document, the source with the rendered notes
+     * @param writer the writer
+     * @return true if the output stream is in a good state
+     */
+    bool write(MsmStreamWriter& writer) const;
+
+    /**
+     * Build the result as a full MSM document
+     * @return the MSM
+     */
+    std::unique_ptr<Msm> materialize() const;
+
+    /**
+     * Convert the result into a Standard MIDI File with one tick per millisecond, directly from
+     * the rendered notes; neither the result document nor XML is generated
+     * @param generateProgramChanges if true, program change events are generated from the part names
+     * @return the MIDI
+     */
+    std::unique_ptr<midi::Midi> exportExpressiveMidi(bool generateProgramChanges = true) const;
+};
+
+} // namespace msm
+} // namespace meico
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "common/common.h"
+#include "msm/NoteTable.h"
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+namespace meico {
+namespace msm {
+
+/**
+ * A streaming pull-parser for MSM. It reads the input in fixed-size chunks and never builds a
+ * document tree; the notes of the parts' scores are compiled straight into NoteTable batches of
+ * bounded size, all other map entries are reported one at a time. Memory consumption depends
+ * on the batch size and the nesting depth, not on the size of the score.
+ *
+ * Usage, either pull the events:
+ *     MsmStreamReader reader(input);
+ *     for (auto event = reader.next(); event != MsmStreamReader::Event::END; event = reader.next()) { ... }
+ * or push them into a Handler with read().
+ */
+class MsmStreamReader {
+public:
+    /**
+     * The events of the stream
+     */
+    enum class Event {
+        MSM,            // the msm root element, getElement() holds its attributes (title, pulsesPerQuarter)
+        PART_BEGIN,     // a part starts, getElement() holds its attributes (name, number, midi.channel, midi.port)
+        PART_END,       // the current part ends
+        NOTES,          // a batch of notes of the current part's score, see getNotes()
+        MAP_ELEMENT,    // an entry of a map other than the score, see getMapName() and getElement(); getPart() is nullptr for global maps
+        END             // end of input
+    };
+
+    /**
+     * An element as it was read from the stream, name and attributes without children
+     */
+    class StreamElement {
+    private:
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> attributes;
+        size_t attributeCount = 0;              // the vectors are reused, entries beyond this count are stale
+
+        friend class MsmStreamReader;
+
+    public:
+        /**
+         * Get the element name
+         * @return the name
+         */
+        const std::string& getName() const { return name; }
+
+        /**
+         * Get an attribute value
+         * @param attributeName the attribute name
+         * @return the value or nullptr if the element has no such attribute
+         */
+        const char* attribute(std::string_view attributeName) const;
+
+        /**
+         * Get the number of attributes
+         * @return the number of attributes
+         */
+        size_t getAttributeCount() const { return attributeCount; }
+
+        /**
+         * Get an attribute by index
+         * @param index the index
+         * @return name and value
+         */
+        const std::pair<std::string, std::string>& getAttribute(size_t index) const { return attributes[index]; }
+    };
+
+    /**
+     * Receiver of the events for read()
+     */
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        virtual void onMsm(const StreamElement& msm) { (void)msm; }
+        virtual void onPartBegin(const StreamElement& part) { (void)part; }
+        virtual void onPartEnd(const StreamElement& part) { (void)part; }
+        virtual void onNotes(const StreamElement& part, NoteTable& notes) { (void)part; (void)notes; }
+        virtual void onMapElement(const StreamElement* part, const std::string& mapName, const StreamElement& element) { (void)part; (void)mapName; (void)element; }
+    };
+
+    static const size_t DEFAULT_BATCH_SIZE = 4096;
+    static const size_t CHUNK_SIZE = 65536;
+
+private:
+    /**
+     * A tag from the input
+     */
+    enum class TagType { START, END, EMPTY };
+
+    std::istream& input;
+    std::vector<char> chunk;                    // the current chunk of input
+    size_t chunkPosition = 0;
+    size_t chunkLength = 0;
+
+    size_t batchSize;
+    int ppq = 720;
+    NoteTable notes;                            // the current batch of notes
+
+    std::vector<std::string> path;              // the names of the open elements
+    StreamElement element;                      // the element of the last tag
+    TagType tagType = TagType::START;
+    bool tagPending = false;                    // the last tag has been read but not processed, as a batch of notes was delivered first
+    StreamElement part;                         // the current part
+    bool inPart = false;
+    bool partEnded = false;                     // the last event was PART_END
+    std::string mapName;
+    std::string text;                           // reused buffer for raw attribute values
+
+public:
+    /**
+     * Constructor
+     * @param input the stream to read MSM from
+     * @param batchSize the maximum number of notes per NOTES event
+     */
+    explicit MsmStreamReader(std::istream& input, size_t batchSize = DEFAULT_BATCH_SIZE);
+
+    /**
+     * Read up to the next event
+     * @return the event
+     * @throws ParsingException if the input is not well-formed
+     */
+    Event next();
+
+    /**
+     * Read the whole input and deliver all events to a handler
+     * @param handler the handler
+     */
+    void read(Handler& handler);
+
+    /**
+     * Get the element of the last MSM, PART_BEGIN or MAP_ELEMENT event
+     * @return the element
+     */
+    const StreamElement& getElement() const { return element; }
+
+    /**
+     * Get the part that is currently being read
+     * @return the part or nullptr outside of parts
+     */
+    const StreamElement* getPart() const { return inPart ? &part : nullptr; }
+
+    /**
+     * Get the name of the map of the last MAP_ELEMENT event, e.g. "tempoMap" or "sequencingMap"
+     * @return the map name
+     */
+    const std::string& getMapName() const { return mapName; }
+
+    /**
+     * Get the notes of the last NOTES event; the table is cleared and refilled by the next call of next()
+     * @return the batch of notes
+     */
+    NoteTable& getNotes() { return notes; }
+
+    /**
+     * Get the pulses per quarter of the msm; it is known after the MSM event
+     * @return pulses per quarter
+     */
+    int getPPQ() const { return ppq; }
+
+private:
+    /**
+     * Get the next character of the input
+     * @param c receives the character
+     * @return false at the end of the input
+     */
+    bool get(char& c);
+
+    /**
+     * Skip input up to and including a terminator string
+     * @param terminator the terminator
+     */
+    void skipPast(std::string_view terminator);
+
+    /**
+     * Read the next start, end or empty-element tag into element and tagType, text, comments and processing instructions are skipped
+     * @return false at the end of the input
+     */
+    bool readTag();
+
+    /**
+     * Read an attribute value and resolve the entity and character references
+     * @param quote the quote character that terminates the value
+     * @param value receives the value
+     */
+    void readAttributeValue(char quote, std::string& value);
+
+    /**
+     * Process the last tag
+     * @param event receives the event if the tag caused one
+     * @return true if there is an event
+     */
+    bool process(Event& event);
+
+    /**
+     * Check if the current tag is a note in a score
+     * @return true if so
+     */
+    bool isScoreNote() const;
+
+    /**
+     * Compile the current element into a row of the note batch
+     */
+    void addNote();
+};
+
+} // namespace msm
+} // namespace meico
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "common/common.h"
+#include "msm/NoteTable.h"
+#include "msm/TimingScale.h"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+namespace meico {
+namespace msm {
+
+class Msm;
+
+/**
+ * A streaming XML writer for MSM. Elements are written as they come, so a rendered performance
+ * can be serialized part by part and note by note without holding the result document; see
+ * Performance::perform(const Msm&, MsmStreamWriter&). The notes of a score can be written from
+ * a NoteTable, including the columns and attributes that have not been written back.
+ *
+ * The output is formatted like pugixml's default (tab indentation, "<note ... />") or, in
+ * compact mode, like pugixml's format_raw without any whitespace between the elements.
+ */
+class MsmStreamWriter {
+private:
+    static const unsigned NEWLINE = 1;
+    static const unsigned INDENT = 2;
+
+    std::ostream& output;
+    bool compact;
+    TimingScale timeScale;                      // conversion of the timing attributes of copied elements
+
+    std::vector<std::string> openElements;      // the names of the elements that have been started but not ended
+    bool startTagOpen = false;                  // the last start tag has not been closed with '>' yet
+    unsigned depth = 0;
+    unsigned indentFlags = INDENT;              // the whitespace to write before the next node
+
+    // reused buffers for writing notes
+    std::vector<std::pair<std::string, std::string>> noteAttributes;
+    size_t noteAttributeCount = 0;
+    std::vector<std::pair<const char*, double>> changedAttributes;
+    std::vector<size_t> pendingOrder;           // indices of the table's pending attributes sorted by row
+    size_t pendingCursor = 0;
+    bool pendingInRowOrder = false;             // the notes are written in row order, pendingOrder is valid
+
+public:
+    /**
+     * Constructor
+     * @param output the stream to write to, e.g. a std::ofstream or std::ostringstream
+     * @param compact if true, no line breaks and indentation are written
+     */
+    explicit MsmStreamWriter(std::ostream& output, bool compact = false);
+
+    /**
+     * Check if the writer is in compact mode
+     * @return true if no whitespace is written between the elements
+     */
+    bool isCompact() const { return compact; }
+
+    /**
+     * Set a conversion for the date, date.end and duration attributes of the elements copied with
+     * startElement(const Element&) and writeNode(); this converts the timing resolution while writing
+     * @param scale the conversion, the identity writes the values unaltered
+     */
+    void setTimeScale(const TimingScale& scale) { timeScale = scale; }
+
+    /**
+     * Write the xml declaration, pugixml writes the same if the document has no declaration
+     */
+    void writeDeclaration();
+
+    /**
+     * Start an element; attributes can be added until content is written
+     * @param name the element name
+     */
+    void startElement(std::string_view name);
+
+    /**
+     * Add an attribute to the element that has just been started
+     * @param name the attribute name
+     * @param value the value
+     */
+    void attribute(std::string_view name, std::string_view value);
+
+    /**
+     * Add a numeric attribute in its shortest round-trip representation
+     * @param name the attribute name
+     * @param value the value
+     */
+    void attribute(std::string_view name, double value);
+
+    /**
+     * Start an element with the name and attributes of a DOM element, but not its children
+     * @param element the element
+     */
+    void startElement(const Element& element);
+
+    /**
+     * End the innermost open element
+     */
+    void endElement();
+
+    /**
+     * Write text content
+     * @param text the text
+     */
+    void text(std::string_view text);
+
+    /**
+     * Write a DOM node with all its descendants
+     * @param node the node
+     * @param notes if the subtree contains the score these notes were compiled from, its notes are written from the table
+     */
+    void writeNode(const Element& node, const NoteTable* notes = nullptr);
+
+    /**
+     * Write one note of a table. Rows with a note element write its attributes with the changed
+     * columns and pending attributes applied, like NoteTable::writeBack(); rows without element
+     * write their columns.
+     * @param notes the table
+     * @param row the row index
+     */
+    void writeNote(const NoteTable& notes, size_t row);
+
+    /**
+     * Write all notes of a table
+     * @param notes the table
+     */
+    void writeNotes(const NoteTable& notes);
+
+    /**
+     * Write a whole MSM document
+     * @param msm the MSM
+     */
+    void writeMsm(const Msm& msm);
+
+    /**
+     * Write a whole MSM document at another timing resolution with the notes of its parts taken
+     * from note tables. The timing attributes of everything that is copied are scaled to the new
+     * resolution; the tables must hold their dates at the new resolution already.
+     * @param msm the MSM
+     * @param ppq the pulses per quarter of the output
+     * @param partNotes called for each part in document order with its index and element, returns the table to write the part's notes from or nullptr to copy them
+     */
+    void writeMsm(const Msm& msm, int ppq, const std::function<const NoteTable*(size_t, const Element&)>& partNotes);
+
+    /**
+     * End all open elements and flush the output
+     * @return true if the output stream is in a good state
+     */
+    bool finish();
+
+private:
+    /**
+     * Close a start tag that is still open, because content follows
+     */
+    void closeStartTag();
+
+    /**
+     * Write the line break and indentation before a node
+     */
+    void beginNode();
+
+    /**
+     * Write a string with the special characters escaped
+     * @param value the string
+     * @param isAttribute true for attribute values, false for text content
+     */
+    void writeEscaped(std::string_view value, bool isAttribute);
+
+    /**
+     * Write the score element with its notes taken from a table
+     * @param score the score element
+     * @param notes the table that was compiled from it
+     */
+    void writeScore(const Element& score, const NoteTable& notes);
+
+    /**
+     * Write the channel volume events of a table as the part's channelVolumeMap
+     * @param notes the table
+     */
+    void writeChannelVolume(const NoteTable& notes);
+
+    /**
+     * Sort the pending attributes of a table by row, so that writing the rows in ascending order
+     * finds them with a cursor instead of scanning all of them for every note
+     * @param notes the table
+     */
+    void preparePendingAttributes(const NoteTable& notes);
+
+    /**
+     * Set an attribute in the note attribute buffer or append it
+     * @param name the name
+     * @param value the value
+     */
+    void setNoteAttribute(std::string_view name, std::string_view value);
+
+    /**
+     * Check if an attribute holds a date or duration in ticks
+     * @param name the attribute name
+     * @return true for date, date.end and duration
+     */
+    static bool isTimingAttribute(std::string_view name);
+};
+
+} // namespace msm
+} // namespace meico
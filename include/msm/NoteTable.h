@@ -0,0 +1,300 @@
+#pragma once
+
+#include "common/common.h"
+#include "supplementary/IdIndex.h"
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace meico {
+namespace xml {
+    class XmlBase;
+}
+
+namespace msm {
+
+/**
+ * A compiled, column-oriented (struct-of-arrays) representation of the notes in one MSM part.
+ * It is built once from the part's score, the performance maps render against its columns,
+ * and the result is serialized back to the XML only once by writeBack().
+ */
+class NoteTable {
+public:
+    // row flags: which attributes the note carries
+    static const uint32_t HAS_DATE = 1u << 0;
+    static const uint32_t HAS_DURATION = 1u << 1;
+    static const uint32_t HAS_PITCH = 1u << 2;
+    static const uint32_t HAS_VELOCITY = 1u << 3;
+
+    // row flags: which columns have been changed by rendering and must be written back
+    static const uint32_t DATE_CHANGED = 1u << 8;
+    static const uint32_t DURATION_CHANGED = 1u << 9;
+    static const uint32_t VELOCITY_CHANGED = 1u << 10;
+    static const uint32_t TEMPO_CHANGED = 1u << 11;
+    static const uint32_t MILLISECONDS_CHANGED = 1u << 12;
+
+private:
+    Element score;                                  // the score element the rows were compiled from
+    int ppq = 720;                                  // the timing resolution of the dates, pulses per quarter
+
+    // the columns, one entry per note
+    std::vector<Element> elements;                  // the note elements, for writing back
+    std::vector<double> date;
+    std::vector<double> duration;
+    std::vector<double> pitch;
+    std::vector<double> velocity;
+    std::vector<double> tempo;
+    std::vector<double> millisecondsDate;
+    std::vector<double> millisecondsDuration;
+    std::vector<int32_t> idIndex;                   // index into idRanges or -1 if the note has no xml:id
+    std::vector<uint32_t> flags;
+
+    // the xml:id strings of the notes are interned in one pool instead of one std::string each
+    struct IdRange {
+        uint32_t offset;
+        uint32_t length;
+    };
+    std::string idPool;
+    std::vector<IdRange> idRanges;
+    mutable supplementary::IdIndex rowsById;       // xml:id -> row, built on the first findRow() call
+
+    /**
+     * Intern an xml:id
+     * @param id the id, not empty
+     * @return its index in idRanges
+     */
+    int32_t internId(std::string_view id);
+
+public:
+    /**
+     * An additional attribute to be written to a note, e.g. ornament or detune information
+     */
+    struct PendingAttribute {
+        size_t row;
+        std::string name;
+        std::string value;
+    };
+
+    /**
+     * A channel volume event of the part, e.g. rendered from sub-note dynamics; it is written
+     * to the part's channelVolumeMap as a volume element
+     */
+    struct ChannelVolume {
+        double date;
+        double millisecondsDate;
+        double value;
+        bool mandatory;                             // exported to MIDI even if it is closer than Msm::CONTROL_CHANGE_DENSITY to the next one
+    };
+
+private:
+    std::vector<PendingAttribute> pendingAttributes;
+    std::vector<ChannelVolume> channelVolume;       // in date order
+
+public:
+    /**
+     * Default constructor, generates an empty table
+     */
+    NoteTable() = default;
+
+    /**
+     * Constructor, compiles the notes of the specified MSM part
+     * @param msmPart the MSM part element
+     */
+    explicit NoteTable(Element msmPart);
+
+    /**
+     * Locate the score map of an MSM part; it is either at part/dated/score or at part/header/dated/score
+     * @param msmPart the MSM part element
+     * @return the score element or an empty element if there is none
+     */
+    static Element findScore(const Element& msmPart);
+
+    /**
+     * Append a row that has no note element, e.g. a note read by a streaming parser; such rows
+     * can be rendered but writeBack() has no element to write them to
+     * @param date the date
+     * @param duration the duration
+     * @param pitch the MIDI pitch
+     * @param velocity the velocity
+     * @param id the xml:id or an empty string
+     * @param hasFlags the HAS_* flags of the attributes that were present
+     */
+    void addNote(double date, double duration, double pitch, double velocity, std::string_view id, uint32_t hasFlags);
+
+    /**
+     * Append all rows of another table
+     * @param other the other table
+     */
+    void append(const NoteTable& other);
+
+    /**
+     * Remove all rows; the capacity of the columns is kept, so the table can be refilled without allocations
+     */
+    void clear();
+
+    /**
+     * Get the number of notes
+     * @return number of rows
+     */
+    size_t size() const { return flags.size(); }
+
+    /**
+     * Check if the table is empty
+     * @return true if there are no notes
+     */
+    bool isEmpty() const { return flags.empty(); }
+
+    /**
+     * Get the score element the table was compiled from
+     * @return the score element
+     */
+    Element getScore() const { return score; }
+
+    /**
+     * Get the timing resolution of the note dates, it is read from the MSM's pulsesPerQuarter attribute
+     * @return pulses per quarter
+     */
+    int getPPQ() const { return ppq; }
+
+    /**
+     * Set the timing resolution of the note dates
+     * @param ppq pulses per quarter
+     */
+    void setPPQ(int ppq) { this->ppq = ppq; }
+
+    /**
+     * Convert the dates and durations to another timing resolution; the converted columns are
+     * marked as changed, so they are written like rendered values
+     * @param ppq the new pulses per quarter
+     */
+    void convertPPQ(int ppq);
+
+    /**
+     * Get the note element of a row
+     * @param row the row index
+     * @return the note element
+     */
+    Element getElement(size_t row) const { return elements[row]; }
+
+    // column read access
+    double getDate(size_t row) const { return date[row]; }
+    double getDuration(size_t row) const { return duration[row]; }
+    double getPitch(size_t row) const { return pitch[row]; }
+    double getVelocity(size_t row) const { return velocity[row]; }
+    double getTempo(size_t row) const { return tempo[row]; }
+    double getMillisecondsDate(size_t row) const { return millisecondsDate[row]; }
+    double getMillisecondsDuration(size_t row) const { return millisecondsDuration[row]; }
+    int32_t getIdIndex(size_t row) const { return idIndex[row]; }
+    uint32_t getFlags(size_t row) const { return flags[row]; }
+
+    /**
+     * Check a flag of a row
+     * @param row the row index
+     * @param flag one of the flag constants
+     * @return true if the flag is set
+     */
+    bool hasFlag(size_t row, uint32_t flag) const { return (flags[row] & flag) != 0; }
+
+    /**
+     * Get the xml:id of a row
+     * @param row the row index
+     * @return the id or an empty string
+     */
+    std::string_view getId(size_t row) const;
+
+    /**
+     * Find the row of a note by its xml:id in constant time; the index is built on the first call
+     * and rebuilt after rows have been added. It is not synchronized, so a table that is read by
+     * several threads should call it once before it is shared.
+     * @param id the xml:id without leading '#'
+     * @return the row or -1 if there is no note with this id
+     */
+    long findRow(std::string_view id) const;
+
+    /**
+     * Get the row indices sorted by date; the sort is stable, so simultaneous notes keep their document order
+     * @return the rows in date order
+     */
+    std::vector<size_t> getRowsInDateOrder() const;
+
+    // column write access, these mark the column for writing back
+    void setDate(size_t row, double value);
+    void setDuration(size_t row, double value);
+    void setVelocity(size_t row, double value);
+    void setTempo(size_t row, double value);
+    void setMilliseconds(size_t row, double dateMs, double durationMs);
+
+    /**
+     * Add an attribute to the note of a row; it is written when writeBack() is called
+     * @param row the row index
+     * @param name the attribute name
+     * @param value the attribute value
+     */
+    void addAttribute(size_t row, const std::string& name, const std::string& value);
+
+    /**
+     * Get the additional attributes that have not been written back yet, in the order they were added
+     * @return the pending attributes
+     */
+    const std::vector<PendingAttribute>& getPendingAttributes() const { return pendingAttributes; }
+
+    /**
+     * Append a channel volume event; the events have to be added in date order
+     * @param event the event
+     */
+    void addChannelVolume(const ChannelVolume& event) { channelVolume.push_back(event); }
+
+    /**
+     * Get the channel volume events, e.g. of sub-note dynamics
+     * @return the events in date order
+     */
+    const std::vector<ChannelVolume>& getChannelVolume() const { return channelVolume; }
+
+    /**
+     * Get the numeric attributes that writeBack() writes for the changed columns of a row, in the order it writes them
+     * @param row the row index
+     * @param attributes receives the attribute names and values, it is cleared first
+     */
+    void getChangedAttributes(size_t row, std::vector<std::pair<const char*, double>>& attributes) const;
+
+    /**
+     * Serialize all changed columns and additional attributes into the note elements; channel
+     * volume events replace the channelVolumeMap next to the score
+     */
+    void writeBack();
+
+    /**
+     * Serialize like writeBack() and mark the document that contains the part as modified, so
+     * that its indices, e.g. of getElementById(), see the replaced channelVolumeMap and new ids
+     * @param document the MSM that contains the part
+     */
+    void writeBack(xml::XmlBase& document);
+
+private:
+    /**
+     * Append one row compiled from a note element
+     * @param note the note element
+     */
+    void addNote(const Element& note);
+
+    /**
+     * Set the value of an attribute or create it if it does not exist
+     * @param note the note element
+     * @param name the attribute name
+     * @param value the value
+     */
+    static void writeAttribute(Element note, const char* name, const std::string& value);
+
+    /**
+     * Set a numeric attribute in its shortest round-trip representation or create it if it does not exist
+     * @param note the note element
+     * @param name the attribute name
+     * @param value the value
+     */
+    static void writeAttribute(Element note, const char* name, double value);
+};
+
+} // namespace msm
+} // namespace meico
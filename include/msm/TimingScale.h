@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace meico {
+namespace msm {
+
+/**
+ * The exact conversion of timing values (date, date.end, duration) from one timing resolution
+ * to another. The factor is kept as the reduced fraction newPPQ/oldPPQ instead of a double;
+ * integer values are scaled with integer arithmetic, so they stay integers whenever the result
+ * is one and are rounded only once otherwise. Repeated conversions do not drift.
+ */
+class TimingScale {
+private:
+    int64_t numerator = 1;
+    int64_t denominator = 1;
+
+public:
+    /**
+     * Constructor, the identity
+     */
+    TimingScale() = default;
+
+    /**
+     * Constructor
+     * @param fromPPQ the pulses per quarter of the values
+     * @param toPPQ the pulses per quarter to convert them to
+     */
+    TimingScale(int fromPPQ, int toPPQ);
+
+    /**
+     * Check if the values are not changed
+     * @return true if both resolutions are equal
+     */
+    bool isIdentity() const { return numerator == denominator; }
+
+    int64_t getNumerator() const { return numerator; }
+    int64_t getDenominator() const { return denominator; }
+
+    /**
+     * Convert a value
+     * @param value the value at the old resolution
+     * @return the value at the new resolution
+     */
+    double apply(double value) const;
+};
+
+} // namespace msm
+} // namespace meico
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace meico {
+namespace supplementary {
+
+/**
+ * Writes fixed-width values and length-prefixed strings into a byte buffer. The values are
+ * stored in host byte order; readers on a host with another byte order must reject the data,
+ * see BinaryReader.
+ */
+class BinaryWriter {
+private:
+    std::string buffer;
+
+public:
+    /**
+     * Constructor
+     */
+    BinaryWriter() = default;
+
+    void writeBool(bool value) { writeUInt8(value ? 1 : 0); }
+    void writeUInt8(uint8_t value) { writeRaw(value); }
+    void writeInt32(int32_t value) { writeRaw(value); }
+    void writeUInt32(uint32_t value) { writeRaw(value); }
+    void writeInt64(int64_t value) { writeRaw(value); }
+    void writeUInt64(uint64_t value) { writeRaw(value); }
+    void writeDouble(double value) { writeRaw(value); }
+
+    /**
+     * Write a string with a 32 bit length prefix
+     * @param value the string
+     */
+    void writeString(std::string_view value);
+
+    /**
+     * Write an optional value as a presence flag followed by the value
+     * @param value the value or nullptr
+     */
+    void writeOptional(const std::shared_ptr<double>& value) {
+        writeBool(value != nullptr);
+        writeDouble(value ? *value : 0.0);
+    }
+
+    /**
+     * Write a 64 bit placeholder that is filled in later with patchUInt64(), e.g. the length of a section
+     * @return the position of the placeholder
+     */
+    size_t reserveUInt64();
+
+    /**
+     * Overwrite a 64 bit value at a position that has been written before
+     * @param position the position, see reserveUInt64()
+     * @param value the value
+     */
+    void patchUInt64(size_t position, uint64_t value);
+
+    /**
+     * Get the number of bytes written
+     * @return the size
+     */
+    size_t size() const { return buffer.size(); }
+
+    /**
+     * Get the bytes written so far
+     * @return the buffer
+     */
+    const std::string& getBuffer() const { return buffer; }
+
+private:
+    template<typename T>
+    void writeRaw(T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        buffer.append(bytes, sizeof(T));
+    }
+};
+
+/**
+ * Reads the values of a BinaryWriter from memory, e.g. from a memory mapped file, without copying
+ * the buffer. Reading beyond the end does not throw; it returns zero values and sets a failure flag,
+ * so a truncated or corrupt input is detected once with good() at the end.
+ */
+class BinaryReader {
+private:
+    const char* data;
+    size_t length;
+    size_t position = 0;
+    bool failed = false;
+
+public:
+    /**
+     * Constructor
+     * @param data the bytes, they must outlive the reader and the string views it returns
+     * @param length the number of bytes
+     */
+    BinaryReader(const char* data, size_t length) : data(data), length(length) {}
+
+    bool readBool() { return readUInt8() != 0; }
+    uint8_t readUInt8() { return readRaw<uint8_t>(); }
+    int32_t readInt32() { return readRaw<int32_t>(); }
+    uint32_t readUInt32() { return readRaw<uint32_t>(); }
+    int64_t readInt64() { return readRaw<int64_t>(); }
+    uint64_t readUInt64() { return readRaw<uint64_t>(); }
+    double readDouble() { return readRaw<double>(); }
+
+    /**
+     * Read a length-prefixed string
+     * @return a view into the input, empty if the input is exhausted
+     */
+    std::string_view readString();
+
+    /**
+     * Read an optional value, see BinaryWriter::writeOptional()
+     * @return the value or nullptr
+     */
+    std::shared_ptr<double> readOptional() {
+        bool present = readBool();
+        double value = readDouble();
+        return present ? std::make_shared<double>(value) : nullptr;
+    }
+
+    /**
+     * Read a number of raw bytes
+     * @param count the number of bytes
+     * @return a pointer into the input or nullptr if there are not enough bytes left
+     */
+    const char* readBytes(size_t count);
+
+    /**
+     * Skip a number of bytes
+     * @param count the number of bytes
+     * @return false if there are not enough bytes left
+     */
+    bool skip(size_t count) { return readBytes(count) != nullptr; }
+
+    /**
+     * Get the read position
+     * @return the number of bytes read
+     */
+    size_t getPosition() const { return position; }
+
+    /**
+     * Get the number of bytes that have not been read
+     * @return the remaining bytes
+     */
+    size_t remaining() const { return length - position; }
+
+    /**
+     * Check if all reads so far were within the input
+     * @return false if a read went beyond the end of the input or fail() was called
+     */
+    bool good() const { return !failed; }
+
+    /**
+     * Mark the input as invalid, e.g. when a read value is out of range
+     */
+    void fail() { failed = true; }
+
+private:
+    template<typename T>
+    T readRaw() {
+        T value{};
+        const char* bytes = readBytes(sizeof(T));
+        if (bytes) {
+            std::memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+    }
+};
+
+} // namespace supplementary
+} // namespace meico
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace meico {
+namespace supplementary {
+
+/**
+ * A hash index from ids (e.g. xml:id strings) to the positions of the items that carry them.
+ * The index stores only positions in an open-addressing table, 4 bytes per slot; the id strings
+ * stay with the items, they are read through the keyOf function object and compared on lookup.
+ * So the index is compact and it is not invalidated when its owner is copied or moved. The strings
+ * that keyOf returns must stay valid while the index is used; it has to be rebuilt when items are
+ * added, removed or their ids change.
+ */
+class IdIndex {
+private:
+    std::vector<uint32_t> slots;                // position + 1 of the item, 0 marks an empty slot
+
+public:
+    /**
+     * Build the index over a number of items; items with an empty id are left out, of items with
+     * the same id the first one is found
+     * @param count the number of items
+     * @param keyOf function that returns the id of an item by its position as std::string_view
+     */
+    template<typename KeyOf>
+    void build(size_t count, KeyOf keyOf) {
+        size_t capacity = 16;
+        while (capacity < 2 * count) {          // at most half of the slots are used, so probe sequences stay short
+            capacity *= 2;
+        }
+        slots.assign(capacity, 0);
+
+        size_t mask = capacity - 1;
+        for (size_t position = 0; position < count; ++position) {
+            std::string_view id = keyOf(position);
+            if (id.empty()) {
+                continue;
+            }
+            size_t slot = std::hash<std::string_view>()(id) & mask;
+            for (; slots[slot] != 0; slot = (slot + 1) & mask) {
+                if (keyOf(slots[slot] - 1) == id) {
+                    break;                      // a duplicate id, keep the first item
+                }
+            }
+            if (slots[slot] == 0) {
+                slots[slot] = static_cast<uint32_t>(position + 1);
+            }
+        }
+    }
+
+    /**
+     * Look up an id
+     * @param id the id
+     * @param keyOf the function that the index was built with
+     * @return the position of the item or -1 if there is none with this id
+     */
+    template<typename KeyOf>
+    long find(std::string_view id, KeyOf keyOf) const {
+        if (slots.empty() || id.empty()) {
+            return -1;
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t slot = std::hash<std::string_view>()(id) & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+            if (keyOf(slots[slot] - 1) == id) {
+                return static_cast<long>(slots[slot] - 1);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Check if the index has been built
+     * @return false after clear() or before the first build()
+     */
+    bool isBuilt() const { return !slots.empty(); }
+
+    /**
+     * Drop the index, it has to be built again before lookups
+     */
+    void clear() { slots.clear(); }
+};
+
+} // namespace supplementary
+} // namespace meico
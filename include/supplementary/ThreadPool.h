@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <memory>
+#include <cstdint>
+
+namespace meico {
+namespace supplementary {
+
+/**
+ * A fixed set of worker threads that process the iterations of a loop concurrently.
+ * The thread that calls parallelFor() takes part in the work, so a pool of size n
+ * starts n - 1 workers; a pool of size 1 runs everything on the calling thread.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    unsigned concurrency;
+
+    std::mutex mutex;
+    std::condition_variable wake;                   // notifies the workers of a new loop or of shutdown
+    std::condition_variable done;                   // notifies the caller that all workers have finished the loop
+    std::mutex runMutex;                            // one loop at a time
+
+    const std::function<void(size_t)>* task = nullptr;
+    size_t count = 0;                               // the number of iterations of the current loop
+    std::atomic<size_t> next{0};                    // the next iteration to be processed
+    size_t active = 0;                              // the number of workers that have not finished the current loop
+    uint64_t generation = 0;                        // counts the loops, so the workers recognize a new one
+    bool stopping = false;
+    std::exception_ptr error;                       // the first exception thrown by an iteration
+
+public:
+    /**
+     * Constructor
+     * @param threads the number of threads that work on a loop, including the calling thread; 0 means one per hardware thread
+     */
+    explicit ThreadPool(unsigned threads = 0);
+
+    /**
+     * Destructor, stops and joins the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * ThreadPool factory
+     * @param threads the number of threads, 0 means one per hardware thread
+     * @return new ThreadPool instance
+     */
+    static std::shared_ptr<ThreadPool> createThreadPool(unsigned threads = 0);
+
+    /**
+     * Get the number of threads that work on a loop, including the calling thread
+     * @return the number of threads
+     */
+    size_t size() const;
+
+    /**
+     * Call task(i) for all i in [0, count) and return when all calls have finished. The
+     * iterations are distributed dynamically over the threads, so they must be independent.
+     * If an iteration throws, the first exception is rethrown here after the loop.
+     * @param count the number of iterations
+     * @param task the loop body
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    /**
+     * The loop of a worker thread
+     */
+    void workerLoop();
+
+    /**
+     * Process iterations of the current loop until there are none left
+     */
+    void work();
+};
+
+} // namespace supplementary
+} // namespace meico
@@ -0,0 +1,329 @@
+#pragma once
+
+#include "supplementary/KeyValue.h"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace meico {
+namespace supplementary {
+
+/**
+ * Date lookups on random access containers whose entries are sorted by date.
+ * The date of an entry is read by the dateOf function object, so these work for
+ * Timelines as well as for plain vectors of data objects.
+ */
+namespace timeline {
+
+/**
+ * Get the index of the last entry before or at the specified date (binary search)
+ * @param entries the date-sorted entries
+ * @param date the date
+ * @param dateOf function that returns the date of an entry
+ * @return the index or -1 if there is no entry before or at the date
+ */
+template<typename Container, typename DateOf>
+int indexBeforeAt(const Container& entries, double date, DateOf dateOf) {
+    if (entries.empty() || (dateOf(entries[0]) > date)) {                     // nothing or it starts after the date
+        return -1;
+    }
+    if (dateOf(entries[entries.size() - 1]) <= date) {                       // maps are usually queried at their end while they are filled
+        return static_cast<int>(entries.size()) - 1;
+    }
+    auto it = std::upper_bound(entries.begin(), entries.end(), date,
+        [&dateOf](double d, const auto& entry) { return d < dateOf(entry); });
+    return static_cast<int>(it - entries.begin()) - 1;
+}
+
+/**
+ * Get the index of the first entry after the specified date (binary search)
+ * @param entries the date-sorted entries
+ * @param date the date
+ * @param dateOf function that returns the date of an entry
+ * @return the index or -1 if there is no entry after the date
+ */
+template<typename Container, typename DateOf>
+int indexAfter(const Container& entries, double date, DateOf dateOf) {
+    int index = indexBeforeAt(entries, date, dateOf) + 1;
+    return (index < static_cast<int>(entries.size())) ? index : -1;
+}
+
+/**
+ * Get the index of the first entry at or after the specified date (binary search)
+ * @param entries the date-sorted entries
+ * @param date the date
+ * @param dateOf function that returns the date of an entry
+ * @return the index or -1 if there is no entry at or after the date
+ */
+template<typename Container, typename DateOf>
+int indexAtAfter(const Container& entries, double date, DateOf dateOf) {
+    auto it = std::lower_bound(entries.begin(), entries.end(), date,
+        [&dateOf](const auto& entry, double d) { return dateOf(entry) < d; });
+    return (it == entries.end()) ? -1 : static_cast<int>(it - entries.begin());
+}
+
+/**
+ * Get the index range of the entries with from <= date < to (binary search)
+ * @param entries the date-sorted entries
+ * @param from the start date (inclusive)
+ * @param to the end date (exclusive)
+ * @param dateOf function that returns the date of an entry
+ * @return the first index and the index after the last entry; both are equal if the range is empty
+ */
+template<typename Container, typename DateOf>
+std::pair<size_t, size_t> rangeOf(const Container& entries, double from, double to, DateOf dateOf) {
+    auto first = std::lower_bound(entries.begin(), entries.end(), from,
+        [&dateOf](const auto& entry, double d) { return dateOf(entry) < d; });
+    auto last = std::lower_bound(first, entries.end(), to,
+        [&dateOf](const auto& entry, double d) { return dateOf(entry) < d; });
+    return std::make_pair(static_cast<size_t>(first - entries.begin()), static_cast<size_t>(last - entries.begin()));
+}
+
+/**
+ * Monotonic lookup of the last entry before or at the specified date. The cursor is
+ * the number of entries before or at the previously queried date. Queries in ascending
+ * date order advance it in amortized constant time, a query out of order falls back
+ * to a binary search.
+ * @param entries the date-sorted entries
+ * @param date the date
+ * @param cursor the cursor, initialize with 0
+ * @param dateOf function that returns the date of an entry
+ * @return the index or -1 if there is no entry before or at the date
+ */
+template<typename Container, typename DateOf>
+int seekBeforeAt(const Container& entries, double date, size_t& cursor, DateOf dateOf) {
+    size_t size = entries.size();
+    if (cursor > size) {
+        cursor = size;
+    }
+
+    if ((cursor > 0) && (dateOf(entries[cursor - 1]) > date)) {     // moved backwards, search from scratch
+        cursor = static_cast<size_t>(indexBeforeAt(entries, date, dateOf) + 1);
+    }
+
+    while ((cursor < size) && (dateOf(entries[cursor]) <= date)) {
+        ++cursor;
+    }
+
+    return static_cast<int>(cursor) - 1;
+}
+
+/**
+ * Insert a value into a date-sorted vector, behind the entries at the same date
+ * @param entries the date-sorted entries
+ * @param value the value to insert
+ * @param dateOf function that returns the date of an entry
+ * @return the index of the new entry
+ */
+template<typename T, typename DateOf>
+size_t insertSorted(std::vector<T>& entries, T value, DateOf dateOf) {
+    double date = dateOf(value);
+    auto it = std::upper_bound(entries.begin(), entries.end(), date,
+        [&dateOf](double d, const T& entry) { return d < dateOf(entry); });
+    it = entries.insert(it, std::move(value));
+    return static_cast<size_t>(it - entries.begin());
+}
+
+/**
+ * Add a batch of entries in any order to a date-sorted vector. The batch is sorted
+ * once and merged in, instead of sorting or searching for each entry. The sort is
+ * stable and the new entries go behind existing entries at the same date, so
+ * entries at the same date keep the order in which they were added.
+ * @param entries the date-sorted entries
+ * @param batch the entries to add
+ * @param dateOf function that returns the date of an entry
+ */
+template<typename T, typename DateOf>
+void mergeBatch(std::vector<T>& entries, std::vector<T> batch, DateOf dateOf) {
+    auto byDate = [&dateOf](const T& a, const T& b) { return dateOf(a) < dateOf(b); };
+    if (!std::is_sorted(batch.begin(), batch.end(), byDate)) {   // batches from a cache or a sorted file need no sort
+        std::stable_sort(batch.begin(), batch.end(), byDate);
+    }
+
+    if (entries.empty()) {
+        entries = std::move(batch);
+        return;
+    }
+
+    size_t middle = entries.size();
+    entries.reserve(middle + batch.size());
+    std::move(batch.begin(), batch.end(), std::back_inserter(entries));
+    std::inplace_merge(entries.begin(), entries.begin() + middle, entries.end(), byDate);
+}
+
+} // namespace timeline
+
+/**
+ * A sequence of values sorted by date, the common storage of the performance maps.
+ * The entries are KeyValue pairs of date and value, so they can be accessed like the
+ * vectors the maps used before; lookups by date are binary searches.
+ * @tparam V value type
+ */
+template<typename V>
+class Timeline {
+public:
+    using Entry = KeyValue<double, V>;
+    using iterator = typename std::vector<Entry>::iterator;
+    using const_iterator = typename std::vector<Entry>::const_iterator;
+
+    /**
+     * A monotonic read cursor; it is meant for queries that arrive in date order,
+     * e.g. while rendering the notes of a score one after the other
+     */
+    class Cursor {
+    private:
+        const Timeline* timeline;
+        size_t position = 0;
+
+    public:
+        /**
+         * Constructor
+         * @param timeline the timeline to read
+         */
+        explicit Cursor(const Timeline& timeline) : timeline(&timeline) {}
+
+        /**
+         * Get the index of the last entry before or at the specified date
+         * @param date the date
+         * @return the index or -1 if there is none
+         */
+        int indexBeforeAt(double date) {
+            return timeline->seekBeforeAt(date, position);
+        }
+
+        /**
+         * Restart the cursor at the beginning of the timeline
+         */
+        void reset() {
+            position = 0;
+        }
+    };
+
+private:
+    std::vector<Entry> entries;
+
+    static double dateOf(const Entry& entry) {
+        return entry.getKey();
+    }
+
+public:
+    // vector-like access
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+    void reserve(size_t capacity) { entries.reserve(capacity); }
+    Entry& operator[](size_t index) { return entries[index]; }
+    const Entry& operator[](size_t index) const { return entries[index]; }
+    Entry& front() { return entries.front(); }
+    const Entry& front() const { return entries.front(); }
+    Entry& back() { return entries.back(); }
+    const Entry& back() const { return entries.back(); }
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    /**
+     * Get the date of an entry
+     * @param index the index
+     * @return the date
+     */
+    double getDate(size_t index) const {
+        return entries[index].getKey();
+    }
+
+    /**
+     * Insert a value at its position in the timeline, behind the entries at the same date
+     * like insertAll(), so entries at the same date keep the order in which they were added
+     * @param date the date
+     * @param value the value
+     * @return the index of the new entry
+     */
+    size_t insert(double date, V value) {
+        size_t index = static_cast<size_t>(timeline::indexAfter(entries, date, &Timeline::dateOf));
+        if (index > entries.size()) {           // -1, i.e. there is nothing after the date
+            index = entries.size();
+        }
+        entries.emplace(entries.begin() + index, date, std::move(value));
+        return index;
+    }
+
+    /**
+     * Add a batch of entries in any order; it is sorted once and merged in behind the entries
+     * at the same date, see timeline::mergeBatch()
+     * @param batch the entries
+     */
+    void insertAll(std::vector<Entry> batch) {
+        timeline::mergeBatch(entries, std::move(batch), &Timeline::dateOf);
+    }
+
+    /**
+     * Remove an entry
+     * @param index the index
+     */
+    void erase(size_t index) {
+        if (index < entries.size()) {
+            entries.erase(entries.begin() + index);
+        }
+    }
+
+    /**
+     * Get the index of the last entry before or at the specified date
+     * @param date the date
+     * @return the index or -1 if there is none
+     */
+    int indexBeforeAt(double date) const {
+        return timeline::indexBeforeAt(entries, date, &Timeline::dateOf);
+    }
+
+    /**
+     * Get the index of the first entry after the specified date
+     * @param date the date
+     * @return the index or -1 if there is none
+     */
+    int indexAfter(double date) const {
+        return timeline::indexAfter(entries, date, &Timeline::dateOf);
+    }
+
+    /**
+     * Get the index of the first entry at or after the specified date
+     * @param date the date
+     * @return the index or -1 if there is none
+     */
+    int indexAtAfter(double date) const {
+        return timeline::indexAtAfter(entries, date, &Timeline::dateOf);
+    }
+
+    /**
+     * Get the index range of the entries with from <= date < to
+     * @param from the start date (inclusive)
+     * @param to the end date (exclusive)
+     * @return the first index and the index after the last entry
+     */
+    std::pair<size_t, size_t> rangeOf(double from, double to) const {
+        return timeline::rangeOf(entries, from, to, &Timeline::dateOf);
+    }
+
+    /**
+     * Monotonic lookup of the last entry before or at the specified date, see timeline::seekBeforeAt()
+     * @param date the date
+     * @param cursor the cursor, initialize with 0
+     * @return the index or -1 if there is none
+     */
+    int seekBeforeAt(double date, size_t& cursor) const {
+        return timeline::seekBeforeAt(entries, date, cursor, &Timeline::dateOf);
+    }
+
+    /**
+     * Create a monotonic read cursor at the beginning of the timeline
+     * @return the cursor
+     */
+    Cursor cursor() const {
+        return Cursor(*this);
+    }
+};
+
+} // namespace supplementary
+} // namespace meico
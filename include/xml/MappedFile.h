@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstddef>
+
+namespace meico {
+namespace xml {
+
+/**
+ * A private, writable memory mapping of a file. pugixml's in-place parsing writes into the
+ * buffer (string terminators, unescaped entities); with MAP_PRIVATE these writes go to
+ * copy-on-write pages and never reach the file. Memory mapping is available on unix-like
+ * platforms; elsewhere open() returns nullptr and the callers read the file instead.
+ */
+class MappedFile {
+private:
+    char* address = nullptr;
+    size_t length = 0;
+
+    MappedFile(char* address, size_t length) : address(address), length(length) {}
+
+public:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    /**
+     * Map a file into memory
+     * @param filePath the file path
+     * @return the mapping or nullptr if the file cannot be mapped (not supported on this platform, empty or no regular file)
+     */
+    static std::shared_ptr<MappedFile> open(const std::string& filePath);
+
+    char* data() const { return address; }
+    size_t size() const { return length; }
+};
+
+} // namespace xml
+} // namespace meico
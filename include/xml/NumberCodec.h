@@ -0,0 +1,100 @@
+#pragma once
+
+#include "common/common.h"
+#include <string_view>
+#include <cstddef>
+
+namespace meico {
+namespace xml {
+
+/**
+ * Locale independent conversion between numbers and their attribute string representation,
+ * built on std::from_chars and std::to_chars. Parsing does not allocate and reports failure
+ * by return value instead of exceptions. Formatting writes the shortest string that parses
+ * back to exactly the same double, so values survive any number of read/write cycles.
+ */
+class NumberCodec {
+public:
+    /**
+     * The buffer size that is sufficient for every formatted number, including the terminating null character
+     */
+    static const size_t BUFFER_SIZE = 64;
+
+    /**
+     * Parse a double; leading whitespace and a leading '+' are skipped, parsing stops at the first character that does not belong to the number
+     * @param text the string
+     * @param value receives the parsed value, it is not changed if parsing fails
+     * @return true if a number was parsed
+     */
+    static bool tryParse(std::string_view text, double& value);
+
+    /**
+     * Parse an integer, same rules as for doubles; a fractional part is ignored
+     * @param text the string
+     * @param value receives the parsed value, it is not changed if parsing fails or the number is out of range
+     * @return true if a number was parsed
+     */
+    static bool tryParse(std::string_view text, int& value);
+    static bool tryParse(std::string_view text, long& value);
+
+    /**
+     * Parse a double
+     * @param text the string
+     * @param defaultValue the value to return if parsing fails
+     * @return the parsed value or defaultValue
+     */
+    static double parseDouble(std::string_view text, double defaultValue = 0.0);
+
+    /**
+     * Parse an integer
+     * @param text the string
+     * @param defaultValue the value to return if parsing fails
+     * @return the parsed value or defaultValue
+     */
+    static int parseInt(std::string_view text, int defaultValue = 0);
+    static long parseLong(std::string_view text, long defaultValue = 0);
+
+    /**
+     * Check if the whole string is a number
+     * @param text the string
+     * @return true if the string is a number without leading or trailing characters
+     */
+    static bool isNumber(std::string_view text);
+
+    /**
+     * Write the shortest round-trip representation of a double into a buffer; values of
+     * usual magnitude are written in fixed notation (e.g. "720", "0.25"), very small and
+     * very large values in scientific notation
+     * @param value the value
+     * @param buffer the buffer, at least BUFFER_SIZE characters
+     * @return the length of the string, the buffer is null-terminated
+     */
+    static size_t format(double value, char* buffer);
+
+    /**
+     * Write an integer into a buffer
+     * @param value the value
+     * @param buffer the buffer, at least BUFFER_SIZE characters
+     * @return the length of the string, the buffer is null-terminated
+     */
+    static size_t format(long value, char* buffer);
+
+    /**
+     * Format a double as string
+     * @param value the value
+     * @return the shortest round-trip representation
+     */
+    static std::string toString(double value);
+
+    /**
+     * Set the value of an attribute to the shortest round-trip representation of a double;
+     * this formats into a stack buffer and does not allocate
+     * @param attribute the attribute
+     * @param value the value
+     * @return true if successful
+     */
+    static bool setValue(Attribute attribute, double value);
+};
+
+} // namespace xml
+} // namespace meico
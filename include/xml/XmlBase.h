@@ -1,12 +1,19 @@
 #pragma once
 
 #include "common/common.h"
+#include "supplementary/IdIndex.h"
 #include <fstream>
 #include <filesystem>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
 
 namespace meico {
 namespace xml {
 
+class MappedFile;
+
 /**
  * This class is a primitive for all XML-based classes in meico.
  * Ported from Java XmlBase class.
@@ -15,8 +22,28 @@ namespace xml {
 class XmlBase {
 protected:
     std::string file;               // the data file path
+    std::shared_ptr<MappedFile> mappedFile; // the memory mapped input file that the document was parsed from in place, it must outlive data
     Document data;                  // the XML document representation
     bool isValid;                   // indicates whether the input file contained valid data
+    uint64_t revision = 0;          // incremented when the document is replaced or its structure is modified, see markModified()
+
+private:
+    // the elements that carry an xml:id, in document order, and the hash index over their ids; built on demand
+    struct IdEntry {
+        Element element;
+        std::string id;             // a copy, so the index never reads the strings of a document that was edited but not marked
+    };
+    mutable std::vector<IdEntry> idEntries;
+    mutable supplementary::IdIndex elementsById;
+    mutable uint64_t idRevision = UINT64_MAX;
+    mutable std::mutex idMutex;
+
+    /**
+     * Collect the elements that carry an xml:id and build the hash index over their ids
+     */
+    void buildIdIndex() const;
+
+protected:
 
 public:
     /**
@@ -63,7 +90,9 @@ public:
     virtual ~XmlBase() = default;
 
     /**
-     * Read from file
+     * Read from file; where the platform supports it, the file is memory mapped and parsed
+     * in place, so it is not copied into an intermediate buffer. The mapping is kept alive
+     * as long as the document refers to it.
      * @param filePath the file path
      * @param validate whether to validate
      * @param schema schema file path
@@ -86,6 +115,12 @@ public:
      */
     void readFromInputStream(std::istream& inputStream, bool validate = false, const std::string& schema = "");
 
+    /**
+     * Check if the document has been parsed in place from a memory mapped file
+     * @return true if the document refers to a memory mapped file
+     */
+    bool isMemoryMapped() const;
+
     /**
      * Check if the document is empty
      * @return true if empty
@@ -117,6 +152,30 @@ public:
      */
     void setDocument(const Document& document);
 
+    /**
+     * Get the revision of the document. Indices over the document compare it with the revision
+     * they were built at to detect that they have to be rebuilt.
+     * @return the revision
+     */
+    uint64_t getRevision() const;
+
+    /**
+     * Mark the document as modified, so that indices over it are rebuilt. The methods of this
+     * class and its subclasses do it themselves; call it after adding, removing or renaming
+     * elements or attributes through the document's nodes.
+     */
+    void markModified();
+
+    /**
+     * Find an element by its xml:id, e.g. an MSM note or an MPM map entry, in constant time.
+     * The index over all ids is built in one traversal on the first call and rebuilt when the
+     * revision has changed, so edits through the document's nodes have to be marked, see
+     * markModified(). If several elements have the same id, the first one in document order is found.
+     * @param id the xml:id without leading '#'
+     * @return the element or an empty element if there is none with this id
+     */
+    Element getElementById(std::string_view id) const;
+
     /**
      * Access the root element of the document
      * @return the root element
@@ -0,0 +1,276 @@
+#include "capi/meico.h"
+#include "msm/Msm.h"
+#include "msm/MsmOverlay.h"
+#include "msm/NoteTable.h"
+#include "mpm/Mpm.h"
+#include "mpm/elements/Performance.h"
+#include "mpm/elements/Global.h"
+#include "mpm/elements/Part.h"
+#include "mpm/elements/Dated.h"
+#include "mpm/elements/maps/GenericMap.h"
+#include "mpm/elements/metadata/Metadata.h"
+#include "xml/NumberCodec.h"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct meico_msm {
+    std::unique_ptr<meico::msm::Msm> msm;
+};
+
+struct meico_mpm {
+    std::unique_ptr<meico::mpm::Mpm> mpm;
+    std::vector<std::string> performanceNames;      // read once when the MPM is loaded, so concurrent calls only read them
+};
+
+struct meico_rendering {
+    // the note arrays, one entry per note
+    std::vector<double> onsets;
+    std::vector<double> durations;
+    std::vector<double> pitches;
+    std::vector<double> velocities;
+    std::vector<uint32_t> parts;
+
+    // the MSM parts
+    std::vector<std::string> partNames;
+    std::vector<int> partChannels;
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+void setError(const std::string& message) {
+    lastError = message;
+}
+
+/**
+ * Run a function of the interface; exceptions are caught and reported by the error message
+ * @param fallback the return value if the function fails
+ * @param function the function
+ * @return the result of the function or the fallback
+ */
+template<typename Result, typename Function>
+Result guard(Result fallback, Function function) {
+    try {
+        lastError.clear();
+        return function();
+    } catch (const std::exception& e) {
+        setError(e.what());
+    } catch (...) {
+        setError("Unknown error");
+    }
+    return fallback;
+}
+
+/**
+ * Create the handle of an MPM; its performances are materialized and their maps prepared now,
+ * so that renderings only read them and can run on several threads at once
+ */
+meico_mpm* createMpm(std::unique_ptr<meico::mpm::Mpm> mpm) {
+    auto handle = std::make_unique<meico_mpm>();
+    for (size_t i = 0; i < mpm->size(); ++i) {
+        handle->performanceNames.push_back(mpm->getPerformanceName(i));
+        meico::mpm::Performance* performance = mpm->getPerformance(i);
+        if (performance) {
+            performance->prepareForRendering();
+        }
+    }
+    handle->mpm = std::move(mpm);
+    return handle.release();
+}
+
+template<typename T>
+const T* getArray(const meico_rendering* rendering, const std::vector<T> meico_rendering::* array, size_t* length) {
+    if (length) {
+        *length = rendering ? (rendering->*array).size() : 0;
+    }
+    return (rendering && !(rendering->*array).empty()) ? (rendering->*array).data() : nullptr;
+}
+
+/**
+ * Render a performance into flat arrays; the notes of all parts are sorted by their milliseconds onset
+ */
+meico_rendering* render(const meico::mpm::Performance* performance, const meico_msm* msm) {
+    std::ostream discard(nullptr);              // the progress messages are not printed, the host has no console to read them
+    auto overlay = performance->performOverlay(*msm->msm, discard);
+    auto rendering = std::make_unique<meico_rendering>();
+
+    // the rows with a date of all parts, in part and document order
+    std::vector<std::pair<uint32_t, uint32_t>> notes;
+    for (size_t p = 0; p < overlay->getPartCount(); ++p) {
+        const meico::msm::NoteTable& table = overlay->getNoteTable(p);
+        for (size_t row = 0; row < table.size(); ++row) {
+            if (table.hasFlag(row, meico::msm::NoteTable::HAS_DATE)) {
+                notes.emplace_back(static_cast<uint32_t>(p), static_cast<uint32_t>(row));
+            }
+        }
+        meico::Element part = overlay->getPart(p);
+        rendering->partNames.emplace_back(part.attribute("name").value());
+        auto channelAttr = part.attribute("midi.channel");
+        rendering->partChannels.push_back(channelAttr ? meico::xml::NumberCodec::parseInt(channelAttr.value(), 0) : -1);
+    }
+    std::stable_sort(notes.begin(), notes.end(), [&overlay](const auto& a, const auto& b) {
+        return overlay->getNoteTable(a.first).getMillisecondsDate(a.second) < overlay->getNoteTable(b.first).getMillisecondsDate(b.second);
+    });
+
+    rendering->onsets.reserve(notes.size());
+    rendering->durations.reserve(notes.size());
+    rendering->pitches.reserve(notes.size());
+    rendering->velocities.reserve(notes.size());
+    rendering->parts.reserve(notes.size());
+    for (const auto& note : notes) {
+        const meico::msm::NoteTable& table = overlay->getNoteTable(note.first);
+        size_t row = note.second;
+        bool hasVelocity = table.hasFlag(row, meico::msm::NoteTable::HAS_VELOCITY) || table.hasFlag(row, meico::msm::NoteTable::VELOCITY_CHANGED);
+        rendering->onsets.push_back(table.getMillisecondsDate(row));
+        rendering->durations.push_back(table.getMillisecondsDuration(row));
+        rendering->pitches.push_back(table.getPitch(row));
+        rendering->velocities.push_back(hasVelocity ? table.getVelocity(row) : 100.0);    // the default of the MIDI export
+        rendering->parts.push_back(note.first);
+    }
+    return rendering.release();
+}
+
+} // namespace
+
+extern "C" {
+
+int meico_api_version(void) {
+    return MEICO_API_VERSION;
+}
+
+const char* meico_last_error(void) {
+    return lastError.c_str();
+}
+
+meico_msm* meico_msm_load(const char* xml, size_t length) {
+    return guard<meico_msm*>(nullptr, [&]() -> meico_msm* {
+        if (!xml) {
+            setError("No MSM code given");
+            return nullptr;
+        }
+        return new meico_msm{std::make_unique<meico::msm::Msm>(std::string(xml, length), true)};
+    });
+}
+
+meico_msm* meico_msm_load_file(const char* path) {
+    return guard<meico_msm*>(nullptr, [&]() -> meico_msm* {
+        if (!path) {
+            setError("No MSM file given");
+            return nullptr;
+        }
+        return new meico_msm{std::make_unique<meico::msm::Msm>(std::string(path))};
+    });
+}
+
+void meico_msm_free(meico_msm* msm) {
+    delete msm;
+}
+
+meico_mpm* meico_mpm_load(const char* xml, size_t length) {
+    return guard<meico_mpm*>(nullptr, [&]() -> meico_mpm* {
+        if (!xml) {
+            setError("No MPM code given");
+            return nullptr;
+        }
+        return createMpm(std::make_unique<meico::mpm::Mpm>(std::string(xml, length), true));
+    });
+}
+
+meico_mpm* meico_mpm_load_file(const char* path) {
+    return guard<meico_mpm*>(nullptr, [&]() -> meico_mpm* {
+        if (!path) {
+            setError("No MPM file given");
+            return nullptr;
+        }
+        return createMpm(std::make_unique<meico::mpm::Mpm>(std::string(path)));
+    });
+}
+
+void meico_mpm_free(meico_mpm* mpm) {
+    delete mpm;
+}
+
+size_t meico_mpm_performance_count(const meico_mpm* mpm) {
+    return mpm ? mpm->mpm->size() : 0;
+}
+
+const char* meico_mpm_performance_name(const meico_mpm* mpm, size_t index) {
+    return guard<const char*>(nullptr, [&]() -> const char* {
+        if (!mpm || (index >= mpm->performanceNames.size())) {
+            setError("No performance at index " + std::to_string(index));
+            return nullptr;
+        }
+        return mpm->performanceNames[index].c_str();
+    });
+}
+
+meico_rendering* meico_render(const meico_mpm* mpm, size_t performance, const meico_msm* msm) {
+    return guard<meico_rendering*>(nullptr, [&]() -> meico_rendering* {
+        const meico::mpm::Performance* selected = (mpm && (performance < mpm->mpm->size()))
+                                                  ? static_cast<const meico::mpm::Mpm&>(*mpm->mpm).getPerformance(performance) : nullptr;
+        if (!selected || !msm) {
+            setError(selected ? "No MSM given" : "No performance at index " + std::to_string(performance));
+            return nullptr;
+        }
+        return render(selected, msm);
+    });
+}
+
+meico_rendering* meico_render_by_name(const meico_mpm* mpm, const char* performance, const meico_msm* msm) {
+    return guard<meico_rendering*>(nullptr, [&]() -> meico_rendering* {
+        const meico::mpm::Performance* selected = (mpm && performance)
+                                                  ? static_cast<const meico::mpm::Mpm&>(*mpm->mpm).getPerformance(std::string(performance)) : nullptr;
+        if (!selected || !msm) {
+            setError(selected ? "No MSM given" : "No performance named \"" + std::string(performance ? performance : "") + "\"");
+            return nullptr;
+        }
+        return render(selected, msm);
+    });
+}
+
+void meico_rendering_free(meico_rendering* rendering) {
+    delete rendering;
+}
+
+size_t meico_rendering_note_count(const meico_rendering* rendering) {
+    return rendering ? rendering->onsets.size() : 0;
+}
+
+const double* meico_rendering_onsets(const meico_rendering* rendering, size_t* length) {
+    return getArray(rendering, &meico_rendering::onsets, length);
+}
+
+const double* meico_rendering_durations(const meico_rendering* rendering, size_t* length) {
+    return getArray(rendering, &meico_rendering::durations, length);
+}
+
+const double* meico_rendering_pitches(const meico_rendering* rendering, size_t* length) {
+    return getArray(rendering, &meico_rendering::pitches, length);
+}
+
+const double* meico_rendering_velocities(const meico_rendering* rendering, size_t* length) {
+    return getArray(rendering, &meico_rendering::velocities, length);
+}
+
+const uint32_t* meico_rendering_parts(const meico_rendering* rendering, size_t* length) {
+    return getArray(rendering, &meico_rendering::parts, length);
+}
+
+size_t meico_rendering_part_count(const meico_rendering* rendering) {
+    return rendering ? rendering->partNames.size() : 0;
+}
+
+const char* meico_rendering_part_name(const meico_rendering* rendering, size_t part) {
+    return (rendering && (part < rendering->partNames.size())) ? rendering->partNames[part].c_str() : nullptr;
+}
+
+int meico_rendering_part_channel(const meico_rendering* rendering, size_t part) {
+    return (rendering && (part < rendering->partChannels.size())) ? rendering->partChannels[part] : -1;
+}
+
+} // extern "C"
@@ -0,0 +1,54 @@
+#include "midi/InstrumentsDictionary.h"
+#include <cctype>
+
+namespace meico {
+namespace midi {
+
+const char* const InstrumentsDictionary::DEFAULT_NAMES[128] = {
+    "Acoustic Grand Piano", "Bright Acoustic Piano", "Electric Grand Piano", "Honkytonk Piano", "Electric Piano 1",
+    "Electric Piano 2", "Harpsichord", "Clavinet", "Celesta", "Glockenspiel", "Music Box", "Vibraphone", "Marimba",
+    "Xylophone", "Tubular Bells", "Dulcimer", "Drawbar Organ", "Percussive Organ", "Rock Organ", "Church Organ",
+    "Reed Organ", "Accordion", "Harmonica", "Tango Accordion", "Acoustic Nylon Guitar", "Acoustic Steel Guitar",
+    "Electric Jazz Guitar", "Electric Clean Guitar", "Electric Muted Guitar", "Overdriven Guitar", "Distorted Guitar",
+    "Harmonic Guitar", "Acoustic Bass", "Fingered Electric Bass", "Picked Electric Bass", "Fretless Bass",
+    "Slap Bass 1", "Slap Bass 2", "Synth Bass 1", "Synth Bass 2", "Violin", "Viola", "Cello", "Contrabass",
+    "Tremolo Strings", "Pizzicato Strings", "Orchestral Harp", "Timpani", "String Ensemble 1", "String Ensemble 2",
+    "Synth Strings 1", "Synth Strings 2", "Choir Aahs", "Voice Oohs", "Synth Choir", "Orchestra Hit", "Trumpet",
+    "Trombone", "Tuba", "Muted Trumpet", "French Horn", "Brass Section", "Synth Brass 1", "Synth Brass 2",
+    "Soprano Sax", "Alto Sax", "Tenor Sax", "Baritone Sax", "Oboe", "English Horn", "Bassoon", "Clarinet", "Piccolo",
+    "Flute", "Recorder", "Pan Flute", "Blown Bottle", "Shakuhachi", "Whistle", "Ocarina", "Lead 1 Square",
+    "Lead 2 Sawtooth", "Lead 3 Calliope", "Lead 4 Chiff", "Lead 5 Charang", "Lead 6 Voice", "Lead 7 Fifths",
+    "Lead 8 (Bass + Lead)", "Pad 1 New Age", "Pad 2 Warm", "Pad 3 Polysynth", "Pad 4 Choir", "Pad 5 Bowed",
+    "Pad 6 Metallic", "Pad 7 Halo", "Pad 8 Sweep", "FX 1 Rain", "FX 2 Soundtrack", "FX 3 Crystal", "FX 4 Atmosphere",
+    "FX 5 Brightness", "FX 6 Goblins", "FX 7 Echoes", "FX 8 Scifi", "Sitar", "Banjo", "Shamisen", "Koto", "Kalimba",
+    "Bagpipe", "Fiddle", "Shanai", "Tinkle Bell", "Agogo", "Steel Drums", "Woodblock", "Taiko Drum", "Melodic Tom",
+    "Synth Drum", "Reverse Cymbal", "Guitar Fret Noise", "Breath Noise", "Seashore", "Bird Tweet", "Telephone Ring",
+    "Helicopter", "Applause", "Gunshot"
+};
+
+int InstrumentsDictionary::getProgramChange(std::string_view name) {
+    for (int i = 0; i < 128; ++i) {
+        std::string_view candidate = DEFAULT_NAMES[i];
+        if (candidate.size() != name.size()) {
+            continue;
+        }
+        bool match = true;
+        for (size_t c = 0; match && (c < name.size()); ++c) {
+            match = std::tolower(static_cast<unsigned char>(name[c])) == std::tolower(static_cast<unsigned char>(candidate[c]));
+        }
+        if (match) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+std::string InstrumentsDictionary::getInstrumentName(int programChangeNumber) {
+    if ((programChangeNumber < 0) || (programChangeNumber > 127)) {
+        return "";
+    }
+    return DEFAULT_NAMES[programChangeNumber];
+}
+
+} // namespace midi
+} // namespace meico
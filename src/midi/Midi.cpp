@@ -0,0 +1,59 @@
+#include "midi/Midi.h"
+#include "midi/Midi2MsmConverter.h"
+#include "msm/Msm.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace meico {
+namespace midi {
+
+Midi::Midi(std::vector<uint8_t> data, const std::string& file) : data(std::move(data)), file(file) {
+}
+
+Midi::Midi(const std::string& filePath) : file(filePath) {
+    std::ifstream input(filePath, std::ios::binary);
+    if (!input) {
+        std::cerr << "Could not read MIDI file " << filePath << std::endl;
+        return;
+    }
+    data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+int Midi::getPPQ() const {
+    if ((data.size() < 14) || (data[0] != 'M') || (data[1] != 'T') || (data[2] != 'h') || (data[3] != 'd') || (data[12] & 0x80)) {
+        return 0;                               // no header or SMPTE timing
+    }
+    return (data[12] << 8) | data[13];
+}
+
+int Midi::getTrackCount() const {
+    if ((data.size() < 14) || (data[0] != 'M') || (data[1] != 'T') || (data[2] != 'h') || (data[3] != 'd')) {
+        return 0;
+    }
+    return (data[10] << 8) | data[11];
+}
+
+bool Midi::writeMidi() const {
+    if (file.empty()) {
+        return false;
+    }
+    return writeMidi(file);
+}
+
+bool Midi::writeMidi(const std::string& filename) const {
+    std::ofstream output(filename, std::ios::binary);
+    if (!output) {
+        std::cerr << "Could not write MIDI file " << filename << std::endl;
+        return false;
+    }
+    output.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(output);
+}
+
+std::unique_ptr<msm::Msm> Midi::exportMsm(bool useDefaultInstrumentNames, bool cleanup) const {
+    return Midi2MsmConverter::convert(*this, useDefaultInstrumentNames, cleanup);
+}
+
+} // namespace midi
+} // namespace meico
@@ -0,0 +1,347 @@
+#include "midi/Midi2MsmConverter.h"
+#include "midi/Midi.h"
+#include "midi/SmfReader.h"
+#include "midi/SmfWriter.h"
+#include "midi/InstrumentsDictionary.h"
+#include "msm/Msm.h"
+#include "supplementary/Timeline.h"
+#include "xml/NumberCodec.h"
+#include "xml/Helper.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace meico {
+namespace midi {
+
+namespace {
+
+void appendNumber(Element element, const char* name, double value) {
+    xml::NumberCodec::setValue(element.append_attribute(name), value);
+}
+
+Element getMap(Element dated, const char* name) {
+    Element map = dated.child(name);
+    return map ? map : dated.append_child(name);
+}
+
+/**
+ * Add a time signature, key signature or marker to the maps of a dated element
+ */
+void addMetaEvent(Element dated, const SmfReader::Event& event) {
+    switch (event.data1) {
+        case SmfWriter::META_TIME_SIGNATURE: {
+            if (event.dataLength < 2) {
+                return;
+            }
+            Element timeSignature = getMap(dated, "timeSignatureMap").append_child("timeSignature");
+            appendNumber(timeSignature, "date", static_cast<double>(event.tick));
+            appendNumber(timeSignature, "numerator", event.data[0]);
+            appendNumber(timeSignature, "denominator", static_cast<double>(1 << std::min<int>(event.data[1], 16)));
+            return;
+        }
+        case SmfWriter::META_KEY_SIGNATURE: {
+            if (event.dataLength < 1) {
+                return;
+            }
+            // the accidentals in the order of the circle of fifths
+            static const int SHARP_PITCHES[7] = {5, 0, 7, 2, 9, 4, 11};
+            static const int FLAT_PITCHES[7] = {11, 4, 9, 2, 7, 0, 5};
+            static const char* const SHARP_NAMES[7] = {"F", "C", "G", "D", "A", "E", "B"};
+            static const char* const FLAT_NAMES[7] = {"B", "E", "A", "D", "G", "C", "F"};
+            int accidentals = std::max(-7, std::min(7, static_cast<int>(static_cast<int8_t>(event.data[0]))));
+            Element keySignature = getMap(dated, "keySignatureMap").append_child("keySignature");
+            appendNumber(keySignature, "date", static_cast<double>(event.tick));
+            for (int i = 0; i < std::abs(accidentals); ++i) {
+                Element accidental = keySignature.append_child("accidental");
+                appendNumber(accidental, "midi.pitch", (accidentals > 0) ? SHARP_PITCHES[i] : FLAT_PITCHES[i]);
+                accidental.append_attribute("pitchname") = (accidentals > 0) ? SHARP_NAMES[i] : FLAT_NAMES[i];
+                appendNumber(accidental, "value", (accidentals > 0) ? 1.0 : -1.0);
+            }
+            return;
+        }
+        case SmfWriter::META_MARKER: {
+            Element marker = getMap(dated, "markerMap").append_child("marker");
+            appendNumber(marker, "date", static_cast<double>(event.tick));
+            std::string_view message = event.getText();
+            marker.append_attribute("message").set_value(message.data(), message.size());
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+/**
+ * The spelling of the black keys from a key signature on, see spellNotes()
+ */
+struct KeySpelling {
+    int64_t tick;
+    bool useSharps;                             // sharps for keys with sharps and without accidentals, flats for keys with flats
+};
+
+/**
+ * A note whose pitchname and accidentals are set when the key signatures of all relevant tracks are known
+ */
+struct UnspelledNote {
+    Attribute pitchname;
+    Attribute accidentals;
+    int64_t tick;
+    int pitch;
+};
+
+/**
+ * Set the pitch names and accidentals of notes by the key signature in force at each note, see Java
+ * Helper.midi2PnameAndAccid(); key signatures at the same tick keep the order in which they were collected
+ * @param keySpellings the key signatures, they get sorted by tick
+ * @param notes the notes to spell
+ */
+void spellNotes(std::vector<KeySpelling>& keySpellings, std::vector<UnspelledNote>& notes) {
+    static const char* const SHARP_NAMES[12] = {"C", "C", "D", "D", "E", "F", "F", "G", "G", "A", "A", "B"};
+    static const char* const FLAT_NAMES[12] = {"C", "D", "D", "E", "E", "F", "G", "G", "A", "A", "B", "B"};
+    static const bool BLACK_KEYS[12] = {false, true, false, true, false, false, true, false, true, false, true, false};
+    std::stable_sort(keySpellings.begin(), keySpellings.end(), [](const KeySpelling& a, const KeySpelling& b) { return a.tick < b.tick; });
+
+    size_t keyCursor = 0;                       // the notes of a track are in tick order, so the cursor only goes back at the next track
+    for (UnspelledNote& note : notes) {
+        int key = supplementary::timeline::seekBeforeAt(keySpellings, static_cast<double>(note.tick), keyCursor,
+                                                        [](const KeySpelling& spelling) { return static_cast<double>(spelling.tick); });
+        bool useSharps = (key < 0) || keySpellings[key].useSharps;
+        int pitchClass = note.pitch % 12;
+        note.pitchname.set_value(useSharps ? SHARP_NAMES[pitchClass] : FLAT_NAMES[pitchClass]);
+        xml::NumberCodec::setValue(note.accidentals, BLACK_KEYS[pitchClass] ? (useSharps ? 1.0 : -1.0) : 0.0);
+    }
+}
+
+/**
+ * Remove the maps without entries from a dated element
+ */
+void removeEmptyMaps(Element dated) {
+    for (Element map = dated.first_child(); map; ) {
+        Element next = map.next_sibling();
+        std::string_view name = map.name();
+        if ((name.size() > 3) && (name.compare(name.size() - 3, 3, "Map") == 0) && !map.first_child()) {
+            dated.remove_child(map);
+        }
+        map = next;
+    }
+}
+
+} // namespace
+
+std::unique_ptr<msm::Msm> Midi2MsmConverter::convert(const Midi& midi, bool useDefaultInstrumentNames, bool cleanup) {
+    SmfReader reader(midi.getData().data(), midi.size());
+    if (!reader.isValid()) {
+        std::cerr << "No valid MIDI data to convert." << std::endl;
+        return nullptr;
+    }
+    if (reader.getPPQ() == 0) {
+        std::cerr << "MIDI files with SMPTE timing cannot be converted to MSM." << std::endl;
+        return nullptr;
+    }
+
+    std::string title;
+    if (!midi.getFile().empty()) {
+        title = xml::Helper::getFilenameWithoutExtension(midi.getFile());
+        title = title.substr(title.find_last_of("/\\") + 1);
+    }
+    auto msm = msm::Msm::createMsm(title, "", reader.getPPQ());
+    Element root = msm->getRootElement();
+    Element globalDated = msm->getGlobal().child("dated");
+
+    // the open notes of a track, a stack per channel and pitch that is linked through the entries
+    struct OpenNote {
+        Attribute duration;
+        int64_t date;
+        int32_t below;                          // the index of the next open note on the stack or -1
+    };
+    std::vector<OpenNote> openNotes;
+    std::array<int32_t, 16 * 128> stackTops;
+    std::vector<SmfReader::Event> metaEvents;   // the time signatures, key signatures and markers of a track
+    int partNumber = 0;
+    size_t defectiveTracks = 0;
+    size_t unmatchedNoteOffs = 0;
+
+    // the black keys are spelled like the accidentals of the key signature in force at the note, the key signatures
+    // of all tracks apply to all tracks, except in format 2 files whose tracks are independent sequences; so the
+    // notes are spelled after the last track, or after each track of a format 2 file
+    std::vector<KeySpelling> keySpellings;
+    std::vector<UnspelledNote> unspelledNotes;
+
+    for (size_t t = 0; t < reader.getTrackCount(); ++t) {
+        SmfReader::Track track = reader.getTrack(t);
+        std::array<Element, 16> parts;          // the part of each channel of this track, created with its first channel message
+        std::array<Element, 16> scores;
+        std::array<int, 16> programs;           // the first program change of each channel
+        programs.fill(-1);
+        stackTops.fill(-1);
+        openNotes.clear();
+        metaEvents.clear();
+        std::string_view trackName;
+        std::string_view instrumentName;
+        int port = -1;
+        int partCount = 0;
+        std::string_view text;                  // a text event that may carry the id of the following note
+        int64_t textTick = -1;
+
+        auto getPart = [&](int channel) {
+            if (!parts[channel]) {
+                Element part = root.append_child("part");
+                part.append_attribute("name");
+                appendNumber(part, "number", partNumber++);
+                appendNumber(part, "midi.channel", channel);
+                part.append_attribute("midi.port");
+                part.append_child("header");
+                scores[channel] = part.append_child("dated").append_child("score");
+                parts[channel] = part;
+                ++partCount;
+            }
+            return parts[channel];
+        };
+
+        SmfReader::Event event;
+        while (track.next(event)) {
+            std::string_view noteId;
+            if (event.tick == textTick) {
+                noteId = text;
+            }
+            textTick = -1;
+
+            if (event.isMeta()) {
+                switch (event.data1) {
+                    case SmfWriter::META_TEXT_EVENT:
+                        text = event.getText();
+                        textTick = event.tick;
+                        break;
+                    case SmfWriter::META_TRACK_NAME:
+                        trackName = trackName.empty() ? event.getText() : trackName;
+                        break;
+                    case SmfWriter::META_INSTRUMENT_NAME:
+                        instrumentName = instrumentName.empty() ? event.getText() : instrumentName;
+                        break;
+                    case SmfWriter::META_MIDI_PORT:
+                        port = ((port < 0) && (event.dataLength > 0)) ? event.data[0] : port;
+                        break;
+                    case SmfWriter::META_KEY_SIGNATURE:
+                        if (event.dataLength > 0) {
+                            keySpellings.push_back({event.tick, static_cast<int8_t>(event.data[0]) >= 0});
+                        }
+                        metaEvents.push_back(event);
+                        break;
+                    case SmfWriter::META_TIME_SIGNATURE:
+                    case SmfWriter::META_MARKER:
+                        metaEvents.push_back(event);
+                        break;
+                    default:
+                        break;
+                }
+                continue;
+            }
+            if (!event.isChannelMessage()) {
+                continue;
+            }
+
+            int channel = event.getChannel();
+            int command = event.getCommand();
+            if ((command == SmfWriter::NOTE_ON) && (event.data2 > 0)) {
+                getPart(channel);
+                Element note = scores[channel].append_child("note");
+                if (!noteId.empty() && (noteId != "unknown")) {
+                    note.append_attribute("xml:id").set_value(noteId.data(), noteId.size());
+                }
+                appendNumber(note, "date", static_cast<double>(event.tick));
+                appendNumber(note, "midi.pitch", event.data1);
+                unspelledNotes.push_back({note.append_attribute("pitchname"), note.append_attribute("accidentals"), event.tick, event.data1});
+                Attribute duration = note.append_attribute("duration");
+                appendNumber(note, "velocity", event.data2);
+
+                int32_t& top = stackTops[(channel << 7) | event.data1];
+                openNotes.push_back({duration, event.tick, top});
+                top = static_cast<int32_t>(openNotes.size() - 1);
+            } else if ((command == SmfWriter::NOTE_ON) || (command == SmfWriter::NOTE_OFF)) {
+                int32_t& top = stackTops[(channel << 7) | event.data1];
+                if (top < 0) {
+                    ++unmatchedNoteOffs;
+                    continue;
+                }
+                OpenNote& open = openNotes[top];
+                xml::NumberCodec::setValue(open.duration, static_cast<double>(event.tick - open.date));
+                top = open.below;
+            } else if (command == SmfWriter::PROGRAM_CHANGE) {
+                Element programChange = getMap(getPart(channel).child("dated"), "programChangeMap").append_child("programChange");
+                appendNumber(programChange, "date", static_cast<double>(event.tick));
+                appendNumber(programChange, "value", event.data1);
+                programs[channel] = (programs[channel] < 0) ? event.data1 : programs[channel];
+            }
+        }
+        defectiveTracks += track.hasError() ? 1 : 0;
+
+        // notes that are still open end with the track
+        for (int32_t top : stackTops) {
+            for (int32_t i = top; i >= 0; i = openNotes[i].below) {
+                xml::NumberCodec::setValue(openNotes[i].duration, static_cast<double>(track.getTick() - openNotes[i].date));
+            }
+        }
+
+        std::string name(trackName.empty() ? instrumentName : trackName);
+        for (int channel = 0; channel < 16; ++channel) {
+            if (!parts[channel]) {
+                continue;
+            }
+            std::string partName = name;
+            if (partName.empty() && useDefaultInstrumentNames) {
+                partName = InstrumentsDictionary::getInstrumentName(std::max(programs[channel], 0));
+            }
+            parts[channel].attribute("name").set_value(partName.c_str());
+            xml::NumberCodec::setValue(parts[channel].attribute("midi.port"), std::max(port, 0));
+        }
+
+        // the meta events of a track with one part belong to that part, all others are global
+        Element dated = globalDated;
+        if ((reader.getFormat() == 1) && (partCount == 1)) {
+            for (const Element& part : parts) {
+                dated = part ? part.child("dated") : dated;
+            }
+        }
+        for (const SmfReader::Event& meta : metaEvents) {
+            addMetaEvent(dated, meta);
+        }
+
+        if (reader.getFormat() == 2) {
+            spellNotes(keySpellings, unspelledNotes);
+            keySpellings.clear();
+            unspelledNotes.clear();
+        }
+    }
+    spellNotes(keySpellings, unspelledNotes);
+
+    if (defectiveTracks > 0) {
+        std::cerr << "MIDI data is truncated or malformed in " << defectiveTracks << " tracks, the rest of these tracks is skipped." << std::endl;
+    }
+    if (unmatchedNoteOffs > 0) {
+        std::cerr << "Ignoring " << unmatchedNoteOffs << " note offs without a note on." << std::endl;
+    }
+
+    if (cleanup) {
+        removeEmptyMaps(globalDated);
+        for (Element part = root.child("part"); part; ) {
+            Element next = part.next_sibling("part");
+            if (!part.child("dated").child("score").first_child()) {
+                root.remove_child(part);
+            } else {
+                removeEmptyMaps(part.child("dated"));
+            }
+            part = next;
+        }
+    }
+
+    msm->markModified();
+    msm->setFile(midi.getFile().empty() ? std::string() : xml::Helper::getFilenameWithoutExtension(midi.getFile()) + ".msm");
+    return msm;
+}
+
+} // namespace midi
+} // namespace meico
@@ -0,0 +1,142 @@
+#include "midi/SmfReader.h"
+#include <cstring>
+
+namespace meico {
+namespace midi {
+
+const uint8_t SmfReader::META_EVENT;
+const uint8_t SmfReader::SYSTEM_EXCLUSIVE;
+const uint8_t SmfReader::SYSTEM_EXCLUSIVE_CONTINUATION;
+
+namespace {
+
+uint32_t readBigEndian(const uint8_t* in, size_t bytes) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+} // namespace
+
+SmfReader::SmfReader(const uint8_t* data, size_t size) {
+    if (!data || (size < 14) || (std::memcmp(data, "MThd", 4) != 0)) {
+        return;
+    }
+    uint32_t headerLength = readBigEndian(data + 4, 4);
+    if ((headerLength < 6) || (headerLength > size - 8)) {
+        return;
+    }
+    format = static_cast<int>(readBigEndian(data + 8, 2));
+    uint32_t trackCount = readBigEndian(data + 10, 2);
+    division = static_cast<int>(readBigEndian(data + 12, 2));
+
+    // locate the track chunks, chunks of other types are skipped
+    tracks.reserve(trackCount);
+    const uint8_t* chunk = data + 8 + headerLength;
+    const uint8_t* end = data + size;
+    while ((end - chunk) >= 8) {
+        uint32_t length = readBigEndian(chunk + 4, 4);
+        const uint8_t* chunkData = chunk + 8;
+        const uint8_t* chunkEnd = (length > static_cast<size_t>(end - chunkData)) ? end : chunkData + length;   // a truncated last chunk is read as far as it goes
+        if (std::memcmp(chunk, "MTrk", 4) == 0) {
+            tracks.emplace_back(chunkData, chunkEnd);
+        }
+        chunk = chunkEnd;
+    }
+}
+
+bool SmfReader::Track::readVariableLength(uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (position >= end) {
+            return false;
+        }
+        uint8_t byte = *position++;
+        value = (value << 7) | (byte & 0x7F);
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;                               // more than 4 bytes
+}
+
+bool SmfReader::Track::next(Event& event) {
+    if (position >= end) {
+        return false;
+    }
+
+    uint32_t delta;
+    if (!readVariableLength(delta) || (position >= end)) {
+        error = true;
+        position = end;
+        return false;
+    }
+    tick += delta;
+    event.tick = tick;
+    event.data = nullptr;
+    event.dataLength = 0;
+    event.data2 = 0;
+
+    uint8_t status = *position;
+    if (status & 0x80) {
+        ++position;
+    } else if (runningStatus) {
+        status = runningStatus;                 // running status, the byte is the first data byte
+    } else {
+        error = true;
+        position = end;
+        return false;
+    }
+    event.status = status;
+
+    // meta and system exclusive events carry a payload of variable length
+    if (status >= SYSTEM_EXCLUSIVE) {
+        runningStatus = 0;
+        uint32_t length;
+        if (status == META_EVENT) {
+            if (position >= end) {
+                error = true;
+                return false;
+            }
+            event.data1 = *position++;
+        } else if ((status != SYSTEM_EXCLUSIVE) && (status != SYSTEM_EXCLUSIVE_CONTINUATION)) {
+            error = true;                       // system common and real time messages are not allowed in files
+            position = end;
+            return false;
+        } else {
+            event.data1 = 0;
+        }
+        if (!readVariableLength(length) || (length > static_cast<size_t>(end - position))) {
+            error = true;
+            position = end;
+            return false;
+        }
+        event.data = position;
+        event.dataLength = length;
+        position += length;
+        if ((status == META_EVENT) && (event.data1 == 0x2F)) {
+            position = end;                     // end of track, anything behind it is ignored
+        }
+        return true;
+    }
+
+    // channel messages; program change and channel pressure have one data byte
+    runningStatus = status;
+    uint8_t command = status & 0xF0;
+    size_t dataBytes = ((command == 0xC0) || (command == 0xD0)) ? 1 : 2;
+    if (static_cast<size_t>(end - position) < dataBytes) {
+        error = true;
+        position = end;
+        return false;
+    }
+    event.data1 = *position++ & 0x7F;
+    if (dataBytes == 2) {
+        event.data2 = *position++ & 0x7F;
+    }
+    return true;
+}
+
+} // namespace midi
+} // namespace meico
@@ -0,0 +1,263 @@
+#include "midi/SmfWriter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace meico {
+namespace midi {
+
+const uint8_t SmfWriter::META_TEXT_EVENT;
+const uint8_t SmfWriter::META_TRACK_NAME;
+const uint8_t SmfWriter::META_INSTRUMENT_NAME;
+const uint8_t SmfWriter::META_MARKER;
+const uint8_t SmfWriter::META_MIDI_CHANNEL_PREFIX;
+const uint8_t SmfWriter::META_MIDI_PORT;
+const uint8_t SmfWriter::META_END_OF_TRACK;
+const uint8_t SmfWriter::META_SET_TEMPO;
+const uint8_t SmfWriter::META_TIME_SIGNATURE;
+const uint8_t SmfWriter::META_KEY_SIGNATURE;
+const uint8_t SmfWriter::NOTE_OFF;
+const uint8_t SmfWriter::NOTE_ON;
+const uint8_t SmfWriter::CONTROL_CHANGE;
+const uint8_t SmfWriter::PROGRAM_CHANGE;
+const uint8_t SmfWriter::META_EVENT;
+
+namespace {
+
+uint8_t toDataByte(int value) {
+    return static_cast<uint8_t>(std::clamp(value, 0, 127));
+}
+
+/**
+ * The number of bytes of a variable-length quantity
+ */
+size_t variableLengthSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+uint8_t* writeVariableLength(uint8_t* out, uint32_t value) {
+    size_t size = variableLengthSize(value);
+    for (size_t i = size; i > 0; --i) {
+        uint8_t byte = static_cast<uint8_t>((value >> (7 * (i - 1))) & 0x7F);
+        *out++ = (i > 1) ? (byte | 0x80) : byte;
+    }
+    return out;
+}
+
+uint8_t* writeBigEndian(uint8_t* out, uint32_t value, size_t bytes) {
+    for (size_t i = bytes; i > 0; --i) {
+        *out++ = static_cast<uint8_t>(value >> (8 * (i - 1)));
+    }
+    return out;
+}
+
+} // namespace
+
+SmfWriter::SmfWriter(int ppq) : ppq(ppq) {
+}
+
+void SmfWriter::reserve(size_t eventCount, size_t payloadBytes) {
+    events.reserve(eventCount);
+    pool.reserve(payloadBytes);
+}
+
+uint32_t SmfWriter::addTrack() {
+    return trackCount++;
+}
+
+void SmfWriter::addNoteOn(int64_t tick, int channel, int pitch, int velocity) {
+    addChannelMessage(tick, NOTE_ON, channel, pitch, velocity);
+}
+
+void SmfWriter::addNoteOff(int64_t tick, int channel, int pitch, int velocity) {
+    addChannelMessage(tick, NOTE_OFF, channel, pitch, velocity);
+}
+
+void SmfWriter::addControlChange(int64_t tick, int channel, int controller, int value) {
+    addChannelMessage(tick, CONTROL_CHANGE, channel, controller, value);
+}
+
+void SmfWriter::addProgramChange(int64_t tick, int channel, int program) {
+    addChannelMessage(tick, PROGRAM_CHANGE, channel, program, 0);
+}
+
+void SmfWriter::addTempo(int64_t tick, double bpm, double beatLength) {
+    // microseconds per quarter note, 3 bytes big endian
+    uint32_t mpq = static_cast<uint32_t>(std::clamp(60000000.0 / (bpm * beatLength * 4.0), 1.0, 16777215.0));
+    uint8_t data[3] = {static_cast<uint8_t>(mpq >> 16), static_cast<uint8_t>(mpq >> 8), static_cast<uint8_t>(mpq)};
+    addMeta(tick, META_SET_TEMPO, data, 3);
+}
+
+void SmfWriter::addTimeSignature(int64_t tick, int numerator, int denominator) {
+    uint8_t exponent = 0;                       // the denominator is written as a power of 2
+    while ((exponent < 7) && ((1 << exponent) < denominator)) {
+        ++exponent;
+    }
+    // 24 MIDI clocks per metronome click and 8 thirty-second notes per quarter, like in the Java EventMaker
+    uint8_t data[4] = {static_cast<uint8_t>(std::clamp(numerator, 1, 255)), exponent, 24, 8};
+    addMeta(tick, META_TIME_SIGNATURE, data, 4);
+}
+
+void SmfWriter::addKeySignature(int64_t tick, int accidentals) {
+    uint8_t data[2] = {static_cast<uint8_t>(static_cast<int8_t>(std::clamp(accidentals, -7, 7))), 0};
+    addMeta(tick, META_KEY_SIGNATURE, data, 2);
+}
+
+void SmfWriter::addText(int64_t tick, uint8_t type, std::string_view text) {
+    addMeta(tick, type, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+void SmfWriter::addMidiPort(int64_t tick, int port) {
+    uint8_t data = toDataByte(port);
+    addMeta(tick, META_MIDI_PORT, &data, 1);
+}
+
+void SmfWriter::addChannelPrefix(int64_t tick, int channel) {
+    uint8_t data = static_cast<uint8_t>(std::clamp(channel, 0, 15));
+    addMeta(tick, META_MIDI_CHANNEL_PREFIX, &data, 1);
+}
+
+void SmfWriter::addChannelMessage(int64_t tick, uint8_t status, int channel, int data1, int data2) {
+    if (trackCount == 0) {
+        addTrack();
+    }
+    Event event;
+    event.tick = std::max<int64_t>(tick, 0);
+    event.track = trackCount - 1;
+    event.sequence = static_cast<uint32_t>(events.size());
+    event.dataOffset = 0;
+    event.dataLength = 0;
+    event.status = static_cast<uint8_t>(status | std::clamp(channel, 0, 15));
+    event.data1 = toDataByte(data1);
+    event.data2 = toDataByte(data2);
+    sorted = sorted && (events.empty() || (events.back().track < event.track) || (events.back().tick <= event.tick));
+    events.push_back(event);
+}
+
+void SmfWriter::addMeta(int64_t tick, uint8_t type, const uint8_t* data, size_t length) {
+    if (trackCount == 0) {
+        addTrack();
+    }
+    Event event;
+    event.tick = std::max<int64_t>(tick, 0);
+    event.track = trackCount - 1;
+    event.sequence = static_cast<uint32_t>(events.size());
+    event.dataOffset = static_cast<uint32_t>(pool.size());
+    event.dataLength = static_cast<uint32_t>(length);
+    event.status = META_EVENT;
+    event.data1 = type;
+    event.data2 = 0;
+    sorted = sorted && (events.empty() || (events.back().track < event.track) || (events.back().tick <= event.tick));
+    pool.insert(pool.end(), data, data + length);
+    events.push_back(event);
+}
+
+void SmfWriter::sort() {
+    if (sorted) {
+        return;
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        if (a.track != b.track) return a.track < b.track;
+        if (a.tick != b.tick) return a.tick < b.tick;
+        return a.sequence < b.sequence;
+    });
+    sorted = true;
+}
+
+size_t SmfWriter::getSize() {
+    sort();
+    return encode(nullptr);
+}
+
+size_t SmfWriter::write(uint8_t* buffer, size_t capacity) {
+    size_t size = getSize();
+    if (!buffer || (capacity < size)) {
+        return 0;
+    }
+    return encode(buffer);
+}
+
+std::vector<uint8_t> SmfWriter::toBytes() {
+    std::vector<uint8_t> bytes(getSize());
+    encode(bytes.data());
+    return bytes;
+}
+
+size_t SmfWriter::encode(uint8_t* out) const {
+    uint32_t tracks = std::max<uint32_t>(trackCount, 1);
+    size_t size = 14;
+
+    // header chunk: format 1, the number of tracks and the ticks per quarter
+    if (out) {
+        out = std::copy_n("MThd", 4, out);
+        out = writeBigEndian(out, 6, 4);
+        out = writeBigEndian(out, 1, 2);
+        out = writeBigEndian(out, tracks, 2);
+        out = writeBigEndian(out, static_cast<uint32_t>(std::clamp(ppq, 1, 0x7FFF)), 2);
+    }
+
+    size_t e = 0;
+    for (uint32_t track = 0; track < tracks; ++track) {
+        uint8_t* lengthField = out ? out + 4 : nullptr;
+        if (out) {
+            out = std::copy_n("MTrk", 4, out) + 4;
+        }
+
+        size_t length = 0;
+        int64_t previousTick = 0;
+        uint8_t runningStatus = 0;
+        for (; (e < events.size()) && (events[e].track == track); ++e) {
+            const Event& event = events[e];
+            uint32_t delta = static_cast<uint32_t>(std::min<int64_t>(event.tick - previousTick, 0x0FFFFFFF));
+            previousTick = event.tick;
+            length += variableLengthSize(delta);
+            if (out) {
+                out = writeVariableLength(out, delta);
+            }
+
+            if (event.status == META_EVENT) {
+                runningStatus = 0;              // meta events cancel the running status
+                length += 2 + variableLengthSize(event.dataLength) + event.dataLength;
+                if (out) {
+                    *out++ = META_EVENT;
+                    *out++ = event.data1;
+                    out = writeVariableLength(out, event.dataLength);
+                    out = std::copy_n(pool.data() + event.dataOffset, event.dataLength, out);
+                }
+                continue;
+            }
+
+            bool twoDataBytes = (event.status & 0xF0) != PROGRAM_CHANGE;
+            length += (event.status != runningStatus ? 1 : 0) + (twoDataBytes ? 2 : 1);
+            if (out) {
+                if (event.status != runningStatus) {
+                    *out++ = event.status;
+                }
+                *out++ = event.data1;
+                if (twoDataBytes) {
+                    *out++ = event.data2;
+                }
+            }
+            runningStatus = event.status;
+        }
+
+        // end of track at the last event
+        length += 4;
+        if (out) {
+            *out++ = 0x00;
+            *out++ = META_EVENT;
+            *out++ = META_END_OF_TRACK;
+            *out++ = 0x00;
+            writeBigEndian(lengthField, static_cast<uint32_t>(length), 4);
+        }
+        size += 8 + length;
+    }
+    return size;
+}
+
+} // namespace midi
+} // namespace meico
@@ -69,21 +69,50 @@ size_t Mpm::size() const {
 }
 
 Performance* Mpm::getPerformance(size_t index) {
-    if (index < performances.size()) {
-        return performances[index].get();
-    }
-    return nullptr;
+    return materializePerformance(index);
 }
 
 const Performance* Mpm::getPerformance(size_t index) const {
-    if (index < performances.size()) {
-        return performances[index].get();
+    return materializePerformance(index);
+}
+
+Performance* Mpm::getPerformance(const std::string& name) {
+    long index = findPerformance(name);
+    return (index < 0) ? nullptr : materializePerformance(static_cast<size_t>(index));
+}
+
+const Performance* Mpm::getPerformance(const std::string& name) const {
+    long index = findPerformance(name);
+    return (index < 0) ? nullptr : materializePerformance(static_cast<size_t>(index));
+}
+
+std::string Mpm::getPerformanceName(size_t index) const {
+    std::lock_guard<std::mutex> lock(materializeMutex);
+    if (index >= performances.size()) {
+        return "";
     }
-    return nullptr;
+    const PerformanceEntry& entry = performances[index];
+    return entry.performance ? entry.performance->getName() : entry.name;
+}
+
+std::string Mpm::getPerformanceId(size_t index) const {
+    return (index < performances.size()) ? performances[index].id : "";
+}
+
+bool Mpm::isPerformanceMaterialized(size_t index) const {
+    std::lock_guard<std::mutex> lock(materializeMutex);
+    return (index < performances.size()) && performances[index].performance;
 }
 
 void Mpm::addPerformance(std::unique_ptr<Performance> performance) {
-    performances.push_back(std::move(performance));
+    if (!performance) {
+        return;
+    }
+    PerformanceEntry entry;
+    entry.name = performance->getName();
+    entry.performance = std::move(performance);
+    performanceIndex.emplace(entry.name, performances.size());     // keeps the first performance of this name
+    performances.push_back(std::move(entry));
 }
 
 Metadata* Mpm::getMetadata() {
@@ -109,11 +138,8 @@ void Mpm::init() {
 }
 
 void Mpm::parseData() {
-    // Basic parsing implementation
-    // In a full implementation, this would parse performances and metadata
-    // from the XML document
-    
     performances.clear();
+    performanceIndex.clear();
     metadata.reset();
     
     Element root = getRootElement();
@@ -121,13 +147,47 @@ void Mpm::parseData() {
         return;
     }
     
-    // Parse performances (simplified)
-    for (auto child : root.children()) {
-        if (std::string(child.name()) == "performance") {
-            // Would create Performance objects here
-            // For now, just placeholder
+    // index the performances, they are materialized on first access
+    for (auto child : root.children("performance")) {
+        PerformanceEntry entry;
+        entry.name = child.attribute("name").value();
+        entry.id = child.attribute("xml:id").value();
+        entry.xml = child;
+        performanceIndex.emplace(entry.name, performances.size());
+        performances.push_back(std::move(entry));
+    }
+}
+
+Performance* Mpm::materializePerformance(size_t index) const {
+    std::lock_guard<std::mutex> lock(materializeMutex);
+    if (index >= performances.size()) {
+        return nullptr;
+    }
+    PerformanceEntry& entry = performances[index];
+    if (!entry.performance) {
+        entry.performance = std::make_unique<Performance>(entry.xml);
+    }
+    return entry.performance.get();
+}
+
+long Mpm::findPerformance(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(materializeMutex);
+    auto candidate = performanceIndex.find(name);
+    if (candidate != performanceIndex.end()) {
+        const PerformanceEntry& entry = performances[candidate->second];
+        if (!entry.performance || (entry.performance->getName() == name)) {
+            return static_cast<long>(candidate->second);
+        }
+    }
+
+    // a materialized performance may have been renamed since it was indexed
+    for (size_t i = 0; i < performances.size(); ++i) {
+        const PerformanceEntry& entry = performances[i];
+        if ((entry.performance ? entry.performance->getName() : entry.name) == name) {
+            return static_cast<long>(i);
         }
     }
+    return -1;
 }
 
 } // namespace mpm
@@ -0,0 +1,257 @@
+#include "mpm/PerformanceCache.h"
+#include "mpm/Mpm.h"
+#include "mpm/elements/Performance.h"
+#include "mpm/elements/Global.h"
+#include "mpm/elements/Part.h"
+#include "mpm/elements/Dated.h"
+#include "mpm/elements/metadata/Metadata.h"
+#include "mpm/elements/maps/GenericMap.h"
+#include "mpm/elements/maps/MapFactory.h"
+#include "supplementary/BinaryStream.h"
+#include "xml/MappedFile.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace meico {
+namespace mpm {
+
+const char PerformanceCache::MAGIC[8] = {'M', 'E', 'I', 'C', 'O', 'P', 'C', '\0'};
+const uint32_t PerformanceCache::VERSION = 1;
+
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;     // reads differently on a host with another byte order
+
+uint64_t PerformanceCache::hash(const char* data, size_t length, uint64_t seed) {
+    uint64_t value = seed;
+    for (size_t i = 0; i < length; ++i) {
+        value ^= static_cast<unsigned char>(data[i]);
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+bool PerformanceCache::hashFile(const std::string& filePath, uint64_t& hashValue) {
+    std::shared_ptr<xml::MappedFile> mapping = xml::MappedFile::open(filePath);
+    if (mapping) {
+        hashValue = hash(mapping->data(), mapping->size());
+        return true;
+    }
+
+    std::ifstream input(filePath, std::ios::binary);
+    if (!input) {
+        return false;
+    }
+    hashValue = hash(nullptr, 0);
+    char buffer[65536];
+    while (input.read(buffer, sizeof(buffer)) || (input.gcount() > 0)) {
+        hashValue = hash(buffer, static_cast<size_t>(input.gcount()), hashValue);
+    }
+    return true;
+}
+
+std::string PerformanceCache::serialize(const Performance& performance, uint64_t sourceHash) {
+    // the maps compute their control points and timing now, so the cache holds them
+    std::vector<const Dated*> containers;
+    if (performance.getGlobal()) {
+        containers.push_back(performance.getGlobal()->getDated());
+    }
+    for (size_t i = 0; i < performance.getPartCount(); ++i) {
+        containers.push_back(performance.getPart(i)->getDated());
+    }
+    for (const Dated* dated : containers) {
+        if (dated) {
+            for (const auto& map : dated->getAllMaps()) {
+                if (map) {
+                    map->prepareForRendering(performance.getPPQ());
+                }
+            }
+        }
+    }
+
+    supplementary::BinaryWriter writer;
+    for (char c : MAGIC) {
+        writer.writeUInt8(static_cast<uint8_t>(c));
+    }
+    writer.writeUInt32(VERSION);
+    writer.writeUInt32(BYTE_ORDER_MARK);
+    writer.writeUInt64(sourceHash);
+    size_t payloadLength = writer.reserveUInt64();
+    size_t payloadStart = writer.size();
+
+    writer.writeString(performance.getName());
+    writer.writeInt32(performance.getPPQ());
+    writeDated(writer, performance.getGlobal() ? performance.getGlobal()->getDated() : nullptr);
+    writer.writeUInt32(static_cast<uint32_t>(performance.getPartCount()));
+    for (size_t i = 0; i < performance.getPartCount(); ++i) {
+        const Part* part = performance.getPart(i);
+        writer.writeString(part->getName());
+        writer.writeInt32(part->getNumber());
+        writer.writeInt32(part->getMidiChannel());
+        writer.writeInt32(part->getMidiPort());
+        writeDated(writer, part->getDated());
+    }
+
+    writer.patchUInt64(payloadLength, writer.size() - payloadStart);
+    return writer.getBuffer();
+}
+
+std::unique_ptr<Performance> PerformanceCache::deserialize(const char* data, size_t length, uint64_t sourceHash) {
+    supplementary::BinaryReader reader(data, length);
+    const char* magic = reader.readBytes(sizeof(MAGIC));
+    uint32_t version = reader.readUInt32();
+    uint32_t byteOrderMark = reader.readUInt32();
+    uint64_t cachedSourceHash = reader.readUInt64();
+    uint64_t payloadLength = reader.readUInt64();
+    if (!magic || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), magic) || (version != VERSION) || (byteOrderMark != BYTE_ORDER_MARK)
+            || (cachedSourceHash != sourceHash) || (payloadLength != reader.remaining())) {
+        return nullptr;                             // no cache, another version or byte order, stale or truncated
+    }
+
+    auto performance = Performance::createPerformance(std::string(reader.readString()));
+    performance->setPPQ(reader.readInt32());
+    if (!readDated(reader, *performance->getGlobal()->getDated())) {
+        return nullptr;
+    }
+
+    uint32_t partCount = reader.readUInt32();
+    for (uint32_t i = 0; (i < partCount) && reader.good(); ++i) {
+        std::string name(reader.readString());
+        int number = reader.readInt32();
+        int midiChannel = reader.readInt32();
+        int midiPort = reader.readInt32();
+        auto part = Part::createPart(name, number, midiChannel, midiPort);
+        if (!readDated(reader, *part->getDated())) {
+            return nullptr;
+        }
+        performance->addPart(std::move(part));
+    }
+
+    if (!reader.good() || (reader.remaining() != 0)) {
+        return nullptr;
+    }
+    return performance;
+}
+
+bool PerformanceCache::writeToFile(const Performance& performance, const std::string& cachePath, uint64_t sourceHash) {
+    return writeData(serialize(performance, sourceHash), cachePath);
+}
+
+bool PerformanceCache::writeData(const std::string& data, const std::string& cachePath) {
+    // write to a temporary file and rename it, so that concurrent readers never see a partial cache
+    std::random_device random;
+    std::string temporaryPath = cachePath + ".tmp" + std::to_string(random());
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!output) {
+            std::cerr << "Failed to write performance cache " << cachePath << std::endl;
+            output.close();
+            std::filesystem::remove(temporaryPath);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, cachePath, error);
+    if (error) {
+        std::cerr << "Failed to write performance cache " << cachePath << ": " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Performance> PerformanceCache::readFromFile(const std::string& cachePath, uint64_t sourceHash) {
+    std::shared_ptr<xml::MappedFile> mapping = xml::MappedFile::open(cachePath);
+    if (mapping) {
+        return deserialize(mapping->data(), mapping->size(), sourceHash);
+    }
+
+    std::ifstream input(cachePath, std::ios::binary);      // no memory mapping on this platform
+    if (!input) {
+        return nullptr;
+    }
+    std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    return deserialize(data.data(), data.size(), sourceHash);
+}
+
+std::unique_ptr<Performance> PerformanceCache::load(const std::string& mpmPath, const std::string& cachePath, size_t performanceIndex) {
+    uint64_t sourceHash;
+    if (!hashFile(mpmPath, sourceHash)) {
+        std::cerr << "Cannot read MPM file " << mpmPath << std::endl;
+        return nullptr;
+    }
+    uint64_t index = performanceIndex;              // the caches of the performances of one file must differ
+    sourceHash = hash(reinterpret_cast<const char*>(&index), sizeof(index), sourceHash);
+
+    auto performance = readFromFile(cachePath, sourceHash);
+    if (performance) {
+        return performance;
+    }
+
+    std::cout << "Compiling performance " << performanceIndex << " of " << mpmPath << " into cache " << cachePath << std::endl;
+    Mpm mpm(mpmPath);
+    const Performance* source = mpm.getPerformance(performanceIndex);
+    if (!source) {
+        std::cerr << "MPM file " << mpmPath << " has no performance " << performanceIndex << std::endl;
+        return nullptr;
+    }
+
+    // the cached form is returned, so it does not make a difference whether the cache was up to date
+    std::string data = serialize(*source, sourceHash);
+    writeData(data, cachePath);
+    return deserialize(data.data(), data.size(), sourceHash);
+}
+
+void PerformanceCache::writeDated(supplementary::BinaryWriter& writer, const Dated* dated) {
+    uint32_t mapCount = 0;
+    if (dated) {
+        for (const auto& map : dated->getAllMaps()) {
+            mapCount += map ? 1 : 0;
+        }
+    }
+    writer.writeUInt32(mapCount);
+    if (!dated) {
+        return;
+    }
+
+    for (const auto& map : dated->getAllMaps()) {
+        if (!map) {
+            continue;
+        }
+        writer.writeString(map->getMapType());
+        size_t recordLength = writer.reserveUInt64();
+        size_t recordStart = writer.size();
+        map->writeToCache(writer);
+        writer.patchUInt64(recordLength, writer.size() - recordStart);
+    }
+}
+
+bool PerformanceCache::readDated(supplementary::BinaryReader& reader, Dated& dated) {
+    uint32_t mapCount = reader.readUInt32();
+    for (uint32_t i = 0; (i < mapCount) && reader.good(); ++i) {
+        std::string_view mapType = reader.readString();
+        uint64_t recordLength = reader.readUInt64();
+        const char* record = (recordLength <= reader.remaining()) ? reader.readBytes(static_cast<size_t>(recordLength)) : nullptr;
+        if (!record) {
+            return false;
+        }
+
+        auto map = MapFactory::createMap(mapType);
+        if (!map) {                                 // a map type that this version does not know, skip it
+            std::cerr << "Skipping unknown map type " << mapType << " in performance cache" << std::endl;
+            continue;
+        }
+        supplementary::BinaryReader recordReader(record, static_cast<size_t>(recordLength));
+        if (!map->readFromCache(recordReader) || (recordReader.remaining() != 0)) {
+            return false;
+        }
+        dated.addMap(std::move(map));
+    }
+    return reader.good();
+}
+
+} // namespace mpm
+} // namespace meico
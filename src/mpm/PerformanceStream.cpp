@@ -0,0 +1,176 @@
+#include "mpm/PerformanceStream.h"
+#include "mpm/elements/Performance.h"
+#include "mpm/elements/maps/TempoMap.h"
+#include "mpm/elements/maps/DynamicsMap.h"
+#include "msm/Msm.h"
+#include "xml/NumberCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+
+namespace meico {
+namespace mpm {
+
+const int PerformanceStream::CC_CHANNEL_VOLUME;
+
+namespace {
+
+uint8_t toDataByte(double value) {
+    return static_cast<uint8_t>(std::clamp(static_cast<int>(std::lround(static_cast<float>(value))), 0, 127));
+}
+
+/**
+ * The order of the queue: by time, simultaneous events by type and then in the order they were rendered
+ */
+const auto later = [](const auto& a, const auto& b) {
+    if (a.event.milliseconds != b.event.milliseconds) {
+        return a.event.milliseconds > b.event.milliseconds;
+    }
+    if (a.event.type != b.event.type) {
+        return a.event.type > b.event.type;
+    }
+    return a.sequence > b.sequence;
+};
+
+} // namespace
+
+PerformanceStream::PerformanceStream(const Performance& performance, const msm::Msm& msm)
+    : performance(performance), windowLength(4.0 * performance.getPPQ()) {
+    Element root = msm.getRootElement();
+    if (!root) {
+        return;
+    }
+
+    int msmPPQ = msm.getPPQ();
+    uint16_t partIndex = 0;
+    for (auto msmPart : root.children("part")) {
+        uint16_t index = partIndex++;
+        auto channelAttr = msmPart.attribute("midi.channel");
+        if (!channelAttr) {
+            continue;
+        }
+
+        PartStream part;
+        const Part* perfPart = nullptr;
+        part.maps = performance.collectMaps(msmPart, perfPart);
+        part.score = performance.compileNoteTable(msmPart, msmPPQ);
+        for (size_t row : part.score.getRowsInDateOrder()) {
+            if (part.score.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+                part.rows.push_back(row);
+            }
+        }
+        part.frontier = -std::numeric_limits<double>::infinity();
+        part.part = index;
+        part.channel = static_cast<uint8_t>(std::clamp(xml::NumberCodec::parseInt(channelAttr.value(), 0), 0, 15));
+        part.port = static_cast<uint16_t>(std::max(xml::NumberCodec::parseInt(msmPart.attribute("midi.port").value(), 0), 0));
+
+        // sub-note dynamics are thinned out from the end and start at the default channel volume like in Msm::renderMidi()
+        const DynamicsMap* dynamicsMap = nullptr;
+        Performance::findTimingMaps(part.maps, part.tempoMap, dynamicsMap);
+        msm::NoteTable channelVolume;
+        channelVolume.setPPQ(performance.getPPQ());
+        if (dynamicsMap) {
+            dynamicsMap->renderSubNoteDynamics(channelVolume, part.tempoMap);
+        }
+        std::vector<Event> controlChanges;
+        int64_t previousDate = std::numeric_limits<int64_t>::max();
+        const auto& events = channelVolume.getChannelVolume();
+        for (auto event = events.rbegin(); event != events.rend(); ++event) {
+            int64_t date = std::llround(event->millisecondsDate);
+            if (!event->mandatory && (date >= (previousDate - msm::Msm::CONTROL_CHANGE_DENSITY))) {
+                continue;
+            }
+            previousDate = date;
+            controlChanges.push_back({static_cast<double>(date), EventType::CONTROL_CHANGE, part.channel, CC_CHANNEL_VOLUME,
+                                      toDataByte(event->value), part.part, part.port});
+        }
+        if ((previousDate > 0) && !controlChanges.empty()) {
+            controlChanges.push_back({0.0, EventType::CONTROL_CHANGE, part.channel, CC_CHANNEL_VOLUME, 100, part.part, part.port});
+        }
+        for (auto event = controlChanges.rbegin(); event != controlChanges.rend(); ++event) {
+            push(*event);
+        }
+
+        parts.push_back(std::move(part));
+    }
+}
+
+void PerformanceStream::setWindowLength(double ticks) {
+    if (ticks > 0.0) {
+        windowLength = ticks;
+    }
+}
+
+size_t PerformanceStream::next(double milliseconds, std::vector<Event>& events) {
+    double until = position + std::max(milliseconds, 0.0);
+
+    // each part is rendered ahead until its last window starts behind the end of the slice
+    for (PartStream& part : parts) {
+        while ((part.nextRow < part.rows.size()) && (part.frontier < until)) {
+            renderWindow(part);
+        }
+    }
+
+    size_t count = 0;
+    while (!queue.empty() && (queue.front().event.milliseconds < until)) {
+        std::pop_heap(queue.begin(), queue.end(), later);
+        events.push_back(queue.back().event);
+        queue.pop_back();
+        ++count;
+    }
+    position = until;
+    return count;
+}
+
+bool PerformanceStream::isFinished() const {
+    if (!queue.empty()) {
+        return false;
+    }
+    for (const PartStream& part : parts) {
+        if (part.nextRow < part.rows.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PerformanceStream::renderWindow(PartStream& part) {
+    // the window ends between two dates, so simultaneous notes are rendered together
+    const msm::NoteTable& score = part.score;
+    double end = score.getDate(part.rows[part.nextRow]) + windowLength;
+    window.clear();
+    window.setPPQ(score.getPPQ());
+    const uint32_t hasFlags = msm::NoteTable::HAS_DATE | msm::NoteTable::HAS_DURATION | msm::NoteTable::HAS_PITCH | msm::NoteTable::HAS_VELOCITY;
+    for (; (part.nextRow < part.rows.size()) && (score.getDate(part.rows[part.nextRow]) < end); ++part.nextRow) {
+        size_t row = part.rows[part.nextRow];
+        window.addNote(score.getDate(row), score.getDuration(row), score.getPitch(row), score.getVelocity(row), score.getId(row),
+                       score.getFlags(row) & hasFlags);
+    }
+
+    std::ostream discard(nullptr);              // the progress messages of the maps are not printed while streaming
+    performance.applyMapsToNoteTable(window, part.maps, discard);
+    TempoMap::renderTempoToNoteTable(window, part.tempoMap);
+    ++renderedWindows;
+
+    part.frontier = std::numeric_limits<double>::infinity();
+    for (size_t row = 0; row < window.size(); ++row) {
+        double date = window.getMillisecondsDate(row);
+        part.frontier = std::min(part.frontier, date);
+        uint8_t pitch = toDataByte(window.getPitch(row));
+        uint8_t velocity = 100;
+        if (window.hasFlag(row, msm::NoteTable::HAS_VELOCITY) || window.hasFlag(row, msm::NoteTable::VELOCITY_CHANGED)) {
+            velocity = toDataByte(window.getVelocity(row));
+        }
+        push({date, EventType::NOTE_ON, part.channel, pitch, velocity, part.part, part.port});
+        push({date + window.getMillisecondsDuration(row), EventType::NOTE_OFF, part.channel, pitch, 0, part.part, part.port});
+    }
+}
+
+void PerformanceStream::push(const Event& event) {
+    queue.push_back({event, sequence++});
+    std::push_heap(queue.begin(), queue.end(), later);
+}
+
+} // namespace mpm
+} // namespace meico
@@ -1,5 +1,8 @@
 #include "mpm/elements/Dated.h"
 #include "mpm/elements/maps/GenericMap.h"
+#include "mpm/elements/maps/MapFactory.h"
+#include <iostream>
+#include <string_view>
 
 namespace meico {
 namespace mpm {
@@ -7,6 +10,12 @@ namespace mpm {
 Dated::Dated() {
 }
 
+std::unique_ptr<Dated> Dated::createDated(const Element& xml) {
+    auto dated = std::make_unique<Dated>();
+    dated->parseData(xml);
+    return dated;
+}
+
 void Dated::addMap(std::unique_ptr<GenericMap> map) {
     maps.push_back(std::move(map));
 }
@@ -39,7 +48,19 @@ size_t Dated::getMapCount() const {
 
 void Dated::parseData(const Element& xmlElement) {
     setXml(xmlElement);
-    // TODO: Parse maps from XML
+
+    // one pass over the children, each map element is looked up by its local name and parsed
+    for (auto child : xmlElement.children()) {
+        if (child.type() != pugi::node_element) {
+            continue;
+        }
+        auto map = MapFactory::createMap(child);
+        if (map) {
+            maps.push_back(std::move(map));
+        } else if (std::string_view(child.name()).find("Map") != std::string_view::npos) {
+            std::cerr << "Skipping unknown map type " << child.name() << std::endl;
+        }
+    }
 }
 
 } // namespace mpm
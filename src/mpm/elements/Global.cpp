@@ -8,6 +8,12 @@ namespace mpm {
 Global::Global() : dated(std::make_unique<Dated>()) {
 }
 
+std::unique_ptr<Global> Global::createGlobal(const Element& xml) {
+    auto global = std::make_unique<Global>();
+    global->parseData(xml);
+    return global;
+}
+
 Dated* Global::getDated() {
     return dated.get();
 }
@@ -22,7 +28,11 @@ void Global::setDated(std::unique_ptr<Dated> newDated) {
 
 void Global::parseData(const Element& xmlElement) {
     setXml(xmlElement);
-    // TODO: Parse global data from XML
+
+    Element datedElement = xmlElement.child("dated");
+    if (datedElement) {
+        dated = Dated::createDated(datedElement);
+    }
 }
 
 } // namespace mpm
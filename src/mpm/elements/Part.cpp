@@ -1,6 +1,9 @@
 #include "mpm/elements/Part.h"
 #include "mpm/elements/Dated.h"
 #include "mpm/elements/maps/GenericMap.h"
+#include "xml/NumberCodec.h"
+#include <iostream>
+#include <stdexcept>
 
 namespace meico {
 namespace mpm {
@@ -14,6 +17,17 @@ std::unique_ptr<Part> Part::createPart(const std::string& partName, int partNumb
     return std::make_unique<Part>(partName, partNumber, channel, port);
 }
 
+std::unique_ptr<Part> Part::createPart(const Element& xml) {
+    auto part = std::make_unique<Part>("", 0, 0, 0);
+    try {
+        part->parseData(xml);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to create Part from XML: " << e.what() << std::endl;
+        return nullptr;
+    }
+    return part;
+}
+
 const std::string& Part::getName() const {
     return name;
 }
@@ -43,8 +57,27 @@ void Part::setDated(std::unique_ptr<Dated> newDated) {
 }
 
 void Part::parseData(const Element& xmlElement) {
+    // each part requires a number, a midi.channel and a midi.port, the name may be empty
+    auto numberAttr = xmlElement.attribute("number");
+    if (!numberAttr || !xml::NumberCodec::tryParse(numberAttr.value(), number)) {
+        throw std::runtime_error("Cannot generate Part object. Attribute number is missing or empty.");
+    }
+    auto midiChannelAttr = xmlElement.attribute("midi.channel");
+    if (!midiChannelAttr || !xml::NumberCodec::tryParse(midiChannelAttr.value(), midiChannel)) {
+        throw std::runtime_error("Cannot generate Part object. Attribute midi.channel is missing or empty.");
+    }
+    auto midiPortAttr = xmlElement.attribute("midi.port");
+    if (!midiPortAttr || !xml::NumberCodec::tryParse(midiPortAttr.value(), midiPort)) {
+        throw std::runtime_error("Cannot generate Part object. Attribute midi.port is missing or empty.");
+    }
+    name = xmlElement.attribute("name").value();
+
     setXml(xmlElement);
-    // TODO: Parse part data from XML
+
+    Element datedElement = xmlElement.child("dated");
+    if (datedElement) {
+        dated = Dated::createDated(datedElement);
+    }
 }
 
 } // namespace mpm
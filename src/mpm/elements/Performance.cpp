@@ -3,20 +3,32 @@
 #include "mpm/elements/Part.h"
 #include "mpm/elements/Dated.h"
 #include "mpm/elements/maps/GenericMap.h"
+#include "mpm/elements/maps/TempoMap.h"
+#include "mpm/elements/maps/DynamicsMap.h"
+#include "mpm/elements/maps/OrnamentationMap.h"
+#include "mpm/Mpm.h"
+#include "mpm/PerformanceStream.h"
+#include "supplementary/ThreadPool.h"
 #include "msm/Msm.h"
+#include "msm/NoteTable.h"
+#include "msm/MsmStreamWriter.h"
+#include "msm/MsmOverlay.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
 #include <iostream>
+#include <sstream>
+#include <set>
 
 namespace meico {
 namespace mpm {
 
 Performance::Performance(const std::string& performanceName)
-    : name(performanceName), pulsesPerQuarter(720), global(std::make_unique<Global>()) {
+    : name(performanceName), pulsesPerQuarter(720), global(std::make_unique<Global>()), mapApplication(MapApplication::FUSED) {
     init();
 }
 
 Performance::Performance(const Element& xml)
-    : pulsesPerQuarter(720), global(std::make_unique<Global>()) {
+    : pulsesPerQuarter(720), global(std::make_unique<Global>()), mapApplication(MapApplication::FUSED) {
     parseData(xml);
 }
 
@@ -70,6 +82,41 @@ void Performance::addPart(std::unique_ptr<Part> part) {
     parts.push_back(std::move(part));
 }
 
+Performance::MapApplication Performance::getMapApplication() const {
+    return mapApplication;
+}
+
+void Performance::setMapApplication(MapApplication mode) {
+    mapApplication = mode;
+}
+
+std::shared_ptr<supplementary::ThreadPool> Performance::getThreadPool() const {
+    return threadPool;
+}
+
+void Performance::setThreadPool(std::shared_ptr<supplementary::ThreadPool> threadPool) {
+    this->threadPool = std::move(threadPool);
+}
+
+void Performance::prepareForRendering() {
+    std::vector<Dated*> containers;
+    if (global) {
+        containers.push_back(global->getDated());
+    }
+    for (const auto& part : parts) {
+        containers.push_back(part->getDated());
+    }
+    for (Dated* dated : containers) {
+        if (dated) {
+            for (const auto& map : dated->getAllMaps()) {
+                if (map) {
+                    map->prepareForRendering(pulsesPerQuarter);
+                }
+            }
+        }
+    }
+}
+
 std::unique_ptr<msm::Msm> Performance::perform(const msm::Msm& msm) const {
     std::cout << "\nRendering performance \"" << name << "\" into \"" << msm.getTitle() << "\"." << std::endl;
     
@@ -80,54 +127,208 @@ std::unique_ptr<msm::Msm> Performance::perform(const msm::Msm& msm) const {
     }
     
     // Set output filename to avoid overwriting original
-    std::string originalFile = resultMsm->getFile();
-    if (!originalFile.empty()) {
-        std::string newFile = xml::Helper::getFilenameWithoutExtension(originalFile) + "_" + name + ".msm";
-        resultMsm->setFile(newFile);
-    }
+    resultMsm->setFile(getResultFile(resultMsm->getFile()));
     
     // Convert PPQ if necessary
     resultMsm->convertPPQ(pulsesPerQuarter);
     
     std::cout << "Processing performance data." << std::endl;
     
-    // Apply global maps to all parts
     if (global && global->getDated()) {
-        const auto& globalMaps = global->getDated()->getAllMaps();
-        std::cout << "Applying " << globalMaps.size() << " global maps." << std::endl;
+        std::cout << "Applying " << global->getDated()->getAllMaps().size() << " global maps." << std::endl;
+    }
+    
+    // Compile each MSM part once, render the global and the part-specific maps against it and write the result back once
+    Element root = resultMsm->getRootElement();
+    if (root) {
+        std::vector<Element> msmParts;
+        for (auto part : root.children("part")) {
+            msmParts.push_back(part);
+        }
         
-        // Find all parts in the MSM
-        Element root = resultMsm->getRootElement();
-        if (root) {
-            for (auto part : root.children("part")) {
-                applyMapsToMsmPart(part, globalMaps);
-            }
+        // Writing into the document allocates from it, this is done on one thread
+        std::vector<msm::NoteTable> tables = renderParts(msmParts, pulsesPerQuarter, std::cout);
+        for (auto& table : tables) {
+            table.writeBack(*resultMsm);
         }
     }
     
-    // Apply part-specific maps
-    Element root = resultMsm->getRootElement();
+    std::cout << "Performance rendering completed." << std::endl;
+    return resultMsm;
+}
+
+bool Performance::perform(const msm::Msm& msm, msm::MsmStreamWriter& writer) const {
+    std::cout << "\nRendering performance \"" << name << "\" into \"" << msm.getTitle() << "\"." << std::endl;
+    std::cout << "Processing performance data." << std::endl;
+    if (global && global->getDated()) {
+        std::cout << "Applying " << global->getDated()->getAllMaps().size() << " global maps." << std::endl;
+    }
+    
+    // The PPQ is converted while writing instead of on a copy of the input; each part is compiled,
+    // rendered and written before the next one is read
+    int msmPPQ = msm.getPPQ();
+    msm::NoteTable notes;
+    writer.writeMsm(msm, pulsesPerQuarter, [&](size_t, const Element& part) -> const msm::NoteTable* {
+        notes = compileNoteTable(part, msmPPQ);
+        const Part* perfPart = nullptr;
+        std::vector<GenericMap*> maps = collectMaps(part, perfPart);
+        renderNoteTable(notes, maps, perfPart, std::cout);
+        return &notes;
+    });
+    
+    std::cout << "Performance rendering completed." << std::endl;
+    return writer.finish();
+}
+
+std::unique_ptr<msm::MsmOverlay> Performance::performOverlay(const msm::Msm& msm) const {
+    return performOverlay(msm, std::cout);
+}
+
+std::unique_ptr<msm::MsmOverlay> Performance::performOverlay(const msm::Msm& msm, std::ostream& log) const {
+    log << "\nRendering performance \"" << name << "\" into \"" << msm.getTitle() << "\"." << std::endl;
+    log << "Processing performance data." << std::endl;
+    if (global && global->getDated()) {
+        log << "Applying " << global->getDated()->getAllMaps().size() << " global maps." << std::endl;
+    }
+    
+    // The notes are compiled from the input and rendered, the input itself is neither copied nor modified
+    std::vector<Element> msmParts;
+    Element root = msm.getRootElement();
     if (root) {
         for (auto part : root.children("part")) {
-            // Find matching performance part by name or number
-            auto partNameAttr = part.attribute("name");
-            if (partNameAttr) {
-                std::string partName = partNameAttr.value();
-                
-                for (const auto& perfPart : parts) {
-                    if (perfPart->getName() == partName) {
-                        const auto& partMaps = perfPart->getDated()->getAllMaps();
-                        std::cout << "Applying " << partMaps.size() << " maps to part: " << partName << std::endl;
-                        applyMapsToMsmPart(part, partMaps);
-                        break;
-                    }
+            msmParts.push_back(part);
+        }
+    }
+    std::vector<msm::NoteTable> tables = renderParts(msmParts, msm.getPPQ(), log);
+    
+    auto overlay = std::make_unique<msm::MsmOverlay>(msm, pulsesPerQuarter, std::move(msmParts), std::move(tables));
+    overlay->setFile(getResultFile(msm.getFile()));
+    
+    log << "Performance rendering completed." << std::endl;
+    return overlay;
+}
+
+std::unique_ptr<PerformanceStream> Performance::performStream(const msm::Msm& msm) const {
+    return std::make_unique<PerformanceStream>(*this, msm);
+}
+
+std::vector<msm::NoteTable> Performance::renderParts(const std::vector<Element>& msmParts, int msmPPQ, std::ostream& log) const {
+    std::vector<std::vector<GenericMap*>> partMaps;
+    std::vector<const Part*> perfParts;
+    for (const Element& part : msmParts) {
+        const Part* perfPart = nullptr;
+        partMaps.push_back(collectMaps(part, perfPart));
+        perfParts.push_back(perfPart);
+    }
+    
+    // Parts can be rendered concurrently, the maps are prepared beforehand so that rendering does not modify them
+    bool concurrent = threadPool && (threadPool->size() > 1) && (msmParts.size() > 1);
+    if (concurrent) {
+        std::set<GenericMap*> prepared;
+        for (const auto& maps : partMaps) {
+            for (GenericMap* map : maps) {
+                if (map && prepared.insert(map).second) {
+                    map->prepareForRendering(pulsesPerQuarter);
                 }
             }
         }
     }
     
-    std::cout << "Performance rendering completed." << std::endl;
-    return resultMsm;
+    // The log of a part goes to the log directly, or is buffered and printed in part order when rendering concurrently
+    std::vector<msm::NoteTable> tables(msmParts.size());
+    std::vector<std::ostringstream> logs(concurrent ? msmParts.size() : 0);
+    auto renderPart = [&](size_t i) {
+        std::ostream& partLog = concurrent ? static_cast<std::ostream&>(logs[i]) : log;
+        tables[i] = compileNoteTable(msmParts[i], msmPPQ);
+        renderNoteTable(tables[i], partMaps[i], perfParts[i], partLog);
+    };
+    
+    if (concurrent) {
+        threadPool->parallelFor(msmParts.size(), renderPart);
+        for (const auto& partLog : logs) {
+            log << partLog.str();
+        }
+    } else {
+        for (size_t i = 0; i < msmParts.size(); ++i) {
+            renderPart(i);
+        }
+    }
+    return tables;
+}
+
+msm::NoteTable Performance::compileNoteTable(const Element& msmPart, int msmPPQ) const {
+    msm::NoteTable notes(msmPart);
+    notes.setPPQ(msmPPQ);                       // the timing of the table is that of the MSM, whichever attribute it is read from
+    if (msmPPQ != pulsesPerQuarter) {
+        notes.convertPPQ(pulsesPerQuarter);
+    }
+    return notes;
+}
+
+std::string Performance::getResultFile(const std::string& msmFile) const {
+    if (msmFile.empty()) {
+        return msmFile;
+    }
+    return xml::Helper::getFilenameWithoutExtension(msmFile) + "_" + name + ".msm";
+}
+
+std::vector<GenericMap*> Performance::collectMaps(const Element& msmPart, const Part*& perfPart) const {
+    // Global maps apply to all parts
+    std::vector<GenericMap*> maps;
+    if (global && global->getDated()) {
+        for (const auto& map : global->getDated()->getAllMaps()) {
+            maps.push_back(map.get());
+        }
+    }
+    
+    // Find matching performance part by name
+    perfPart = nullptr;
+    auto partNameAttr = msmPart.attribute("name");
+    if (partNameAttr) {
+        std::string partName = partNameAttr.value();
+        for (const auto& p : parts) {
+            if (p->getName() == partName) {
+                perfPart = p.get();
+                for (const auto& map : perfPart->getDated()->getAllMaps()) {
+                    maps.push_back(map.get());
+                }
+                break;
+            }
+        }
+    }
+    
+    return maps;
+}
+
+void Performance::renderNoteTable(msm::NoteTable& notes, const std::vector<GenericMap*>& maps, const Part* perfPart, std::ostream& log) const {
+    if (perfPart) {
+        log << "Applying " << perfPart->getDated()->getAllMaps().size() << " maps to part: " << perfPart->getName() << std::endl;
+    }
+    
+    applyMapsToNoteTable(notes, maps, log);
+    
+    // Compute the milliseconds dates; the part's tempoMap takes precedence over the global one
+    const TempoMap* tempoMap = nullptr;
+    const DynamicsMap* dynamicsMap = nullptr;
+    findTimingMaps(maps, tempoMap, dynamicsMap);
+    TempoMap::renderTempoToNoteTable(notes, tempoMap);
+
+    // The channel volume events of sub-note dynamics, they are timed by the same tempoMap
+    if (dynamicsMap) {
+        dynamicsMap->renderSubNoteDynamics(notes, tempoMap);
+    }
+}
+
+void Performance::findTimingMaps(const std::vector<GenericMap*>& maps, const TempoMap*& tempoMap, const DynamicsMap*& dynamicsMap) {
+    tempoMap = nullptr;
+    dynamicsMap = nullptr;
+    for (const GenericMap* map : maps) {
+        if (map && (map->getMapType() == Mpm::TEMPO_MAP)) {
+            tempoMap = static_cast<const TempoMap*>(map);
+        } else if (map && (map->getMapType() == Mpm::DYNAMICS_MAP)) {
+            dynamicsMap = static_cast<const DynamicsMap*>(map);
+        }
+    }
 }
 
 void Performance::parseData(const Element& xmlElement) {
@@ -142,10 +343,20 @@ void Performance::parseData(const Element& xmlElement) {
     // Parse PPQ
     auto ppqAttr = xmlElement.attribute("pulsesPerQuarter");
     if (ppqAttr) {
-        pulsesPerQuarter = xml::Helper::parseInt(ppqAttr.value(), 720);
+        pulsesPerQuarter = xml::NumberCodec::parseInt(ppqAttr.value(), 720);
     }
     
-    // TODO: Parse global and parts from XML
+    // Parse the global environment and the parts, parts that lack required attributes are left out
+    Element globalElement = xmlElement.child("global");
+    if (globalElement) {
+        global = Global::createGlobal(globalElement);
+    }
+    for (auto partElement : xmlElement.children("part")) {
+        auto part = Part::createPart(partElement);
+        if (part) {
+            parts.push_back(std::move(part));
+        }
+    }
 }
 
 void Performance::init() {
@@ -153,12 +364,72 @@ void Performance::init() {
     // Global is already created in constructor
 }
 
-void Performance::applyMapsToMsmPart(Element msmPart, const std::vector<std::unique_ptr<GenericMap>>& maps) const {
-    for (const auto& map : maps) {
-        if (map) {
-            bool modified = map->applyToMsmPart(msmPart);
-            if (modified) {
-                std::cout << "  Applied " << map->getMapType() << " map" << std::endl;
+void Performance::applyMapsToNoteTable(msm::NoteTable& notes, const std::vector<GenericMap*>& maps, std::ostream& log) const {
+    std::vector<bool> modified(maps.size(), false);
+    
+    if (mapApplication == MapApplication::SEQUENTIAL) {
+        for (size_t i = 0; i < maps.size(); ++i) {
+            if (maps[i]) {
+                modified[i] = applyMap(*maps[i], notes, log);
+            }
+        }
+    } else {
+        // Consecutive sweepable maps are fused into one sweep; a map that cannot be swept ends the run
+        // and is applied on its own, so the order in which the maps take effect is the same as above
+        std::vector<GenericMap*> run;
+        std::vector<bool> runModified;
+        size_t runStart = 0;
+        for (size_t i = 0; i <= maps.size(); ++i) {
+            GenericMap* map = (i < maps.size()) ? maps[i] : nullptr;
+            if (map && map->supportsNoteSweep()) {
+                if (run.empty()) {
+                    runStart = i;
+                }
+                run.push_back(map);
+                continue;
+            }
+            
+            if (!run.empty()) {
+                sweepMaps(notes, run, runModified);
+                for (size_t k = 0; k < run.size(); ++k) {
+                    modified[runStart + k] = runModified[k];
+                }
+                run.clear();
+            }
+            
+            if (map) {
+                modified[i] = applyMap(*map, notes, log);
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < maps.size(); ++i) {
+        if (modified[i]) {
+            log << "  Applied " << maps[i]->getMapType() << " map" << std::endl;
+        }
+    }
+}
+
+bool Performance::applyMap(GenericMap& map, msm::NoteTable& notes, std::ostream& log) {
+    if (map.getMapType() != Mpm::ORNAMENTATION_MAP) {
+        return map.applyToNoteTable(notes);
+    }
+    OrnamentationMap::Report report;
+    bool modified = static_cast<OrnamentationMap&>(map).applyToNoteTable(notes, report);
+    if (report.ornaments > 0) {
+        log << "  Applied " << report.ornaments << " ornaments to " << report.notes << " notes in " << report.chords << " chords" << std::endl;
+    }
+    return modified;
+}
+
+void Performance::sweepMaps(msm::NoteTable& notes, const std::vector<GenericMap*>& maps, std::vector<bool>& modified) {
+    modified.assign(maps.size(), false);
+    std::vector<size_t> cursors(maps.size(), 0);
+    
+    for (size_t row : notes.getRowsInDateOrder()) {
+        for (size_t k = 0; k < maps.size(); ++k) {
+            if (maps[k]->applyToNote(notes, row, cursors[k])) {
+                modified[k] = true;
             }
         }
     }
@@ -1,7 +1,11 @@
 #include "mpm/elements/maps/ArticulationMap.h"
+#include "msm/NoteTable.h"
+#include "supplementary/Timeline.h"
 #include "mpm/elements/maps/data/ArticulationData.h"
 #include "mpm/Mpm.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <map>
 
@@ -15,6 +19,12 @@ std::unique_ptr<ArticulationMap> ArticulationMap::createArticulationMap() {
     return std::make_unique<ArticulationMap>();
 }
 
+std::unique_ptr<ArticulationMap> ArticulationMap::createArticulationMap(const Element& xml) {
+    auto map = std::make_unique<ArticulationMap>();
+    map->parseData(xml);
+    return map;
+}
+
 int ArticulationMap::addArticulation(double date, const std::string& articulationDefName, 
                                    const std::string& noteid, const std::string& id) {
     ArticulationData data;
@@ -23,13 +33,7 @@ int ArticulationMap::addArticulation(double date, const std::string& articulatio
     data.noteid = noteid;
     data.xmlId = id;
     
-    articulationData.push_back(data);
-    
-    // Keep data sorted by date for efficient lookup
-    std::sort(articulationData.begin(), articulationData.end(), 
-              [](const auto& a, const auto& b) { return a.date < b.date; });
-    
-    return static_cast<int>(articulationData.size() - 1);
+    return insertArticulationData(data);
 }
 
 int ArticulationMap::addArticulation(double date, 
@@ -64,23 +68,16 @@ int ArticulationMap::addArticulation(double date,
     data.noteid = noteid;
     data.xmlId = id;
     
-    articulationData.push_back(data);
-    
-    // Keep data sorted by date for efficient lookup
-    std::sort(articulationData.begin(), articulationData.end(), 
-              [](const auto& a, const auto& b) { return a.date < b.date; });
-    
-    return static_cast<int>(articulationData.size() - 1);
+    return insertArticulationData(data);
 }
 
 int ArticulationMap::addArticulation(const ArticulationData& data) {
-    articulationData.push_back(data);
-    
-    // Keep data sorted by date for efficient lookup
-    std::sort(articulationData.begin(), articulationData.end(), 
-              [](const auto& a, const auto& b) { return a.date < b.date; });
-    
-    return static_cast<int>(articulationData.size() - 1);
+    return insertArticulationData(data);
+}
+
+void ArticulationMap::addArticulation(std::vector<ArticulationData> batch) {
+    supplementary::timeline::mergeBatch(articulationData, std::move(batch), [](const ArticulationData& d) { return d.date; });
+    noteIdIndexValid = false;
 }
 
 int ArticulationMap::addStyleSwitch(double date, const std::string& styleName, 
@@ -91,13 +88,7 @@ int ArticulationMap::addStyleSwitch(double date, const std::string& styleName,
     data.defaultArticulation = defaultArticulation;
     data.xmlId = id;
     
-    articulationData.push_back(data);
-    
-    // Keep data sorted by date for efficient lookup
-    std::sort(articulationData.begin(), articulationData.end(), 
-              [](const auto& a, const auto& b) { return a.date < b.date; });
-    
-    return static_cast<int>(articulationData.size() - 1);
+    return insertArticulationData(data);
 }
 
 std::shared_ptr<ArticulationData> ArticulationMap::getArticulationDataOf(int index) {
@@ -112,17 +103,17 @@ std::shared_ptr<ArticulationData> ArticulationMap::getArticulationDataOf(int ind
 std::vector<ArticulationData> ArticulationMap::getArticulationDataAt(double date) {
     std::vector<ArticulationData> ads;
     
-    // Find all articulations exactly at this date
-    for (int i = static_cast<int>(articulationData.size()) - 1; i >= 0; --i) {
-        if (std::abs(articulationData[i].date - date) < 0.001) { // Allow small floating point tolerance
-            if (!articulationData[i].articulationDefName.empty() ||
-                articulationData[i].absoluteVelocity ||
-                articulationData[i].relativeVelocity != 1.0 ||
-                articulationData[i].absoluteVelocityChange != 0.0) {
-                ads.insert(ads.begin(), articulationData[i]); // Add at front since we're going backwards
+    // Find all articulations exactly at this date (allow small floating point tolerance)
+    auto range = supplementary::timeline::rangeOf(articulationData, date - DATE_TOLERANCE, date + DATE_TOLERANCE, [](const ArticulationData& d) { return d.date; });
+    for (size_t i = range.first; i < range.second; ++i) {
+        const ArticulationData& ad = articulationData[i];
+        if (std::abs(ad.date - date) < DATE_TOLERANCE) {
+            if (!ad.articulationDefName.empty() ||
+                ad.absoluteVelocity ||
+                ad.relativeVelocity != 1.0 ||
+                ad.absoluteVelocityChange != 0.0) {
+                ads.push_back(ad);
             }
-        } else if (articulationData[i].date < date) {
-            break; // Stop if we've gone past the date
         }
     }
     
@@ -194,76 +185,101 @@ void ArticulationMap::renderArticulationToMap_millisecondModifiers(GenericMap& m
     // This handles attributes like articulation.absoluteDelayMs, etc.
 }
 
-bool ArticulationMap::applyToMsmPart(Element msmPart) {
-    if (!msmPart || articulationData.empty()) {
+bool ArticulationMap::applyToNoteTable(msm::NoteTable& notes) {
+    if (notes.isEmpty() || articulationData.empty()) {
         return false;
     }
     
     bool modified = false;
     
-    // Find all note elements in the part - try both direct dated and header/dated paths
-    Element scoreElement;
+    // Merge join of the date-ordered notes with the date-ordered articulations, a single cursor walks the map
+    size_t cursor = 0;
+    for (size_t row : notes.getRowsInDateOrder()) {
+        if (applyToNote(notes, row, cursor)) {
+            modified = true;
+        }
+    }
     
-    // First try: part -> dated -> score (for some MSM structures)
-    scoreElement = xml::Helper::getFirstChildElement(msmPart, "dated");
-    if (scoreElement) {
-        scoreElement = xml::Helper::getFirstChildElement(scoreElement, "score");
+    return modified;
+}
+
+bool ArticulationMap::supportsNoteSweep() const {
+    return true;
+}
+
+bool ArticulationMap::applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) {
+    if (articulationData.empty() || !notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+        return false;
     }
     
-    // If not found, try: part -> header -> dated -> score (for Bach MSM structure)
-    if (!scoreElement) {
-        auto headerElement = xml::Helper::getFirstChildElement(msmPart, "header");
-        if (headerElement) {
-            auto datedElement = xml::Helper::getFirstChildElement(headerElement, "dated");
-            if (datedElement) {
-                scoreElement = xml::Helper::getFirstChildElement(datedElement, "score");
+    updateNoteIdIndex();
+    
+    double noteDate = notes.getDate(row);
+    bool modified = false;
+    
+    // Articulations with a noteid apply only to the referenced note, they are looked up by the note's id
+    long targeted = hasNoteTargets ? noteIdIndex.find(notes.getId(row), [this](size_t i) { return getTargetNoteId(i); }) : -1;
+    
+    // Articulations without noteid apply to all notes at the same date; place the cursor just before
+    // the date tolerance window, the candidates follow contiguously; they are applied together with
+    // the targeted articulations in map order
+    supplementary::timeline::seekBeforeAt(articulationData, noteDate - 2.0 * DATE_TOLERANCE, cursor, [](const auto& data) { return data.date; });
+    for (size_t i = cursor; (i < articulationData.size()) && (articulationData[i].date < noteDate + 2.0 * DATE_TOLERANCE); ++i) {
+        const ArticulationData& data = articulationData[i];
+        if (!data.noteid.empty() || (std::abs(data.date - noteDate) >= DATE_TOLERANCE)) {
+            continue;
+        }
+        for (; (targeted >= 0) && (static_cast<size_t>(targeted) < i); targeted = nextForNote[targeted]) {
+            if (applyArticulationToNote(notes, row, articulationData[targeted])) {
+                modified = true;
             }
         }
+        if (applyArticulationToNote(notes, row, data)) {
+            modified = true;
+        }
     }
-    
-    if (scoreElement) {
-        // Process all notes
-        for (auto note : scoreElement.children("note")) {
-            auto dateAttr = note.attribute("date");
-            
-            if (dateAttr) {
-                double noteDate = xml::Helper::parseDouble(dateAttr.value());
-                
-                // Check for specific articulations for this note
-                auto noteIdAttr = note.attribute("xml:id");
-                std::string noteId = noteIdAttr ? noteIdAttr.value() : "";
-                
-                // Find articulations that apply to this note
-                bool noteModified = false;
-                for (const auto& data : articulationData) {
-                    if (std::abs(data.date - noteDate) < 0.001) { // Same date
-                        // Check if this articulation applies to this specific note or all notes
-                        if (data.noteid.empty() || data.noteid == noteId) {
-                            if (applyArticulationToNote(note, data)) {
-                                noteModified = true;
-                            }
-                        }
-                    }
-                }
-                
-                if (noteModified) {
-                    modified = true;
-                }
-            }
+    for (; targeted >= 0; targeted = nextForNote[targeted]) {
+        if (applyArticulationToNote(notes, row, articulationData[targeted])) {
+            modified = true;
         }
     }
     
     return modified;
 }
 
+void ArticulationMap::prepareForRendering(int /*ppq*/) {
+    updateNoteIdIndex();
+}
+
+void ArticulationMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt32(static_cast<uint32_t>(articulationData.size()));
+    for (const auto& data : articulationData) {
+        data.writeToCache(writer);
+    }
+}
+
+bool ArticulationMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<ArticulationData> batch(count);
+    for (auto& data : batch) {
+        data.readFromCache(reader);
+    }
+    addArticulation(std::move(batch));
+    return reader.good();
+}
+
 void ArticulationMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
     // Parse articulation entries from XML
+    std::vector<ArticulationData> batch;
     for (auto child : xmlElement.children()) {
         if (std::string(child.name()) == "articulation") {
-            ArticulationData data(child);
-            articulationData.push_back(data);
+            batch.emplace_back(child);
         } else if (std::string(child.name()) == "style") {
             ArticulationData data;
             
@@ -273,7 +289,7 @@ void ArticulationMap::parseData(const Element& xmlElement) {
             auto xmlIdAttr = child.attribute("xml:id");
             
             if (dateAttr) {
-                data.date = xml::Helper::parseDouble(dateAttr.value());
+                data.date = xml::NumberCodec::parseDouble(dateAttr.value());
             }
             if (nameRefAttr) {
                 data.styleName = nameRefAttr.value();
@@ -286,93 +302,70 @@ void ArticulationMap::parseData(const Element& xmlElement) {
             }
             
             data.xml = child;
-            articulationData.push_back(data);
+            batch.push_back(data);
         }
     }
     
-    // Sort by date
-    std::sort(articulationData.begin(), articulationData.end(), 
-              [](const auto& a, const auto& b) { return a.date < b.date; });
+    // Sort once and add
+    addArticulation(std::move(batch));
 }
 
-bool ArticulationMap::applyArticulationToNote(Element& note, const ArticulationData& data) const {
+bool ArticulationMap::applyArticulationToNote(msm::NoteTable& notes, size_t row, const ArticulationData& data) const {
     bool modified = false;
     
     // Apply velocity changes
     if (data.absoluteVelocity) {
-        auto velocityAttr = note.attribute("velocity");
-        if (velocityAttr) {
-            velocityAttr.set_value(std::to_string(*data.absoluteVelocity).c_str());
-        } else {
-            note.append_attribute("velocity") = std::to_string(*data.absoluteVelocity).c_str();
-        }
+        notes.setVelocity(row, *data.absoluteVelocity);
         modified = true;
     } else if (data.relativeVelocity != 1.0) {
-        auto velocityAttr = note.attribute("velocity");
-        if (velocityAttr) {
-            double currentVelocity = xml::Helper::parseDouble(velocityAttr.value());
-            double newVelocity = currentVelocity * data.relativeVelocity;
+        if (notes.hasFlag(row, msm::NoteTable::HAS_VELOCITY)) {
+            double newVelocity = notes.getVelocity(row) * data.relativeVelocity;
             newVelocity = std::max(1.0, std::min(127.0, newVelocity)); // Clamp to MIDI range
-            velocityAttr.set_value(std::to_string(newVelocity).c_str());
+            notes.setVelocity(row, newVelocity);
             modified = true;
         }
     } else if (data.absoluteVelocityChange != 0.0) {
-        auto velocityAttr = note.attribute("velocity");
-        if (velocityAttr) {
-            double currentVelocity = xml::Helper::parseDouble(velocityAttr.value());
-            double newVelocity = currentVelocity + data.absoluteVelocityChange;
+        if (notes.hasFlag(row, msm::NoteTable::HAS_VELOCITY)) {
+            double newVelocity = notes.getVelocity(row) + data.absoluteVelocityChange;
             newVelocity = std::max(1.0, std::min(127.0, newVelocity)); // Clamp to MIDI range
-            velocityAttr.set_value(std::to_string(newVelocity).c_str());
+            notes.setVelocity(row, newVelocity);
             modified = true;
         }
     }
     
     // Apply duration changes
     if (data.absoluteDuration) {
-        auto durationAttr = note.attribute("duration");
-        if (durationAttr) {
-            durationAttr.set_value(std::to_string(*data.absoluteDuration).c_str());
-        } else {
-            note.append_attribute("duration") = std::to_string(*data.absoluteDuration).c_str();
-        }
+        notes.setDuration(row, *data.absoluteDuration);
         modified = true;
     } else if (data.relativeDuration != 1.0) {
-        auto durationAttr = note.attribute("duration");
-        if (durationAttr) {
-            double currentDuration = xml::Helper::parseDouble(durationAttr.value());
-            double newDuration = currentDuration * data.relativeDuration;
-            durationAttr.set_value(std::to_string(newDuration).c_str());
+        if (notes.hasFlag(row, msm::NoteTable::HAS_DURATION)) {
+            notes.setDuration(row, notes.getDuration(row) * data.relativeDuration);
             modified = true;
         }
     } else if (data.absoluteDurationChange != 0.0) {
-        auto durationAttr = note.attribute("duration");
-        if (durationAttr) {
-            double currentDuration = xml::Helper::parseDouble(durationAttr.value());
-            double newDuration = currentDuration + data.absoluteDurationChange;
+        if (notes.hasFlag(row, msm::NoteTable::HAS_DURATION)) {
+            double newDuration = notes.getDuration(row) + data.absoluteDurationChange;
             newDuration = std::max(1.0, newDuration); // Ensure positive duration
-            durationAttr.set_value(std::to_string(newDuration).c_str());
+            notes.setDuration(row, newDuration);
             modified = true;
         }
     }
     
     // Apply timing changes
     if (data.absoluteDelay != 0.0) {
-        auto dateAttr = note.attribute("date");
-        if (dateAttr) {
-            double currentDate = xml::Helper::parseDouble(dateAttr.value());
-            double newDate = currentDate + data.absoluteDelay;
-            dateAttr.set_value(std::to_string(newDate).c_str());
+        if (notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+            notes.setDate(row, notes.getDate(row) + data.absoluteDelay);
             modified = true;
         }
     }
     
     // Apply detuning
     if (data.detuneCents != 0.0) {
-        note.append_attribute("detuneCents") = std::to_string(data.detuneCents).c_str();
+        notes.addAttribute(row, "detuneCents", xml::NumberCodec::toString(data.detuneCents));
         modified = true;
     }
     if (data.detuneHz != 0.0) {
-        note.append_attribute("detuneHz") = std::to_string(data.detuneHz).c_str();
+        notes.addAttribute(row, "detuneHz", xml::NumberCodec::toString(data.detuneHz));
         modified = true;
     }
     
@@ -389,5 +382,45 @@ std::string ArticulationMap::findStyleAt(size_t index) const {
     return "";
 }
 
+int ArticulationMap::insertArticulationData(const ArticulationData& data) {
+    noteIdIndexValid = false;
+    
+    // Insert at its position to keep the data sorted by date
+    return static_cast<int>(supplementary::timeline::insertSorted(articulationData, data, [](const ArticulationData& d) { return d.date; }));
+}
+
+void ArticulationMap::updateNoteIdIndex() {
+    if (noteIdIndexValid) {
+        return;
+    }
+    
+    auto keyOf = [this](size_t i) { return getTargetNoteId(i); };
+    noteIdIndex.build(articulationData.size(), keyOf);
+
+    // chain the articulations of each note in map order, last holds the end of each chain by its first articulation
+    nextForNote.assign(articulationData.size(), -1);
+    std::vector<long> last(articulationData.size(), -1);
+    hasNoteTargets = false;
+    for (size_t i = 0; i < articulationData.size(); ++i) {
+        std::string_view noteId = keyOf(i);
+        if (noteId.empty()) {
+            continue;
+        }
+        hasNoteTargets = true;
+        long first = noteIdIndex.find(noteId, keyOf);
+        if (static_cast<size_t>(first) != i) {
+            nextForNote[last[first]] = static_cast<long>(i);
+        }
+        last[first] = static_cast<long>(i);
+    }
+    noteIdIndexValid = true;
+}
+
+std::string_view ArticulationMap::getTargetNoteId(size_t index) const {
+    std::string_view noteId = articulationData[index].noteid;
+    // referenced ids start with #
+    return (!noteId.empty() && (noteId[0] == '#')) ? noteId.substr(1) : noteId;
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "mpm/elements/maps/AsynchronyMap.h"
+#include "msm/NoteTable.h"
 #include "mpm/Mpm.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <iostream>
 
@@ -19,33 +22,62 @@ std::unique_ptr<AsynchronyMap> AsynchronyMap::createAsynchronyMap(const Element&
     return map;
 }
 
+void AsynchronyMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt32(static_cast<uint32_t>(asynchronyData.size()));
+    for (const auto& entry : asynchronyData) {
+        writer.writeDouble(entry.getValue()->date);
+        writer.writeDouble(entry.getValue()->millisecondsOffset);
+    }
+}
+
+bool AsynchronyMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<supplementary::Timeline<std::unique_ptr<AsynchronyData>>::Entry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; (i < count) && reader.good(); ++i) {
+        double date = reader.readDouble();
+        double millisecondsOffset = reader.readDouble();
+        entries.emplace_back(date, std::make_unique<AsynchronyData>(date, millisecondsOffset));
+    }
+    asynchronyData.insertAll(std::move(entries));
+    return reader.good();
+}
+
 void AsynchronyMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
     // Parse asynchrony elements from XML
+    std::vector<AsynchronyData> batch;
     for (auto child : xmlElement.children("asynchrony")) {
-        std::string dateStr = xml::Helper::getAttributeValue(child, "date");
-        std::string offsetStr = xml::Helper::getAttributeValue(child, "milliseconds.offset");
-        
-        if (!dateStr.empty() && !offsetStr.empty()) {
-            double date = std::stod(dateStr);
-            double offset = std::stod(offsetStr);
-            addAsynchrony(date, offset);
+        double date;
+        double offset;
+        if (xml::NumberCodec::tryParse(child.attribute("date").value(), date)
+                && xml::NumberCodec::tryParse(child.attribute("milliseconds.offset").value(), offset)) {
+            batch.emplace_back(date, offset);
         }
     }
+    addAsynchrony(batch);
 }
 
 int AsynchronyMap::addAsynchrony(double date, double millisecondsOffset) {
     auto data = std::make_unique<AsynchronyData>(date, millisecondsOffset);
-    supplementary::KeyValue<double, std::unique_ptr<AsynchronyData>> kv(date, std::move(data));
     
     // Insert in sorted order by date
-    auto it = std::lower_bound(asynchronyData.begin(), asynchronyData.end(), kv,
-        [](const auto& a, const auto& b) { return a.getKey() < b.getKey(); });
+    return static_cast<int>(asynchronyData.insert(date, std::move(data)));
+}
+
+void AsynchronyMap::addAsynchrony(const std::vector<AsynchronyData>& batch) {
+    std::vector<supplementary::Timeline<std::unique_ptr<AsynchronyData>>::Entry> entries;
+    entries.reserve(batch.size());
+    for (const auto& data : batch) {
+        entries.emplace_back(data.date, std::make_unique<AsynchronyData>(data));
+    }
     
-    int index = static_cast<int>(it - asynchronyData.begin());
-    asynchronyData.insert(it, std::move(kv));
-    return index;
+    asynchronyData.insertAll(std::move(entries));
 }
 
 double AsynchronyMap::getAsynchronyAt(double date) const {
@@ -57,15 +89,8 @@ double AsynchronyMap::getAsynchronyAt(double date) const {
 }
 
 int AsynchronyMap::getElementIndexBeforeAt(double date) const {
-    if (asynchronyData.empty())
-        return -1;
-    
     // Find the last element with date <= the given date
-    for (int i = static_cast<int>(asynchronyData.size()) - 1; i >= 0; --i) {
-        if (asynchronyData[i].getKey() <= date)
-            return i;
-    }
-    return -1;
+    return asynchronyData.indexBeforeAt(date);
 }
 
 void AsynchronyMap::renderAsynchronyToMap(GenericMap& map) {
@@ -79,7 +104,7 @@ void AsynchronyMap::renderAsynchronyToMap(GenericMap& map, AsynchronyMap* asynch
         asynchronyMap->renderAsynchronyToMap(map);
 }
 
-bool AsynchronyMap::applyToMsmPart(Element msmPart) {
+bool AsynchronyMap::applyToNoteTable(msm::NoteTable& notes) {
     // AsynchronyMap is typically applied to other maps, not directly to MSM parts
     // But we provide a basic implementation for interface compliance
     return false;
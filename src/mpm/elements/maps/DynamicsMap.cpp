@@ -1,7 +1,12 @@
 #include "mpm/elements/maps/DynamicsMap.h"
+#include "msm/NoteTable.h"
 #include "mpm/elements/maps/data/DynamicsData.h"
+#include "mpm/elements/maps/TempoMap.h"
+#include "msm/Msm.h"
 #include "mpm/Mpm.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <limits>
 
@@ -15,6 +20,12 @@ std::unique_ptr<DynamicsMap> DynamicsMap::createDynamicsMap() {
     return std::make_unique<DynamicsMap>();
 }
 
+std::unique_ptr<DynamicsMap> DynamicsMap::createDynamicsMap(const Element& xml) {
+    auto map = std::make_unique<DynamicsMap>();
+    map->parseData(xml);
+    return map;
+}
+
 void DynamicsMap::addDynamics(double date, const std::string& volume, const std::string& transitionTo, 
                               double curvature, double protraction, bool subNoteDynamics,
                               const std::string& id) {
@@ -22,21 +33,15 @@ void DynamicsMap::addDynamics(double date, const std::string& volume, const std:
     data->startDate = date;
     data->volumeString = volume;
     
-    // Try to parse volume as numeric value
-    try {
-        data->volume = xml::Helper::parseDouble(volume);
-    } catch (...) {
-        // Keep as string for style resolution
+    // Try to parse volume as numeric value, otherwise keep it as string for style resolution
+    if (!xml::NumberCodec::tryParse(volume, data->volume)) {
         data->volume = 0.0;
     }
     
     if (!transitionTo.empty()) {
         data->transitionToString = transitionTo;
-        try {
-            data->transitionTo = xml::Helper::parseDouble(transitionTo);
-        } catch (...) {
-            // Keep as string for style resolution
-            data->transitionTo = 0.0;
+        if (!xml::NumberCodec::tryParse(transitionTo, data->transitionTo)) {
+            data->transitionTo = 0.0;               // keep as string for style resolution
         }
     } else {
         // No transition specified - constant dynamics
@@ -55,17 +60,28 @@ void DynamicsMap::addDynamics(double date, const std::string& volume, const std:
 void DynamicsMap::addDynamics(std::unique_ptr<DynamicsData> data) {
     double date = data->startDate;
     
-    // Find insertion point to keep sorted by date
-    auto it = std::lower_bound(dynamicsData.begin(), dynamicsData.end(), date,
-        [](const auto& item, double d) { return item.getKey() < d; });
+    // Insert at the correct position to keep sorted by date
+    size_t index = dynamicsData.insert(date, std::move(data));
     
-    // Insert at the correct position
-    dynamicsData.emplace(it, date, std::move(data));
-    
-    // Update end dates for all elements
-    for (size_t i = 0; i < dynamicsData.size(); ++i) {
-        dynamicsData[i].getValue()->endDate = getEndDate(i);
+    // Only the new element and its predecessor get new end dates
+    dynamicsData[index].getValue()->endDate = getEndDate(static_cast<int>(index));
+    if (index > 0) {
+        dynamicsData[index - 1].getValue()->endDate = date;
+    }
+}
+
+void DynamicsMap::addDynamics(std::vector<std::unique_ptr<DynamicsData>> batch) {
+    std::vector<supplementary::Timeline<std::unique_ptr<DynamicsData>>::Entry> entries;
+    entries.reserve(batch.size());
+    for (auto& data : batch) {
+        if (data) {
+            double date = data->startDate;
+            entries.emplace_back(date, std::move(data));
+        }
     }
+    
+    dynamicsData.insertAll(std::move(entries));
+    updateEndDates();
 }
 
 DynamicsData* DynamicsMap::getDynamicsDataAt(double date) const {
@@ -95,75 +111,133 @@ double DynamicsMap::getDynamicsAt(double date) const {
     return dd->getDynamicsAt(date);
 }
 
-bool DynamicsMap::applyToMsmPart(Element msmPart) {
-    if (!msmPart || dynamicsData.empty()) {
+bool DynamicsMap::applyToNoteTable(msm::NoteTable& notes) {
+    if (notes.isEmpty() || dynamicsData.empty()) {
         return false;
     }
     
     bool modified = false;
     
-    // Find all note elements in the part - try both direct dated and header/dated paths
-    Element scoreElement;
-    
-    // First try: part -> dated -> score (for some MSM structures)
-    scoreElement = xml::Helper::getFirstChildElement(msmPart, "dated");
-    if (scoreElement) {
-        scoreElement = xml::Helper::getFirstChildElement(scoreElement, "score");
+    // Process all notes
+    for (size_t row = 0; row < notes.size(); ++row) {
+        if (notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+            double date = notes.getDate(row);
+            notes.setVelocity(row, getNoteVelocity(getElementIndexBeforeAt(date), date));
+            modified = true;
+        }
     }
     
-    // If not found, try: part -> header -> dated -> score (for Bach MSM structure)
-    if (!scoreElement) {
-        auto headerElement = xml::Helper::getFirstChildElement(msmPart, "header");
-        if (headerElement) {
-            auto datedElement = xml::Helper::getFirstChildElement(headerElement, "dated");
-            if (datedElement) {
-                scoreElement = xml::Helper::getFirstChildElement(datedElement, "score");
-            }
+    return modified;
+}
+
+bool DynamicsMap::supportsNoteSweep() const {
+    return true;
+}
+
+void DynamicsMap::prepareForRendering(int /*ppq*/) {
+    for (auto& entry : dynamicsData) {
+        if (entry.getValue()) {
+            entry.getValue()->computeInnerControlPointsXPositions();
         }
     }
+}
+
+bool DynamicsMap::applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) {
+    if (dynamicsData.empty() || !notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+        return false;
+    }
     
-    if (scoreElement) {
-        // Process all notes
-        for (auto note : scoreElement.children("note")) {
-            auto dateAttr = note.attribute("date");
-            if (dateAttr) {
-                double noteDate = xml::Helper::parseDouble(dateAttr.value());
-                double newVelocity = getDynamicsAt(noteDate);
-                
-                // Update or add velocity attribute
-                auto velocityAttr = note.attribute("velocity");
-                if (velocityAttr) {
-                    velocityAttr.set_value(std::to_string(newVelocity).c_str());
-                } else {
-                    note.append_attribute("velocity") = std::to_string(newVelocity).c_str();
-                }
-                modified = true;
-            }
+    double date = notes.getDate(row);
+    notes.setVelocity(row, getNoteVelocity(dynamicsData.seekBeforeAt(date, cursor), date));
+    return true;
+}
+
+double DynamicsMap::getNoteVelocity(int index, double date) const {
+    DynamicsData* dd = nullptr;
+    for (; (index >= 0) && (dd == nullptr); --index) {
+        dd = getDynamicsDataOf(index);
+    }
+    if (dd == nullptr) {
+        return 100.0;
+    }
+    if (dd->subNoteDynamics && ((index + 1) < (static_cast<int>(dynamicsData.size()) - 1))) {
+        return 100.0;                           // the loudness is controlled by the channel volume, see renderSubNoteDynamics()
+    }
+    return dd->getDynamicsAt(date);
+}
+
+bool DynamicsMap::renderSubNoteDynamics(msm::NoteTable& notes, const TempoMap* tempoMap) const {
+    int last = static_cast<int>(dynamicsData.size()) - 1;
+    bool hasSubNoteDynamics = false;
+    for (int i = 0; (i < last) && !hasSubNoteDynamics; ++i) {
+        DynamicsData* dd = getDynamicsDataOf(i);
+        hasSubNoteDynamics = (dd != nullptr) && dd->subNoteDynamics;
+    }
+    if (!hasSubNoteDynamics) {
+        return false;
+    }
+
+    int ppq = notes.getPPQ();
+    auto toMilliseconds = [tempoMap, ppq](double date) {
+        return (tempoMap == nullptr) ? date : tempoMap->getMillisecondsAt(date, ppq);
+    };
+    for (int i = 0; i <= last; ++i) {
+        DynamicsData* dd = getDynamicsDataOf(i);
+        if (dd == nullptr) {
+            continue;
+        }
+        if (dd->subNoteDynamics && (i < last)) {
+            dd->renderSubNoteDynamics(notes, toMilliseconds, msm::Msm::CONTROL_CHANGE_DENSITY);
+            continue;
+        }
+
+        // without sub-note dynamics the channel volume is set back to the default
+        const auto& channelVolume = notes.getChannelVolume();
+        if (channelVolume.empty() || (channelVolume.back().value != 100.0)) {
+            notes.addChannelVolume({dd->startDate, toMilliseconds(dd->startDate), 100.0, true});
         }
     }
-    
-    return modified;
+    return true;
+}
+
+void DynamicsMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt32(static_cast<uint32_t>(dynamicsData.size()));
+    for (const auto& entry : dynamicsData) {
+        entry.getValue()->writeToCache(writer);
+    }
+}
+
+bool DynamicsMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<supplementary::Timeline<std::unique_ptr<DynamicsData>>::Entry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; (i < count) && reader.good(); ++i) {
+        auto data = std::make_unique<DynamicsData>();
+        data->readFromCache(reader);
+        double date = data->startDate;
+        entries.emplace_back(date, std::move(data));
+    }
+    dynamicsData.insertAll(std::move(entries));
+    return reader.good();
 }
 
 void DynamicsMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
     // Parse dynamics entries from XML
-    for (auto child : xmlElement.children()) {
-        if (std::string(child.name()) == "dynamics") {
-            auto data = std::make_unique<DynamicsData>(child);
-            addDynamics(std::move(data));
-        }
+    std::vector<std::unique_ptr<DynamicsData>> batch;
+    for (auto child : xmlElement.children("dynamics")) {
+        batch.push_back(std::make_unique<DynamicsData>(child));
     }
+    addDynamics(std::move(batch));
 }
 
 int DynamicsMap::getElementIndexBeforeAt(double date) const {
-    for (int i = static_cast<int>(dynamicsData.size()) - 1; i >= 0; --i) {
-        if (dynamicsData[i].getKey() <= date) {
-            return i;
-        }
-    }
-    return -1;
+    return dynamicsData.indexBeforeAt(date);
 }
 
 double DynamicsMap::getEndDate(int index) const {
@@ -176,5 +250,11 @@ double DynamicsMap::getEndDate(int index) const {
     return endDate;
 }
 
+void DynamicsMap::updateEndDates() {
+    for (size_t i = 0; i < dynamicsData.size(); ++i) {
+        dynamicsData[i].getValue()->endDate = getEndDate(static_cast<int>(i));
+    }
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "mpm/elements/maps/GenericMap.h"
+#include "msm/NoteTable.h"
 
 namespace meico {
 namespace mpm {
@@ -10,6 +11,37 @@ const std::string& GenericMap::getMapType() const {
     return mapType;
 }
 
+void GenericMap::setMapType(std::string_view type) {
+    mapType.assign(type.data(), type.size());
+}
+
+bool GenericMap::applyToMsmPart(Element msmPart) {
+    msm::NoteTable notes(msmPart);
+    if (!applyToNoteTable(notes)) {
+        return false;
+    }
+    notes.writeBack();
+    return true;
+}
+
+bool GenericMap::supportsNoteSweep() const {
+    return false;
+}
+
+bool GenericMap::applyToNote(msm::NoteTable& /*notes*/, size_t /*row*/, size_t& /*cursor*/) {
+    return false;
+}
+
+void GenericMap::prepareForRendering(int /*ppq*/) {
+}
+
+void GenericMap::writeToCache(supplementary::BinaryWriter& /*writer*/) const {
+}
+
+bool GenericMap::readFromCache(supplementary::BinaryReader& /*reader*/) {
+    return true;
+}
+
 void GenericMap::parseData(const Element& xmlElement) {
     // Basic parsing implementation
     setXml(xmlElement);
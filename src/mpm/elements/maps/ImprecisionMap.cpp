@@ -1,10 +1,11 @@
 #include "mpm/elements/maps/ImprecisionMap.h"
+#include "msm/NoteTable.h"
 #include "mpm/Mpm.h"
 #include "xml/Helper.h"
 #include <algorithm>
 #include <iostream>
 #include <cmath>
-#include <regex>
+#include <string_view>
 #include <random>
 
 namespace meico {
@@ -16,7 +17,7 @@ const int ImprecisionMap::TONEDURATION;
 const int ImprecisionMap::TUNING;
 
 ImprecisionMap::ImprecisionMap(const std::string& domain) 
-    : GenericMap("imprecisionMap" + (domain.empty() ? "" : ("." + domain))) {}
+    : GenericMap(Mpm::IMPRECISION_MAP + (domain.empty() ? "" : ("." + domain))), domain(domain) {}
 
 ImprecisionMap::ImprecisionMap(const Element& xml) : GenericMap("imprecisionMap") {
     parseData(xml);
@@ -43,31 +44,36 @@ std::unique_ptr<ImprecisionMap> ImprecisionMap::createImprecisionMap(const Eleme
 void ImprecisionMap::parseData(const Element& xml) {
     GenericMap::parseData(xml);
 
-    std::string localname = this->getXml().name();
-    if (localname.find("imprecisionMap") == std::string::npos) {
-        throw std::runtime_error("Cannot generate ImprecisionMap object. Local name \"" + localname + "\" must contain the substring \"imprecisionMap\".");
+    std::string_view localname = this->getXml().name();
+    if (localname.find(Mpm::IMPRECISION_MAP) == std::string_view::npos) {
+        throw std::runtime_error("Cannot generate ImprecisionMap object. Local name \"" + std::string(localname) + "\" must contain the substring \"imprecisionMap\".");
     }
 
-    // Split by "." to get domain
-    std::regex dotRegex("\\.");
-    std::vector<std::string> domain;
-    std::sregex_token_iterator iter(localname.begin(), localname.end(), dotRegex, -1);
-    std::sregex_token_iterator end;
-    for (; iter != end; ++iter) {
-        domain.push_back(*iter);
-    }
+    // the domain is what follows the first "." and is kept, so it is not parsed from the name again
+    size_t dot = localname.find('.');
+    std::string_view domainName = (dot == std::string_view::npos) ? std::string_view() : localname.substr(dot + 1);
+    domainName = domainName.substr(0, domainName.find('.'));
+    domain.assign(domainName.data(), domainName.size());
+    setMapType(localname);
 
-    if (domain.size() < 2) // if there is no "." or nothing that follows it
+    if (domain.empty()) // if there is no "." or nothing that follows it
         std::cout << "Don't forget to specify the domain of the imprecisionMap!" << std::endl; // print a warning message
 }
 
 void ImprecisionMap::setDomain(const std::string& domain) {
+    this->domain = domain;
+    setMapType(Mpm::IMPRECISION_MAP + (domain.empty() ? "" : ("." + domain)));
+
+    if (!this->getXml()) {                          // a map without xml, e.g. restored from a performance cache
+        return;
+    }
+
     if (domain.empty()) {
-        this->getXml().set_name("imprecisionMap");
+        this->getXml().set_name(Mpm::IMPRECISION_MAP.c_str());
         return;
     }
 
-    this->getXml().set_name(("imprecisionMap." + domain).c_str());
+    this->getXml().set_name(getMapType().c_str());
 
     // Handle detuneUnit attribute for tuning domain
     auto detuneUnitAtt = this->getXml().attribute("detuneUnit");
@@ -80,21 +86,8 @@ void ImprecisionMap::setDomain(const std::string& domain) {
     }
 }
 
-std::string ImprecisionMap::getDomain() const {
-    std::string localname = this->getXml().name();
-    
-    std::regex dotRegex("\\.");
-    std::vector<std::string> domain;
-    std::sregex_token_iterator iter(localname.begin(), localname.end(), dotRegex, -1);
-    std::sregex_token_iterator end;
-    for (; iter != end; ++iter) {
-        domain.push_back(*iter);
-    }
-
-    if (domain.size() < 2)
-        return "";
-
-    return domain[1];
+const std::string& ImprecisionMap::getDomain() const {
+    return domain;
 }
 
 void ImprecisionMap::setDetuneUnit(const std::string& unit) {
@@ -185,7 +178,7 @@ void ImprecisionMap::renderImprecisionToMap(GenericMap& map, ImprecisionMap* imp
         imprecisionMap->renderImprecisionToMap(map, shakePolyphonicPart);
 }
 
-bool ImprecisionMap::applyToMsmPart(Element msmPart) {
+bool ImprecisionMap::applyToNoteTable(msm::NoteTable& notes) {
     // ImprecisionMap is typically applied to other maps, not directly to MSM parts
     // But we provide a basic implementation for interface compliance
     return false;
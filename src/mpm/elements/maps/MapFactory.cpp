@@ -0,0 +1,108 @@
+#include "mpm/elements/maps/MapFactory.h"
+#include "mpm/elements/maps/GenericMap.h"
+#include "mpm/elements/maps/ArticulationMap.h"
+#include "mpm/elements/maps/AsynchronyMap.h"
+#include "mpm/elements/maps/DynamicsMap.h"
+#include "mpm/elements/maps/ImprecisionMap.h"
+#include "mpm/elements/maps/MetricalAccentuationMap.h"
+#include "mpm/elements/maps/MovementMap.h"
+#include "mpm/elements/maps/OrnamentationMap.h"
+#include "mpm/elements/maps/RubatoMap.h"
+#include "mpm/elements/maps/TempoMap.h"
+#include <iostream>
+#include <stdexcept>
+
+namespace meico {
+namespace mpm {
+
+MapFactory::Type MapFactory::lookup(std::string_view mapType) {
+    // the case labels are computed at compile time, two names with the same hash would not compile
+    switch (hash(mapType)) {
+        case hash("articulationMap"):
+            return (mapType == "articulationMap") ? Type::ARTICULATION : Type::UNKNOWN;
+        case hash("asynchronyMap"):
+            return (mapType == "asynchronyMap") ? Type::ASYNCHRONY : Type::UNKNOWN;
+        case hash("dynamicsMap"):
+            return (mapType == "dynamicsMap") ? Type::DYNAMICS : Type::UNKNOWN;
+        case hash("metricalAccentuationMap"):
+            return (mapType == "metricalAccentuationMap") ? Type::METRICAL_ACCENTUATION : Type::UNKNOWN;
+        case hash("movementMap"):
+            return (mapType == "movementMap") ? Type::MOVEMENT : Type::UNKNOWN;
+        case hash("ornamentationMap"):
+            return (mapType == "ornamentationMap") ? Type::ORNAMENTATION : Type::UNKNOWN;
+        case hash("rubatoMap"):
+            return (mapType == "rubatoMap") ? Type::RUBATO : Type::UNKNOWN;
+        case hash("tempoMap"):
+            return (mapType == "tempoMap") ? Type::TEMPO : Type::UNKNOWN;
+        case hash("imprecisionMap"):
+            return (mapType == "imprecisionMap") ? Type::IMPRECISION : Type::UNKNOWN;
+        case hash("imprecisionMap.timing"):
+            return (mapType == "imprecisionMap.timing") ? Type::IMPRECISION : Type::UNKNOWN;
+        case hash("imprecisionMap.dynamics"):
+            return (mapType == "imprecisionMap.dynamics") ? Type::IMPRECISION : Type::UNKNOWN;
+        case hash("imprecisionMap.toneduration"):
+            return (mapType == "imprecisionMap.toneduration") ? Type::IMPRECISION : Type::UNKNOWN;
+        case hash("imprecisionMap.tuning"):
+            return (mapType == "imprecisionMap.tuning") ? Type::IMPRECISION : Type::UNKNOWN;
+        default:
+            break;
+    }
+
+    // imprecisionMaps may have any domain, the four above are only the common ones
+    std::string_view prefix = "imprecisionMap.";
+    return (mapType.substr(0, prefix.size()) == prefix) ? Type::IMPRECISION : Type::UNKNOWN;
+}
+
+bool MapFactory::isMapType(std::string_view mapType) {
+    return lookup(mapType) != Type::UNKNOWN;
+}
+
+std::unique_ptr<GenericMap> MapFactory::createMap(std::string_view mapType) {
+    switch (lookup(mapType)) {
+        case Type::ARTICULATION: return ArticulationMap::createArticulationMap();
+        case Type::ASYNCHRONY: return AsynchronyMap::createAsynchronyMap();
+        case Type::DYNAMICS: return DynamicsMap::createDynamicsMap();
+        case Type::METRICAL_ACCENTUATION: return MetricalAccentuationMap::createMetricalAccentuationMap();
+        case Type::MOVEMENT: return MovementMap::createMovementMap();
+        case Type::ORNAMENTATION: return OrnamentationMap::createOrnamentationMap();
+        case Type::RUBATO: return RubatoMap::createRubatoMap();
+        case Type::TEMPO: return TempoMap::createTempoMap();
+        case Type::IMPRECISION: {
+            size_t dot = mapType.find('.');
+            std::string domain = (dot == std::string_view::npos) ? std::string() : std::string(mapType.substr(dot + 1));
+            return ImprecisionMap::createImprecisionMap(domain);
+        }
+        case Type::UNKNOWN:
+        default:
+            return nullptr;
+    }
+}
+
+std::unique_ptr<GenericMap> MapFactory::createMap(const Element& xml) {
+    if (!xml) {
+        return nullptr;
+    }
+
+    try {
+        switch (lookup(xml.name())) {
+            case Type::ARTICULATION: return ArticulationMap::createArticulationMap(xml);
+            case Type::ASYNCHRONY: return AsynchronyMap::createAsynchronyMap(xml);
+            case Type::DYNAMICS: return DynamicsMap::createDynamicsMap(xml);
+            case Type::METRICAL_ACCENTUATION: return MetricalAccentuationMap::createMetricalAccentuationMap(xml);
+            case Type::MOVEMENT: return MovementMap::createMovementMap(xml);
+            case Type::ORNAMENTATION: return OrnamentationMap::createOrnamentationMap(xml);
+            case Type::RUBATO: return RubatoMap::createRubatoMap(xml);
+            case Type::TEMPO: return TempoMap::createTempoMap(xml);
+            case Type::IMPRECISION: return ImprecisionMap::createImprecisionMap(xml);
+            case Type::UNKNOWN:
+            default:
+                return nullptr;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to create " << xml.name() << " from XML: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+} // namespace mpm
+} // namespace meico
@@ -1,7 +1,10 @@
 #include "mpm/elements/maps/MetricalAccentuationMap.h"
+#include "msm/NoteTable.h"
+#include "supplementary/Timeline.h"
 #include "mpm/elements/maps/data/MetricalAccentuationData.h"
 #include "mpm/Mpm.h"
 #include "xml/Helper.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -16,6 +19,12 @@ std::unique_ptr<MetricalAccentuationMap> MetricalAccentuationMap::createMetrical
     return std::make_unique<MetricalAccentuationMap>();
 }
 
+std::unique_ptr<MetricalAccentuationMap> MetricalAccentuationMap::createMetricalAccentuationMap(const Element& xml) {
+    auto map = std::make_unique<MetricalAccentuationMap>();
+    map->parseData(xml);
+    return map;
+}
+
 int MetricalAccentuationMap::addAccentuationPattern(double date, const std::string& accentuationPatternDefName, 
                                                    double scale, bool loop, bool stickToMeasures) {
     MetricalAccentuationData data;
@@ -25,13 +34,8 @@ int MetricalAccentuationMap::addAccentuationPattern(double date, const std::stri
     data.loop = loop;
     data.stickToMeasures = stickToMeasures;
     
-    accentuationData.push_back(data);
-    
-    // Keep data sorted by date for efficient lookup
-    std::sort(accentuationData.begin(), accentuationData.end(), 
-              [](const auto& a, const auto& b) { return a.startDate < b.startDate; });
-    
-    return static_cast<int>(accentuationData.size() - 1);
+    // Insert at its position to keep the data sorted by date
+    return static_cast<int>(supplementary::timeline::insertSorted(accentuationData, data, [](const MetricalAccentuationData& d) { return d.startDate; }));
 }
 
 int MetricalAccentuationMap::addAccentuationPattern(double date, const std::string& accentuationPatternDefName, 
@@ -45,13 +49,12 @@ int MetricalAccentuationMap::addAccentuationPattern(double date, const std::stri
 }
 
 int MetricalAccentuationMap::addAccentuationPattern(const MetricalAccentuationData& data) {
-    accentuationData.push_back(data);
-    
-    // Keep data sorted by date for efficient lookup
-    std::sort(accentuationData.begin(), accentuationData.end(), 
-              [](const auto& a, const auto& b) { return a.startDate < b.startDate; });
-    
-    return static_cast<int>(accentuationData.size() - 1);
+    // Insert at its position to keep the data sorted by date
+    return static_cast<int>(supplementary::timeline::insertSorted(accentuationData, data, [](const MetricalAccentuationData& d) { return d.startDate; }));
+}
+
+void MetricalAccentuationMap::addAccentuationPattern(std::vector<MetricalAccentuationData> batch) {
+    supplementary::timeline::mergeBatch(accentuationData, std::move(batch), [](const MetricalAccentuationData& d) { return d.startDate; });
 }
 
 std::shared_ptr<MetricalAccentuationData> MetricalAccentuationMap::getMetricalAccentuationDataOf(int index) {
@@ -70,12 +73,8 @@ std::shared_ptr<MetricalAccentuationData> MetricalAccentuationMap::getMetricalAc
 }
 
 std::shared_ptr<MetricalAccentuationData> MetricalAccentuationMap::getMetricalAccentuationDataAt(double date) {
-    for (int i = static_cast<int>(accentuationData.size()) - 1; i >= 0; --i) {
-        if (accentuationData[i].startDate <= date) {
-            return getMetricalAccentuationDataOf(i);
-        }
-    }
-    return nullptr;
+    int index = supplementary::timeline::indexBeforeAt(accentuationData, date, [](const auto& data) { return data.startDate; });
+    return getMetricalAccentuationDataOf(index);
 }
 
 double MetricalAccentuationMap::getEndDate(int index) {
@@ -118,88 +117,117 @@ void MetricalAccentuationMap::renderMetricalAccentuationToMap(GenericMap& map, G
     }
 }
 
-bool MetricalAccentuationMap::applyToMsmPart(Element msmPart) {
-    if (!msmPart || accentuationData.empty()) {
+bool MetricalAccentuationMap::applyToNoteTable(msm::NoteTable& notes) {
+    if (notes.isEmpty() || accentuationData.empty()) {
         return false;
     }
     
     bool modified = false;
     
-    // Find all note elements in the part
-    auto scoreElement = xml::Helper::getFirstChildElement(msmPart, "dated");
-    if (scoreElement) {
-        scoreElement = xml::Helper::getFirstChildElement(scoreElement, "score");
-        if (scoreElement) {
-            // Process all notes
-            for (auto note : scoreElement.children("note")) {
-                auto dateAttr = note.attribute("date");
-                auto velocityAttr = note.attribute("velocity");
-                
-                if (dateAttr && velocityAttr) {
-                    double noteDate = xml::Helper::parseDouble(dateAttr.value());
-                    double currentVelocity = xml::Helper::parseDouble(velocityAttr.value());
-                    
-                    auto data = getMetricalAccentuationDataAt(noteDate);
-                    if (data) {
-                        // Check if this note is within the pattern's scope
-                        double endDate = data->endDate ? *data->endDate : std::numeric_limits<double>::max();
-                        
-                        // Simplified time signature handling (assumes 4/4 time, PPQ of 480)
-                        double ppq = 480.0;
-                        double beatsPerMeasure = 4.0;
-                        double ticksPerBeat = ppq;
-                        double ticksPerMeasure = beatsPerMeasure * ticksPerBeat;
-                        
-                        // Calculate pattern length - simplified for now
-                        double patternLengthTicks = ticksPerMeasure; // Use one measure as pattern length
-                        
-                        // Check if note is within pattern scope
-                        if ((noteDate < endDate) && 
-                            (data->loop || (noteDate < (data->startDate + patternLengthTicks)))) {
-                            
-                            double beat;
-                            if (data->stickToMeasures) {
-                                // Calculate beat position within measure
-                                double ticksIntoMeasure = fmod(noteDate, ticksPerMeasure);
-                                beat = 1.0 + (ticksIntoMeasure / ticksPerBeat);
-                            } else {
-                                // Calculate beat position from pattern start
-                                double ticksSinceStart = fmod(noteDate - data->startDate, patternLengthTicks);
-                                beat = 1.0 + (ticksSinceStart / ticksPerBeat);
-                            }
-                            
-                            double accentuation = computeAccentuationAt(beat, *data);
-                            double newVelocity = currentVelocity + (accentuation * data->scale);
-                            
-                            // Clamp velocity to reasonable range
-                            newVelocity = std::max(1.0, std::min(127.0, newVelocity));
-                            
-                            velocityAttr.set_value(std::to_string(newVelocity).c_str());
-                            modified = true;
-                        }
-                    }
-                }
-            }
+    // Process all notes
+    for (size_t row = 0; row < notes.size(); ++row) {
+        if (!notes.hasFlag(row, msm::NoteTable::HAS_DATE) || !notes.hasFlag(row, msm::NoteTable::HAS_VELOCITY)) {
+            continue;
+        }
+        
+        auto data = getMetricalAccentuationDataAt(notes.getDate(row));
+        if (data && applyAccentuationToNote(notes, row, *data)) {
+            modified = true;
         }
     }
     
     return modified;
 }
 
+bool MetricalAccentuationMap::supportsNoteSweep() const {
+    return true;
+}
+
+bool MetricalAccentuationMap::applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) {
+    if (accentuationData.empty() || !notes.hasFlag(row, msm::NoteTable::HAS_DATE) || !notes.hasFlag(row, msm::NoteTable::HAS_VELOCITY)) {
+        return false;
+    }
+    
+    int index = supplementary::timeline::seekBeforeAt(accentuationData, notes.getDate(row), cursor, [](const auto& data) { return data.startDate; });
+    auto data = getMetricalAccentuationDataOf(index);
+    return data && applyAccentuationToNote(notes, row, *data);
+}
+
+bool MetricalAccentuationMap::applyAccentuationToNote(msm::NoteTable& notes, size_t row, const MetricalAccentuationData& data) const {
+    double noteDate = notes.getDate(row);
+    double currentVelocity = notes.getVelocity(row);
+    
+    // Check if this note is within the pattern's scope
+    double endDate = data.endDate ? *data.endDate : std::numeric_limits<double>::max();
+    
+    // Simplified time signature handling (assumes 4/4 time, PPQ of 480)
+    double ppq = 480.0;
+    double beatsPerMeasure = 4.0;
+    double ticksPerBeat = ppq;
+    double ticksPerMeasure = beatsPerMeasure * ticksPerBeat;
+    
+    // Calculate pattern length - simplified for now
+    double patternLengthTicks = ticksPerMeasure; // Use one measure as pattern length
+    
+    // Check if note is within pattern scope
+    if ((noteDate >= endDate) || 
+        (!data.loop && (noteDate >= (data.startDate + patternLengthTicks)))) {
+        return false;
+    }
+    
+    double beat;
+    if (data.stickToMeasures) {
+        // Calculate beat position within measure
+        double ticksIntoMeasure = fmod(noteDate, ticksPerMeasure);
+        beat = 1.0 + (ticksIntoMeasure / ticksPerBeat);
+    } else {
+        // Calculate beat position from pattern start
+        double ticksSinceStart = fmod(noteDate - data.startDate, patternLengthTicks);
+        beat = 1.0 + (ticksSinceStart / ticksPerBeat);
+    }
+    
+    double accentuation = computeAccentuationAt(beat, data);
+    double newVelocity = currentVelocity + (accentuation * data.scale);
+    
+    // Clamp velocity to reasonable range
+    newVelocity = std::max(1.0, std::min(127.0, newVelocity));
+    
+    notes.setVelocity(row, newVelocity);
+    return true;
+}
+
+void MetricalAccentuationMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt32(static_cast<uint32_t>(accentuationData.size()));
+    for (const auto& data : accentuationData) {
+        data.writeToCache(writer);
+    }
+}
+
+bool MetricalAccentuationMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<MetricalAccentuationData> batch(count);
+    for (auto& data : batch) {
+        data.readFromCache(reader);
+    }
+    addAccentuationPattern(std::move(batch));
+    return reader.good();
+}
+
 void MetricalAccentuationMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
     // Parse accentuation pattern entries from XML
-    for (auto child : xmlElement.children()) {
-        if (std::string(child.name()) == "accentuationPattern") {
-            MetricalAccentuationData data(child);
-            accentuationData.push_back(data);
-        }
+    std::vector<MetricalAccentuationData> batch;
+    for (auto child : xmlElement.children("accentuationPattern")) {
+        batch.emplace_back(child);
     }
     
-    // Sort by start date
-    std::sort(accentuationData.begin(), accentuationData.end(), 
-              [](const auto& a, const auto& b) { return a.startDate < b.startDate; });
+    // Sort once and add
+    addAccentuationPattern(std::move(batch));
 }
 
 double MetricalAccentuationMap::computeAccentuationAt(double beat, const MetricalAccentuationData& data) const {
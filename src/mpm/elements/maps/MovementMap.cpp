@@ -1,6 +1,8 @@
 #include "mpm/elements/maps/MovementMap.h"
+#include "msm/NoteTable.h"
 #include "xml/Helper.h"
 #include "xml/XmlBase.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <iostream>
 #include <limits>
@@ -15,16 +17,46 @@ std::unique_ptr<MovementMap> MovementMap::createMovementMap() {
     return std::make_unique<MovementMap>();
 }
 
+std::unique_ptr<MovementMap> MovementMap::createMovementMap(const Element& xml) {
+    auto map = std::make_unique<MovementMap>();
+    map->parseData(xml);
+    return map;
+}
+
+void MovementMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt32(static_cast<uint32_t>(movementData.size()));
+    for (const auto& entry : movementData) {
+        entry.getValue()->writeToCache(writer);
+    }
+}
+
+bool MovementMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<supplementary::Timeline<std::unique_ptr<MovementData>>::Entry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; (i < count) && reader.good(); ++i) {
+        auto data = std::make_unique<MovementData>();
+        data->readFromCache(reader);
+        double date = data->startDate;
+        entries.emplace_back(date, std::move(data));
+    }
+    movementData.insertAll(std::move(entries));
+    return reader.good();
+}
+
 void MovementMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
     // Parse movement entries from XML
-    for (auto child : xmlElement.children()) {
-        if (std::string(child.name()) == "movement") {
-            auto data = std::make_unique<MovementData>(child);
-            addMovement(std::move(data));
-        }
+    std::vector<std::unique_ptr<MovementData>> batch;
+    for (auto child : xmlElement.children("movement")) {
+        batch.push_back(std::make_unique<MovementData>(child));
     }
+    addMovement(std::move(batch));
 }
 
 void MovementMap::addMovement(double date, const std::string& controller, double position, 
@@ -49,21 +81,26 @@ void MovementMap::addMovement(double date, const std::string& controller, double
 
 void MovementMap::addMovement(std::unique_ptr<MovementData> data) {
     double date = data->startDate;
-    supplementary::KeyValue<double, std::unique_ptr<MovementData>> kv(date, std::move(data));
     
     // Insert in sorted order
-    auto it = std::lower_bound(movementData.begin(), movementData.end(), kv,
-        [](const auto& a, const auto& b) { return a.getKey() < b.getKey(); });
-    movementData.insert(it, std::move(kv));
+    movementData.insert(date, std::move(data));
 }
 
-int MovementMap::getElementIndexBeforeAt(double date) const {
-    for (int i = static_cast<int>(movementData.size()) - 1; i >= 0; --i) {
-        if (movementData[i].getKey() <= date) {
-            return i;
+void MovementMap::addMovement(std::vector<std::unique_ptr<MovementData>> batch) {
+    std::vector<supplementary::Timeline<std::unique_ptr<MovementData>>::Entry> entries;
+    entries.reserve(batch.size());
+    for (auto& data : batch) {
+        if (data) {
+            double date = data->startDate;
+            entries.emplace_back(date, std::move(data));
         }
     }
-    return -1;
+    
+    movementData.insertAll(std::move(entries));
+}
+
+int MovementMap::getElementIndexBeforeAt(double date) const {
+    return movementData.indexBeforeAt(date);
 }
 
 MovementData* MovementMap::getMovementDataAt(double date) const {
@@ -158,7 +195,7 @@ void MovementMap::generateMovement(MovementData* movementData, GenericMap* posit
     }
 }
 
-bool MovementMap::applyToMsmPart(Element msmPart) {
+bool MovementMap::applyToNoteTable(msm::NoteTable& notes) {
     // MovementMap doesn't directly modify MSM notes, but creates a positionMap
     // This is more of a rendering operation than direct modification
     auto positionMap = renderMovementToMap();
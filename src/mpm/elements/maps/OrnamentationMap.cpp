@@ -1,8 +1,11 @@
 #include "mpm/elements/maps/OrnamentationMap.h"
+#include "msm/NoteTable.h"
 #include "mpm/Mpm.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
-#include <iostream>
+#include <cmath>
 
 namespace meico {
 namespace mpm {
@@ -14,11 +17,46 @@ std::unique_ptr<OrnamentationMap> OrnamentationMap::createOrnamentationMap() {
     return std::make_unique<OrnamentationMap>();
 }
 
+std::unique_ptr<OrnamentationMap> OrnamentationMap::createOrnamentationMap(const Element& xml) {
+    auto map = std::make_unique<OrnamentationMap>();
+    map->parseData(xml);
+    return map;
+}
+
+void OrnamentationMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt32(static_cast<uint32_t>(ornamentData.size()));
+    for (const auto& entry : ornamentData) {
+        entry.getValue()->writeToCache(writer);
+    }
+}
+
+bool OrnamentationMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<supplementary::Timeline<std::unique_ptr<OrnamentData>>::Entry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; (i < count) && reader.good(); ++i) {
+        auto data = std::make_unique<OrnamentData>();
+        data->readFromCache(reader);
+        double date = data->date;
+        entries.emplace_back(date, std::move(data));
+    }
+    ornamentData.insertAll(std::move(entries));
+    return reader.good();
+}
+
 void OrnamentationMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
-    // TODO: Parse ornamentation data from XML
-    // For now, this is a placeholder
+    // Parse ornament entries from XML
+    std::vector<OrnamentData> batch;
+    for (auto child : xmlElement.children("ornament")) {
+        batch.emplace_back(child);
+    }
+    addOrnament(batch);
 }
 
 int OrnamentationMap::addOrnament(double date, const std::string& nameRef, double scale, 
@@ -38,18 +76,19 @@ int OrnamentationMap::addOrnament(const OrnamentData& data) {
     return insertOrnamentData(data.date, std::move(dataCopy));
 }
 
-int OrnamentationMap::insertOrnamentData(double date, std::unique_ptr<OrnamentData> data) {
-    // Find the insertion point to keep the vector sorted by date
-    auto it = std::lower_bound(ornamentData.begin(), ornamentData.end(), date,
-        [](const supplementary::KeyValue<double, std::unique_ptr<OrnamentData>>& kv, double date) {
-            return kv.getKey() < date;
-        });
-    
-    // Insert the new element
-    auto pos = ornamentData.insert(it, supplementary::KeyValue<double, std::unique_ptr<OrnamentData>>(date, std::move(data)));
+void OrnamentationMap::addOrnament(const std::vector<OrnamentData>& batch) {
+    std::vector<supplementary::Timeline<std::unique_ptr<OrnamentData>>::Entry> entries;
+    entries.reserve(batch.size());
+    for (const auto& data : batch) {
+        entries.emplace_back(data.date, std::make_unique<OrnamentData>(data));
+    }
     
-    // Return the index
-    return static_cast<int>(std::distance(ornamentData.begin(), pos));
+    ornamentData.insertAll(std::move(entries));
+}
+
+int OrnamentationMap::insertOrnamentData(double date, std::unique_ptr<OrnamentData> data) {
+    // Insert the new element, this keeps the timeline sorted by date, and return its index
+    return static_cast<int>(ornamentData.insert(date, std::move(data)));
 }
 
 OrnamentData* OrnamentationMap::getOrnamentDataAt(double date) const {
@@ -76,80 +115,92 @@ bool OrnamentationMap::isEmpty() const {
 }
 
 int OrnamentationMap::getElementIndexBeforeAt(double date) const {
-    for (int i = static_cast<int>(ornamentData.size()) - 1; i >= 0; --i) {
-        if (ornamentData[i].getKey() <= date) {
-            return i;
-        }
-    }
-    return -1;
+    return ornamentData.indexBeforeAt(date);
+}
+
+bool OrnamentationMap::applyToNoteTable(msm::NoteTable& notes) {
+    Report report;
+    return applyToNoteTable(notes, report);
 }
 
-bool OrnamentationMap::applyToMsmPart(Element msmPart) {
-    if (!msmPart || ornamentData.empty()) {
+bool OrnamentationMap::applyToNoteTable(msm::NoteTable& notes, Report& report) const {
+    report = Report();
+    if (notes.isEmpty() || ornamentData.empty()) {
         return false;
     }
     
-    bool modified = false;
-    
-    // Find all note elements in the part
-    auto scoreElement = xml::Helper::getFirstChildElement(msmPart, "dated");
-    if (scoreElement) {
-        scoreElement = xml::Helper::getFirstChildElement(scoreElement, "score");
-        if (scoreElement) {
-            // Process each ornament in the map
-            for (const auto& ornamentEntry : ornamentData) {
-                double ornamentDate = ornamentEntry.getKey();
-                const OrnamentData* ornament = ornamentEntry.getValue().get();
-                
-                // Find notes at this date
-                for (auto note : scoreElement.children("note")) {
-                    auto dateAttr = note.attribute("date");
-                    if (dateAttr) {
-                        double noteDate = xml::Helper::parseDouble(dateAttr.value());
-                        
-                        // Apply ornament if note is at the ornament date
-                        if (std::abs(noteDate - ornamentDate) < 1e-6) { // floating point comparison
-                            if (applyOrnamentToNote(note, *ornament)) {
-                                modified = true;
-                            }
-                        }
-                    }
-                }
+    // Single sweep over the notes in date order; notes within the date tolerance are grouped into chords and
+    // each chord is matched against the ornaments at its date, a cursor walks the ornament timeline once
+    std::vector<size_t> rows = notes.getRowsInDateOrder();
+    std::vector<size_t> chord;
+    size_t cursor = 0;
+    for (size_t i = 0; i < rows.size(); ) {
+        if (!notes.hasFlag(rows[i], msm::NoteTable::HAS_DATE)) {
+            ++i;
+            continue;
+        }
+        
+        double chordDate = notes.getDate(rows[i]);
+        chord.clear();
+        for (; (i < rows.size()) && (notes.getDate(rows[i]) - chordDate < DATE_TOLERANCE); ++i) {
+            if (notes.hasFlag(rows[i], msm::NoteTable::HAS_DATE)) {
+                chord.push_back(rows[i]);
+            }
+        }
+        
+        bool chordOrnamented = false;
+        ornamentData.seekBeforeAt(chordDate - DATE_TOLERANCE, cursor);
+        for (size_t j = cursor; (j < ornamentData.size()) && (ornamentData.getDate(j) < chordDate + DATE_TOLERANCE); ++j) {
+            if (std::abs(ornamentData.getDate(j) - chordDate) >= DATE_TOLERANCE) {
+                continue;
             }
+            applyOrnamentToChord(notes, chord, *ornamentData[j].getValue(), report);
+            ++report.ornaments;
+            chordOrnamented = true;
+        }
+        if (chordOrnamented) {
+            ++report.chords;
+            report.notes += chord.size();
         }
     }
     
-    return modified;
+    return report.modified;
 }
 
-bool OrnamentationMap::applyOrnamentToNote(Element note, const OrnamentData& ornamentData) {
-    bool modified = false;
-    
-    // Add ornament attributes to the note
+void OrnamentationMap::applyOrnamentToChord(msm::NoteTable& notes, const std::vector<size_t>& chord, const OrnamentData& ornamentData, Report& report) {
+    // Add ornament attributes to the notes; the values are the same for all notes of the chord
     // For now, we'll add basic ornament markers
     
-    // Add ornament.type attribute
-    if (!ornamentData.ornamentDefName.empty()) {
-        note.append_attribute("ornament.type") = ornamentData.ornamentDefName.c_str();
-        modified = true;
+    // ornament.type attribute
+    bool hasType = !ornamentData.ornamentDefName.empty();
+    
+    // ornament.scale attribute if not default
+    bool hasScale = (ornamentData.scale != 0.0) && (ornamentData.scale != 1.0);
+    std::string scaleStr = hasScale ? xml::NumberCodec::toString(ornamentData.scale) : std::string();
+    
+    // ornament.note.order attribute if specified
+    std::string noteOrderStr;
+    for (size_t i = 0; i < ornamentData.noteOrder.size(); ++i) {
+        if (i > 0) noteOrderStr += " ";
+        noteOrderStr += ornamentData.noteOrder[i];
     }
     
-    // Add ornament.scale attribute if not default
-    if (ornamentData.scale != 0.0 && ornamentData.scale != 1.0) {
-        note.append_attribute("ornament.scale") = std::to_string(ornamentData.scale).c_str();
-        modified = true;
+    if (!hasType && !hasScale && noteOrderStr.empty()) {
+        return;
     }
     
-    // Add ornament.note.order attribute if specified
-    if (!ornamentData.noteOrder.empty()) {
-        std::string noteOrderStr;
-        for (size_t i = 0; i < ornamentData.noteOrder.size(); ++i) {
-            if (i > 0) noteOrderStr += " ";
-            noteOrderStr += ornamentData.noteOrder[i];
+    for (size_t row : chord) {
+        if (hasType) {
+            notes.addAttribute(row, "ornament.type", ornamentData.ornamentDefName);
+        }
+        if (hasScale) {
+            notes.addAttribute(row, "ornament.scale", scaleStr);
+        }
+        if (!ornamentData.noteOrder.empty()) {
+            notes.addAttribute(row, "ornament.note.order", noteOrderStr);
         }
-        note.append_attribute("ornament.note.order") = noteOrderStr.c_str();
-        modified = true;
     }
+    report.modified = true;
     
     // TODO: Apply more sophisticated ornament transformations
     // This would involve:
@@ -157,11 +208,6 @@ bool OrnamentationMap::applyOrnamentToNote(Element note, const OrnamentData& orn
     // 2. Applying dynamics gradients 
     // 3. Applying temporal spreads
     // 4. Adding new notes if required
-    
-    std::cout << "Applied ornament '" << ornamentData.ornamentDefName 
-              << "' to note at date " << ornamentData.date << std::endl;
-    
-    return modified;
 }
 
 } // namespace mpm
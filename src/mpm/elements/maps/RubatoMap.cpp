@@ -1,5 +1,7 @@
 #include "mpm/elements/maps/RubatoMap.h"
+#include "msm/NoteTable.h"
 #include "xml/Helper.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -15,6 +17,12 @@ std::unique_ptr<RubatoMap> RubatoMap::createRubatoMap() {
     return std::make_unique<RubatoMap>();
 }
 
+std::unique_ptr<RubatoMap> RubatoMap::createRubatoMap(const Element& xml) {
+    auto map = std::make_unique<RubatoMap>();
+    map->parseData(xml);
+    return map;
+}
+
 int RubatoMap::addRubato(double date, double frameLength, double intensity, 
                          double lateStart, double earlyEnd, bool loop, const std::string& id) {
     // Create RubatoData object
@@ -44,6 +52,34 @@ int RubatoMap::addRubato(double date, const std::string& rubatoDefName, bool loo
 }
 
 int RubatoMap::addRubato(const RubatoData& data) {
+    // Insert the new element (maintaining sorted order by date)
+    int index = static_cast<int>(rubatoData.insert(data.startDate, prepareRubatoData(data)));
+    
+    // Update end dates for affected elements, these are the new element and its predecessor
+    rubatoData[index].getValue()->endDate = getEndDate(index);
+    if (index > 0) {
+        rubatoData[index - 1].getValue()->endDate = data.startDate;
+    }
+    
+    return index;
+}
+
+void RubatoMap::addRubato(const std::vector<RubatoData>& batch) {
+    std::vector<supplementary::Timeline<std::unique_ptr<RubatoData>>::Entry> entries;
+    entries.reserve(batch.size());
+    for (const auto& data : batch) {
+        entries.emplace_back(data.startDate, prepareRubatoData(data));
+    }
+    
+    rubatoData.insertAll(std::move(entries));
+    
+    // Update end dates in one pass
+    for (int i = 0; i < static_cast<int>(rubatoData.size()); ++i) {
+        rubatoData[i].getValue()->endDate = getEndDate(i);
+    }
+}
+
+std::unique_ptr<RubatoData> RubatoMap::prepareRubatoData(const RubatoData& data) {
     // Create a copy of the data
     auto rubatoDataCopy = std::make_unique<RubatoData>(data);
     
@@ -53,28 +89,12 @@ int RubatoMap::addRubato(const RubatoData& data) {
     rubatoDataCopy->lateStart = correctedBounds.first;
     rubatoDataCopy->earlyEnd = correctedBounds.second;
     
-    // Find the correct position to insert (maintaining sorted order by date)
-    auto insertPos = std::lower_bound(rubatoData.begin(), rubatoData.end(), data.startDate,
-        [](const supplementary::KeyValue<double, std::unique_ptr<RubatoData>>& kv, double date) {
-            return kv.getKey() < date;
-        });
-    
-    // Insert the new element
-    auto keyValue = supplementary::KeyValue<double, std::unique_ptr<RubatoData>>(data.startDate, std::move(rubatoDataCopy));
-    auto it = rubatoData.insert(insertPos, std::move(keyValue));
-    
-    // Update end dates for affected elements
-    int index = std::distance(rubatoData.begin(), it);
-    for (int i = 0; i < static_cast<int>(rubatoData.size()); ++i) {
-        rubatoData[i].getValue()->endDate = getEndDate(i);
-    }
-    
-    return index;
+    return rubatoDataCopy;
 }
 
 RubatoData* RubatoMap::getRubatoDataAt(double date) {
     // Find the rubato data that applies to this date
-    for (int i = static_cast<int>(rubatoData.size()) - 1; i >= 0; --i) {
+    for (int i = rubatoData.indexBeforeAt(date); i >= 0; --i) {
         RubatoData* rd = getRubatoDataOf(i);
         if (rd && rd->startDate <= date) {
             // Check if this rubato applies to the date
@@ -163,66 +183,90 @@ double RubatoMap::getEndDate(int index) {
     return std::numeric_limits<double>::max();
 }
 
-bool RubatoMap::applyToMsmPart(Element msmPart) {
-    if (!msmPart || rubatoData.empty()) {
+bool RubatoMap::applyToNoteTable(msm::NoteTable& notes) {
+    if (notes.isEmpty() || rubatoData.empty()) {
         return false;
     }
     
     bool modified = false;
     
-    // Find all note elements in the part - try both direct dated and header/dated paths
-    Element scoreElement;
-    
-    // First try: part -> dated -> score (for some MSM structures)
-    scoreElement = xml::Helper::getFirstChildElement(msmPart, "dated");
-    if (scoreElement) {
-        scoreElement = xml::Helper::getFirstChildElement(scoreElement, "score");
+    // Process all notes to apply rubato timing transformations
+    for (size_t row = 0; row < notes.size(); ++row) {
+        if (!notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+            continue;
+        }
+        
+        double originalDate = notes.getDate(row);
+        
+        // Find applicable rubato data for this note
+        auto rubatoDataPtr = getRubatoDataAt(originalDate);
+        if (rubatoDataPtr) {
+            // Update the date with the rubato transformation
+            notes.setDate(row, computeRubatoTransformation(originalDate, *rubatoDataPtr));
+            modified = true;
+        }
     }
     
-    // If not found, try: part -> header -> dated -> score (for Bach MSM structure)
-    if (!scoreElement) {
-        auto headerElement = xml::Helper::getFirstChildElement(msmPart, "header");
-        if (headerElement) {
-            auto datedElement = xml::Helper::getFirstChildElement(headerElement, "dated");
-            if (datedElement) {
-                scoreElement = xml::Helper::getFirstChildElement(datedElement, "score");
-            }
-        }
+    return modified;
+}
+
+bool RubatoMap::supportsNoteSweep() const {
+    return true;
+}
+
+bool RubatoMap::applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) {
+    if (rubatoData.empty() || !notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+        return false;
     }
     
-    if (scoreElement) {
-        // Process all notes to apply rubato timing transformations
-        for (auto note : scoreElement.children("note")) {
-            auto dateAttr = note.attribute("date");
-            if (dateAttr) {
-                double originalDate = xml::Helper::parseDouble(dateAttr.value());
-                
-                // Find applicable rubato data for this note
-                auto rubatoDataPtr = getRubatoDataAt(originalDate);
-                if (rubatoDataPtr) {
-                    double transformedDate = computeRubatoTransformation(originalDate, *rubatoDataPtr);
-                    
-                    // Update the date attribute with the rubato transformation
-                    dateAttr.set_value(std::to_string(transformedDate).c_str());
-                    modified = true;
-                }
-            }
+    double date = notes.getDate(row);
+    
+    // The same search as getRubatoDataAt(), but it starts at the cursor instead of the end of the map
+    for (int i = rubatoData.seekBeforeAt(date, cursor); i >= 0; --i) {
+        RubatoData* rd = getRubatoDataOf(i);
+        if (rd && (rd->startDate <= date) && (rd->loop || (date < rd->startDate + rd->frameLength))) {
+            notes.setDate(row, computeRubatoTransformation(date, *rd));
+            return true;
         }
     }
     
-    return modified;
+    return false;
+}
+
+void RubatoMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt32(static_cast<uint32_t>(rubatoData.size()));
+    for (const auto& entry : rubatoData) {
+        entry.getValue()->writeToCache(writer);
+    }
+}
+
+bool RubatoMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<supplementary::Timeline<std::unique_ptr<RubatoData>>::Entry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; (i < count) && reader.good(); ++i) {
+        auto data = std::make_unique<RubatoData>();
+        data->readFromCache(reader);
+        double date = data->startDate;
+        entries.emplace_back(date, std::move(data));
+    }
+    rubatoData.insertAll(std::move(entries));
+    return reader.good();
 }
 
 void RubatoMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
     // Parse rubato elements from XML
-    for (auto child = xmlElement.first_child(); child; child = child.next_sibling()) {
-        if (std::string(child.name()) == "rubato") {
-            RubatoData data(child);
-            addRubato(data);
-        }
+    std::vector<RubatoData> batch;
+    for (auto child : xmlElement.children("rubato")) {
+        batch.emplace_back(child);
     }
+    addRubato(batch);
 }
 
 }  // namespace mpm
@@ -1,6 +1,9 @@
 #include "mpm/elements/maps/TempoMap.h"
+#include "msm/NoteTable.h"
 #include "mpm/Mpm.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -16,6 +19,12 @@ std::unique_ptr<TempoMap> TempoMap::createTempoMap() {
     return std::make_unique<TempoMap>();
 }
 
+std::unique_ptr<TempoMap> TempoMap::createTempoMap(const Element& xml) {
+    auto map = std::make_unique<TempoMap>();
+    map->parseData(xml);
+    return map;
+}
+
 int TempoMap::addTempo(double date, const std::string& bpm, const std::string& transitionTo, 
                        double beatLength, double meanTempoAt, const std::string& id) {
     auto data = std::make_unique<TempoData>();
@@ -26,19 +35,11 @@ int TempoMap::addTempo(double date, const std::string& bpm, const std::string& t
     data->meanTempoAt = meanTempoAt;
     data->xmlId = id;
     
-    // Try to parse numeric values
-    try {
-        data->bpm = std::stod(bpm);
-    } catch (const std::invalid_argument&) {
-        // Keep as string
-    }
+    // Try to parse numeric values, otherwise keep them as string
+    xml::NumberCodec::tryParse(bpm, data->bpm);
     
     if (!transitionTo.empty()) {
-        try {
-            data->transitionTo = std::stod(transitionTo);
-        } catch (const std::invalid_argument&) {
-            // Keep as string
-        }
+        xml::NumberCodec::tryParse(transitionTo, data->transitionTo);
     }
     
     return addTempo(std::move(data));
@@ -64,18 +65,29 @@ int TempoMap::addTempo(std::unique_ptr<TempoData> data) {
         return -1;
     }
     
-    // Find insertion point
-    auto insertPos = std::lower_bound(tempoData.begin(), tempoData.end(), data->startDate,
-        [](const supplementary::KeyValue<double, std::unique_ptr<TempoData>>& kv, double date) {
-            return kv.getKey() < date;
-        });
-    
-    int index = static_cast<int>(std::distance(tempoData.begin(), insertPos));
-    
-    supplementary::KeyValue<double, std::unique_ptr<TempoData>> kv(data->startDate, std::move(data));
-    tempoData.insert(insertPos, std::move(kv));
+    double date = data->startDate;
+    timingPpq = 0;
+    return static_cast<int>(tempoData.insert(date, std::move(data)));
+}
+
+void TempoMap::addTempo(std::vector<std::unique_ptr<TempoData>> batch) {
+    std::vector<supplementary::Timeline<std::unique_ptr<TempoData>>::Entry> entries;
+    entries.reserve(batch.size());
+    for (auto& data : batch) {
+        if (!data) {
+            std::cerr << "Cannot add null tempo data" << std::endl;
+            continue;
+        }
+        if (data->bpm == 0.0 && data->bpmString.empty()) {
+            std::cerr << "Cannot add tempo, bpm not specified." << std::endl;
+            continue;
+        }
+        double date = data->startDate;
+        entries.emplace_back(date, std::move(data));
+    }
     
-    return index;
+    timingPpq = 0;
+    tempoData.insertAll(std::move(entries));
 }
 
 TempoData* TempoMap::getTempoDataAt(double date) const {
@@ -96,8 +108,11 @@ TempoData* TempoMap::getTempoDataOf(int index) const {
     
     TempoData* data = tempoData[index].getValue().get();
     if (data) {
-        // Update end date
-        data->endDate = getEndDate(index);
+        // Update end date; it is only written if it changed, so concurrent reads of prepared maps do not conflict
+        double endDate = getEndDate(index);
+        if (data->endDate != endDate) {
+            data->endDate = endDate;
+        }
     }
     
     return data;
@@ -152,7 +167,7 @@ void TempoMap::renderTempoToMap(GenericMap& map, int ppq, TempoMap* tempoMap) {
     std::cout << "No tempo map provided, using default timing" << std::endl;
 }
 
-double TempoMap::computeDiffTiming(double date, int ppq, const TempoData* tempoData) {
+double TempoMap::computeDiffTiming(double date, int ppq, const TempoData* tempoData, Integration integration) {
     // No tempo data
     if (tempoData == nullptr) {
         return computeMillisecondsForNoTempo(date, ppq);
@@ -164,74 +179,199 @@ double TempoMap::computeDiffTiming(double date, int ppq, const TempoData* tempoD
     }
     
     // Continuous tempo transition
-    return computeMillisecondsForTempoTransition(date, ppq, tempoData);
+    return computeMillisecondsForTempoTransition(date, ppq, tempoData, integration);
 }
 
-bool TempoMap::applyToMsmPart(Element msmPart) {
-    if (!msmPart || tempoData.empty()) {
-        return false;
+TempoMap::Integration TempoMap::getIntegration() const {
+    return integration;
+}
+
+void TempoMap::setIntegration(Integration integration) {
+    this->integration = integration;
+    timingPpq = 0;
+}
+
+void TempoMap::compileTiming(int ppq) const {
+    timing.clear();
+    
+    for (int tempoIndex = 0; tempoIndex < static_cast<int>(tempoData.size()); ++tempoIndex) {
+        TempoData* td = getTempoDataOf(tempoIndex);
+        if (td == nullptr) {
+            continue;
+        }
+        
+        // the milliseconds date of a tempo instruction is computed on the basis of the previous one
+        if (timing.empty()) {
+            td->startDateMilliseconds = computeDiffTiming(td->startDate, ppq, nullptr, integration);
+        } else {
+            const TimingSegment& previous = timing.back();
+            td->startDateMilliseconds = computeDiffTiming(td->startDate, ppq, previous.data, integration) + previous.startMilliseconds;
+        }
+        timing.push_back({td->startDate, td->startDateMilliseconds, td});
     }
     
-    bool modified = false;
+    timingPpq = ppq;
+}
+
+double TempoMap::getMillisecondsAt(double date, int ppq) const {
+    if (timingPpq != ppq) {
+        compileTiming(ppq);
+    }
+    
+    // before or at the first tempo instruction the default tempo applies
+    if (timing.empty() || (date <= timing[0].startDate)) {
+        return computeDiffTiming(date, ppq, nullptr, integration);
+    }
     
-    // Find all note elements in the part - try both direct dated and header/dated paths
-    Element scoreElement;
+    // the segment that the date falls into; a date at the start of a segment is still computed by the preceding segment
+    int next = supplementary::timeline::indexAtAfter(timing, date, [](const TimingSegment& segment) { return segment.startDate; });
+    const TimingSegment& segment = timing[(next < 0) ? (timing.size() - 1) : static_cast<size_t>(next - 1)];
+    return computeDiffTiming(date, ppq, segment.data, integration) + segment.startMilliseconds;
+}
+
+double TempoMap::getDateAtMilliseconds(double milliseconds, int ppq) const {
+    if (timingPpq != ppq) {
+        compileTiming(ppq);
+    }
     
-    // First try: part -> dated -> score (for some MSM structures)
-    scoreElement = xml::Helper::getFirstChildElement(msmPart, "dated");
-    if (scoreElement) {
-        scoreElement = xml::Helper::getFirstChildElement(scoreElement, "score");
+    // before or at the first tempo instruction the default tempo applies
+    if (timing.empty() || (milliseconds <= timing[0].startMilliseconds)) {
+        return (milliseconds * ppq) / 600.0;
     }
     
-    // If not found, try: part -> header -> dated -> score (for Bach MSM structure)
-    if (!scoreElement) {
-        auto headerElement = xml::Helper::getFirstChildElement(msmPart, "header");
-        if (headerElement) {
-            auto datedElement = xml::Helper::getFirstChildElement(headerElement, "dated");
-            if (datedElement) {
-                scoreElement = xml::Helper::getFirstChildElement(datedElement, "score");
-            }
+    // the last segment that starts before the milliseconds date
+    auto it = std::lower_bound(timing.begin(), timing.end(), milliseconds,
+        [](const TimingSegment& segment, double ms) { return segment.startMilliseconds < ms; });
+    const TimingSegment& segment = *(it - 1);
+    double diff = milliseconds - segment.startMilliseconds;
+    
+    if (segment.data->isConstantTempo()) {
+        return segment.data->startDate + (diff * segment.data->bpm * segment.data->beatLength * ppq) / 15000.0;
+    }
+    return solveTempoTransition(diff, ppq, segment.data, integration);
+}
+
+void TempoMap::renderTempoToNoteTable(msm::NoteTable& notes, const TempoMap* tempoMap) {
+    int ppq = notes.getPPQ();
+    
+    for (size_t row = 0; row < notes.size(); ++row) {
+        if (!notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+            continue;
+        }
+        
+        double date = notes.getDate(row);
+        double endDate = date + notes.getDuration(row);
+        if (tempoMap == nullptr) {                                  // if no tempoMap is given, 1 tick = 1 millisecond
+            notes.setMilliseconds(row, date, endDate - date);
+            continue;
         }
+        
+        double milliseconds = tempoMap->getMillisecondsAt(date, ppq);
+        notes.setMilliseconds(row, milliseconds, tempoMap->getMillisecondsAt(endDate, ppq) - milliseconds);
     }
+}
+
+bool TempoMap::applyToNoteTable(msm::NoteTable& notes) {
+    if (notes.isEmpty() || tempoData.empty()) {
+        return false;
+    }
+    
+    bool modified = false;
     
-    if (scoreElement) {
-        // Process all notes to add timing-related attributes
-        for (auto note : scoreElement.children("note")) {
-            auto dateAttr = note.attribute("date");
-            if (dateAttr) {
-                double noteDate = xml::Helper::parseDouble(dateAttr.value());
-                double currentTempo = getTempoAt(noteDate);
-                
-                // Add tempo information as an attribute for downstream processing
-                note.append_attribute("tempo") = std::to_string(currentTempo).c_str();
-                modified = true;
-            }
+    // Process all notes to add timing-related attributes
+    for (size_t row = 0; row < notes.size(); ++row) {
+        if (notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+            // Add tempo information for downstream processing
+            notes.setTempo(row, getTempoAt(notes.getDate(row)));
+            modified = true;
         }
     }
     
     return modified;
 }
 
+bool TempoMap::supportsNoteSweep() const {
+    return true;
+}
+
+bool TempoMap::applyToNote(msm::NoteTable& notes, size_t row, size_t& cursor) {
+    if (tempoData.empty() || !notes.hasFlag(row, msm::NoteTable::HAS_DATE)) {
+        return false;
+    }
+    
+    double date = notes.getDate(row);
+    TempoData* td = nullptr;
+    for (int i = tempoData.seekBeforeAt(date, cursor); (i >= 0) && (td == nullptr); --i) {
+        td = getTempoDataOf(i);
+    }
+    
+    notes.setTempo(row, getTempoAt(date, td));
+    return true;
+}
+
+void TempoMap::prepareForRendering(int ppq) {
+    if (timingPpq != ppq) {    // the timing is invalidated by any change, so a timing restored from a cache is kept
+        compileTiming(ppq);    // this sets the end dates, too
+    }
+}
+
+void TempoMap::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeUInt8(static_cast<uint8_t>(integration));
+    writer.writeInt32(timingPpq);     // the milliseconds dates of the entries are valid for this ppq
+    writer.writeUInt32(static_cast<uint32_t>(tempoData.size()));
+    for (const auto& entry : tempoData) {
+        entry.getValue()->writeToCache(writer);
+    }
+}
+
+bool TempoMap::readFromCache(supplementary::BinaryReader& reader) {
+    uint8_t integrationValue = reader.readUInt8();
+    if (integrationValue > static_cast<uint8_t>(Integration::GAUSS_LEGENDRE)) {
+        return false;
+    }
+    integration = static_cast<Integration>(integrationValue);
+    int ppq = reader.readInt32();
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining()) {                // each entry takes at least one byte
+        return false;
+    }
+
+    std::vector<supplementary::Timeline<std::unique_ptr<TempoData>>::Entry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; (i < count) && reader.good(); ++i) {
+        auto data = std::make_unique<TempoData>();
+        data->readFromCache(reader);
+        double date = data->startDate;
+        entries.emplace_back(date, std::move(data));
+    }
+    tempoData.insertAll(std::move(entries));
+
+    // the compiled timing consists of the entries and their milliseconds dates, no integration is needed
+    timing.clear();
+    if (ppq != 0) {
+        for (const auto& entry : tempoData) {
+            const TempoData* td = entry.getValue().get();
+            timing.push_back({td->startDate, td->startDateMilliseconds, td});
+        }
+    }
+    timingPpq = ppq;
+    return reader.good();
+}
+
 void TempoMap::parseData(const Element& xmlElement) {
     GenericMap::parseData(xmlElement);
     
     // Parse tempo elements from XML
-    std::vector<Element> tempoElements = xml::Helper::getChildElements(xmlElement, "tempo");
-    
-    for (const Element& tempoElement : tempoElements) {
-        auto data = std::make_unique<TempoData>(tempoElement);
-        addTempo(std::move(data));
+    std::vector<std::unique_ptr<TempoData>> batch;
+    for (auto tempoElement : xmlElement.children("tempo")) {
+        batch.push_back(std::make_unique<TempoData>(tempoElement));
     }
+    addTempo(std::move(batch));
 }
 
 int TempoMap::getElementIndexBeforeAt(double date) const {
     // Find the index of the last tempo element that starts at or before the given date
-    for (int i = static_cast<int>(tempoData.size()) - 1; i >= 0; --i) {
-        if (tempoData[i].getKey() <= date) {
-            return i;
-        }
-    }
-    return -1;
+    return tempoData.indexBeforeAt(date);
 }
 
 double TempoMap::getEndDate(int index) const {
@@ -259,7 +399,118 @@ double TempoMap::computeMillisecondsForConstantTempo(double date, int ppq, const
     return ((15000.0 * (date - tempoData->startDate)) / (tempoData->bpm * tempoData->beatLength * ppq));
 }
 
-double TempoMap::computeMillisecondsForTempoTransition(double date, int ppq, const TempoData* tempoData) {
+double TempoMap::solveTempoTransition(double milliseconds, int ppq, const TempoData* tempoData, Integration integration) {
+    // the tempo lies between bpm and transitionTo, this brackets the date
+    double scale = 15000.0 / (tempoData->beatLength * ppq);        // milliseconds per tick at 1 bpm
+    double minTempo = std::min(tempoData->bpm, tempoData->transitionTo);
+    double maxTempo = std::max(tempoData->bpm, tempoData->transitionTo);
+    double low = tempoData->startDate + (milliseconds * minTempo) / scale;
+    double high = std::min(tempoData->endDate, tempoData->startDate + (milliseconds * maxTempo) / scale);
+    if (high <= low) {
+        return low;
+    }
+    
+    // Newton's method, the derivative of the milliseconds date is scale / tempo; steps that leave the bracket are replaced by bisection
+    double date = 0.5 * (low + high);
+    for (int i = 0; i < 64; ++i) {
+        double error = computeMillisecondsForTempoTransition(date, ppq, tempoData, integration) - milliseconds;
+        if (std::abs(error) < 1e-9) {
+            break;
+        }
+        if (error > 0.0) {
+            high = date;
+        } else {
+            low = date;
+        }
+        
+        double next = date - (error * getTempoAt(date, tempoData)) / scale;
+        date = ((next > low) && (next < high)) ? next : 0.5 * (low + high);
+        if ((high - low) < 1e-9) {
+            break;
+        }
+    }
+    
+    return date;
+}
+
+double TempoMap::computeMillisecondsForTempoTransition(double date, int ppq, const TempoData* tempoData, Integration integration) {
+    if (integration == Integration::SIMPSON) {
+        return computeMillisecondsForTempoTransitionSimpson(date, ppq, tempoData);
+    }
+    
+    double errorEstimate;
+    return integrateTempoTransition(date, ppq, tempoData, errorEstimate);
+}
+
+double TempoMap::integrateTempoTransition(double date, int ppq, const TempoData* tempoData, double& errorEstimate) {
+    // 15 point Gauss-Kronrod rule on [-1, 1], the odd nodes are those of the 7 point Gauss-Legendre rule
+    static const double nodes[8] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.0};
+    static const double kronrodWeights[8] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+    static const double gaussWeights[4] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+    
+    errorEstimate = 0.0;
+    double length = date - tempoData->startDate;
+    if (length <= 0.0) {
+        return 0.0;
+    }
+    
+    // the milliseconds are the integral of 1/tempo over the ticks, scaled to the beat length and ppq
+    double scale = 15000.0 / (tempoData->beatLength * ppq);
+    double bpm = tempoData->bpm;
+    double delta = tempoData->transitionTo - bpm;
+    double position = length / (tempoData->endDate - tempoData->startDate);  // relative position of date in the transition
+    
+    double exponent = tempoData->exponent;
+    if (exponent == 0.0) {
+        exponent = (tempoData->meanTempoAt == 0.0) ? 1.0 : computeExponent(tempoData->meanTempoAt);
+    }
+    
+    // linear transition, the integral has a closed form
+    if (exponent == 1.0) {
+        if (delta == 0.0) {
+            return scale * length / bpm;
+        }
+        return scale * ((tempoData->endDate - tempoData->startDate) / delta) * std::log1p((delta * position) / bpm);
+    }
+    
+    // tempo(s) = bpm + delta * (position * s)^exponent for s in [0, 1]; with s = w^m the integrand
+    // m w^(m-1) / (bpm + c w^(m exponent)) is smooth at 0, which is what the quadrature relies on
+    double m = std::min(64.0, std::max(1.0, std::ceil(3.0 / exponent)));
+    double c = delta * std::pow(position, exponent);
+    auto integrand = [bpm, c, m, exponent](double w) {
+        return (m * std::pow(w, m - 1.0)) / (bpm + c * std::pow(w, m * exponent));
+    };
+    
+    // map [-1, 1] to [0, 1]
+    double center = integrand(0.5);
+    double kronrod = kronrodWeights[7] * center;
+    double gauss = gaussWeights[3] * center;
+    for (int i = 0; i < 7; ++i) {
+        double offset = 0.5 * nodes[i];
+        double sum = integrand(0.5 - offset) + integrand(0.5 + offset);
+        kronrod += kronrodWeights[i] * sum;
+        if (i % 2 == 1) {
+            gauss += gaussWeights[i / 2] * sum;
+        }
+    }
+    kronrod *= 0.5;
+    gauss *= 0.5;
+    
+    errorEstimate = scale * length * std::abs(kronrod - gauss);
+    return scale * length * kronrod;
+}
+
+double TempoMap::computeMillisecondsForTempoTransitionSimpson(double date, int ppq, const TempoData* tempoData) {
     // Simpson's rule for numerical integration
     // The number of iterations of the Simpson's rule = N/2; 16th precision; N must be even!
     double N = 2.0 * static_cast<long>((date - tempoData->startDate) / (static_cast<double>(ppq) / 4));
@@ -1,5 +1,7 @@
 #include "mpm/elements/maps/data/ArticulationData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 
 namespace meico {
@@ -11,7 +13,7 @@ ArticulationData::ArticulationData() {
 
 ArticulationData::ArticulationData(const Element& xmlElement) {
     xml = xmlElement;
-    date = xml::Helper::parseDouble(xmlElement.attribute("date").value());
+    date = xml::NumberCodec::parseDouble(xmlElement.attribute("date").value());
 
     auto nameRef = xmlElement.attribute("name.ref");
     if (nameRef) {
@@ -25,62 +27,62 @@ ArticulationData::ArticulationData(const Element& xmlElement) {
 
     auto absoluteDurationAttr = xmlElement.attribute("absoluteDuration");
     if (absoluteDurationAttr) {
-        absoluteDuration = std::make_shared<double>(xml::Helper::parseDouble(absoluteDurationAttr.value()));
+        absoluteDuration = std::make_shared<double>(xml::NumberCodec::parseDouble(absoluteDurationAttr.value()));
     }
 
     auto absoluteDurationChangeAttr = xmlElement.attribute("absoluteDurationChange");
     if (absoluteDurationChangeAttr) {
-        absoluteDurationChange = xml::Helper::parseDouble(absoluteDurationChangeAttr.value());
+        absoluteDurationChange = xml::NumberCodec::parseDouble(absoluteDurationChangeAttr.value());
     }
 
     auto absoluteDurationMsAttr = xmlElement.attribute("absoluteDurationMs");
     if (absoluteDurationMsAttr) {
-        absoluteDurationMs = std::make_shared<double>(xml::Helper::parseDouble(absoluteDurationMsAttr.value()));
+        absoluteDurationMs = std::make_shared<double>(xml::NumberCodec::parseDouble(absoluteDurationMsAttr.value()));
     }
 
     auto absoluteDurationChangeMsAttr = xmlElement.attribute("absoluteDurationChangeMs");
     if (absoluteDurationChangeMsAttr) {
-        absoluteDurationChangeMs = xml::Helper::parseDouble(absoluteDurationChangeMsAttr.value());
+        absoluteDurationChangeMs = xml::NumberCodec::parseDouble(absoluteDurationChangeMsAttr.value());
     }
 
     auto relativeDurationAttr = xmlElement.attribute("relativeDuration");
     if (relativeDurationAttr) {
-        relativeDuration = xml::Helper::parseDouble(relativeDurationAttr.value());
+        relativeDuration = xml::NumberCodec::parseDouble(relativeDurationAttr.value());
     }
 
     auto absoluteDelayAttr = xmlElement.attribute("absoluteDelay");
     if (absoluteDelayAttr) {
-        absoluteDelay = xml::Helper::parseDouble(absoluteDelayAttr.value());
+        absoluteDelay = xml::NumberCodec::parseDouble(absoluteDelayAttr.value());
     }
 
     auto absoluteDelayMsAttr = xmlElement.attribute("absoluteDelayMs");
     if (absoluteDelayMsAttr) {
-        absoluteDelayMs = xml::Helper::parseDouble(absoluteDelayMsAttr.value());
+        absoluteDelayMs = xml::NumberCodec::parseDouble(absoluteDelayMsAttr.value());
     }
 
     auto absoluteVelocityAttr = xmlElement.attribute("absoluteVelocity");
     if (absoluteVelocityAttr) {
-        absoluteVelocity = std::make_shared<double>(xml::Helper::parseDouble(absoluteVelocityAttr.value()));
+        absoluteVelocity = std::make_shared<double>(xml::NumberCodec::parseDouble(absoluteVelocityAttr.value()));
     }
 
     auto absoluteVelocityChangeAttr = xmlElement.attribute("absoluteVelocityChange");
     if (absoluteVelocityChangeAttr) {
-        absoluteVelocityChange = xml::Helper::parseDouble(absoluteVelocityChangeAttr.value());
+        absoluteVelocityChange = xml::NumberCodec::parseDouble(absoluteVelocityChangeAttr.value());
     }
 
     auto relativeVelocityAttr = xmlElement.attribute("relativeVelocity");
     if (relativeVelocityAttr) {
-        relativeVelocity = xml::Helper::parseDouble(relativeVelocityAttr.value());
+        relativeVelocity = xml::NumberCodec::parseDouble(relativeVelocityAttr.value());
     }
 
     auto detuneCentsAttr = xmlElement.attribute("detuneCents");
     if (detuneCentsAttr) {
-        detuneCents = xml::Helper::parseDouble(detuneCentsAttr.value());
+        detuneCents = xml::NumberCodec::parseDouble(detuneCentsAttr.value());
     }
 
     auto detuneHzAttr = xmlElement.attribute("detuneHz");
     if (detuneHzAttr) {
-        detuneHz = xml::Helper::parseDouble(detuneHzAttr.value());
+        detuneHz = xml::NumberCodec::parseDouble(detuneHzAttr.value());
     }
 
     auto id = xmlElement.attribute("xml:id");
@@ -136,29 +138,29 @@ bool ArticulationData::articulateNote(Element& note) const {
     auto dateAtt = note.attribute("date.perf");
     if (dateAtt) {
         if (absoluteDelay != 0.0) {
-            double currentDate = xml::Helper::parseDouble(dateAtt.value());
-            dateAtt.set_value(std::to_string(currentDate + absoluteDelay).c_str());
+            double currentDate = xml::NumberCodec::parseDouble(dateAtt.value());
+            xml::NumberCodec::setValue(dateAtt, currentDate + absoluteDelay);
             dateChanged = true;
         }
         if (absoluteDelayMs != 0.0) {
-            note.append_attribute("articulation.absoluteDelayMs") = std::to_string(absoluteDelayMs).c_str();
+            xml::NumberCodec::setValue(note.append_attribute("articulation.absoluteDelayMs"), absoluteDelayMs);
         }
     }
 
     // Apply duration modifiers
     auto durationAtt = note.attribute("duration.perf");
     if (durationAtt) {
-        double duration = xml::Helper::parseDouble(durationAtt.value());
+        double duration = xml::NumberCodec::parseDouble(durationAtt.value());
         
         if (absoluteDurationMs) {
-            note.append_attribute("articulation.absoluteDurationMs") = std::to_string(*absoluteDurationMs).c_str();
+            xml::NumberCodec::setValue(note.append_attribute("articulation.absoluteDurationMs"), *absoluteDurationMs);
         } else {
             // Apply symbolic duration changes only if no absolute milliseconds duration is specified
             if (absoluteDuration) {
-                durationAtt.set_value(std::to_string(*absoluteDuration).c_str());
+                xml::NumberCodec::setValue(durationAtt, *absoluteDuration);
             }
             if (relativeDuration != 1.0) {
-                durationAtt.set_value(std::to_string(duration * relativeDuration).c_str());
+                xml::NumberCodec::setValue(durationAtt, duration * relativeDuration);
             }
             if (absoluteDurationChange != 0.0) {
                 double durNew = duration + absoluteDurationChange;
@@ -166,12 +168,12 @@ bool ArticulationData::articulateNote(Element& note) const {
                 for (double reduce = 2.0; durNew <= 0.0; reduce *= 2.0) {
                     durNew = duration + (absoluteDurationChange / reduce);
                 }
-                durationAtt.set_value(std::to_string(durNew).c_str());
+                xml::NumberCodec::setValue(durationAtt, durNew);
             }
         }
         
         if (absoluteDurationChangeMs != 0.0) {
-            note.append_attribute("articulation.absoluteDurationChangeMs") = std::to_string(absoluteDurationChangeMs).c_str();
+            xml::NumberCodec::setValue(note.append_attribute("articulation.absoluteDurationChangeMs"), absoluteDurationChangeMs);
         }
     }
 
@@ -179,28 +181,70 @@ bool ArticulationData::articulateNote(Element& note) const {
     auto velocityAtt = note.attribute("velocity");
     if (velocityAtt) {
         if (absoluteVelocity) {
-            velocityAtt.set_value(std::to_string(*absoluteVelocity).c_str());
+            xml::NumberCodec::setValue(velocityAtt, *absoluteVelocity);
         }
         if (relativeVelocity != 1.0) {
-            double currentVelocity = xml::Helper::parseDouble(velocityAtt.value());
-            velocityAtt.set_value(std::to_string(currentVelocity * relativeVelocity).c_str());
+            double currentVelocity = xml::NumberCodec::parseDouble(velocityAtt.value());
+            xml::NumberCodec::setValue(velocityAtt, currentVelocity * relativeVelocity);
         }
         if (absoluteVelocityChange != 0.0) {
-            double currentVelocity = xml::Helper::parseDouble(velocityAtt.value());
-            velocityAtt.set_value(std::to_string(currentVelocity + absoluteVelocityChange).c_str());
+            double currentVelocity = xml::NumberCodec::parseDouble(velocityAtt.value());
+            xml::NumberCodec::setValue(velocityAtt, currentVelocity + absoluteVelocityChange);
         }
     }
 
     // Apply detuning
     if (detuneCents != 0.0) {
-        note.append_attribute("detuneCents") = std::to_string(detuneCents).c_str();
+        xml::NumberCodec::setValue(note.append_attribute("detuneCents"), detuneCents);
     }
     if (detuneHz != 0.0) {
-        note.append_attribute("detuneHz") = std::to_string(detuneHz).c_str();
+        xml::NumberCodec::setValue(note.append_attribute("detuneHz"), detuneHz);
     }
 
     return dateChanged;
 }
 
+void ArticulationData::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeString(xmlId);
+    writer.writeString(styleName);
+    writer.writeString(defaultArticulation);
+    writer.writeString(articulationDefName);
+    writer.writeDouble(date);
+    writer.writeString(noteid);
+    writer.writeOptional(absoluteDuration);
+    writer.writeDouble(absoluteDurationChange);
+    writer.writeOptional(absoluteDurationMs);
+    writer.writeDouble(absoluteDurationChangeMs);
+    writer.writeDouble(relativeDuration);
+    writer.writeDouble(absoluteDelay);
+    writer.writeDouble(absoluteDelayMs);
+    writer.writeOptional(absoluteVelocity);
+    writer.writeDouble(absoluteVelocityChange);
+    writer.writeDouble(relativeVelocity);
+    writer.writeDouble(detuneCents);
+    writer.writeDouble(detuneHz);
+}
+
+void ArticulationData::readFromCache(supplementary::BinaryReader& reader) {
+    xmlId = reader.readString();
+    styleName = reader.readString();
+    defaultArticulation = reader.readString();
+    articulationDefName = reader.readString();
+    date = reader.readDouble();
+    noteid = reader.readString();
+    absoluteDuration = reader.readOptional();
+    absoluteDurationChange = reader.readDouble();
+    absoluteDurationMs = reader.readOptional();
+    absoluteDurationChangeMs = reader.readDouble();
+    relativeDuration = reader.readDouble();
+    absoluteDelay = reader.readDouble();
+    absoluteDelayMs = reader.readDouble();
+    absoluteVelocity = reader.readOptional();
+    absoluteVelocityChange = reader.readDouble();
+    relativeVelocity = reader.readDouble();
+    detuneCents = reader.readDouble();
+    detuneHz = reader.readDouble();
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "mpm/elements/maps/data/DistributionData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
 #include <algorithm>
 #include <limits>
 
@@ -20,7 +21,7 @@ DistributionData::DistributionData(const Element& xml) : xml(xml) {
 
     std::string dateStr = xml::Helper::getAttributeValue(xml, "date");
     if (!dateStr.empty())
-        this->startDate = std::stod(dateStr);
+        this->startDate = xml::NumberCodec::parseDouble(dateStr, this->startDate);
 
     std::string xmlIdValue = xml::Helper::getAttributeValue(xml, "xml:id");
     if (!xmlIdValue.empty())
@@ -28,61 +29,61 @@ DistributionData::DistributionData(const Element& xml) : xml(xml) {
 
     std::string seedStr = xml::Helper::getAttributeValue(xml, "seed");
     if (!seedStr.empty()) {
-        this->seed = std::stol(seedStr);
+        this->seed = xml::NumberCodec::parseLong(seedStr, this->seed);
         this->hasSeed = true;
     }
 
     std::string lowerLimitStr = xml::Helper::getAttributeValue(xml, "limit.lower");
     if (!lowerLimitStr.empty()) {
-        this->lowerLimit = std::stod(lowerLimitStr);
+        this->lowerLimit = xml::NumberCodec::parseDouble(lowerLimitStr, this->lowerLimit);
         this->hasLowerLimit = true;
     }
 
     std::string upperLimitStr = xml::Helper::getAttributeValue(xml, "limit.upper");
     if (!upperLimitStr.empty()) {
-        this->upperLimit = std::stod(upperLimitStr);
+        this->upperLimit = xml::NumberCodec::parseDouble(upperLimitStr, this->upperLimit);
         this->hasUpperLimit = true;
     }
 
     std::string lowerClipStr = xml::Helper::getAttributeValue(xml, "clip.lower");
     if (!lowerClipStr.empty()) {
-        this->lowerClip = std::stod(lowerClipStr);
+        this->lowerClip = xml::NumberCodec::parseDouble(lowerClipStr, this->lowerClip);
         this->hasLowerClip = true;
     }
 
     std::string upperClipStr = xml::Helper::getAttributeValue(xml, "clip.upper");
     if (!upperClipStr.empty()) {
-        this->upperClip = std::stod(upperClipStr);
+        this->upperClip = xml::NumberCodec::parseDouble(upperClipStr, this->upperClip);
         this->hasUpperClip = true;
     }
 
     std::string modeStr = xml::Helper::getAttributeValue(xml, "mode");
     if (!modeStr.empty()) {
-        this->mode = std::stod(modeStr);
+        this->mode = xml::NumberCodec::parseDouble(modeStr, this->mode);
         this->hasMode = true;
     }
 
     std::string standardDeviationStr = xml::Helper::getAttributeValue(xml, "deviation.standard");
     if (!standardDeviationStr.empty()) {
-        this->standardDeviation = std::stod(standardDeviationStr);
+        this->standardDeviation = xml::NumberCodec::parseDouble(standardDeviationStr, this->standardDeviation);
         this->hasStandardDeviation = true;
     }
 
     std::string millisecondsTimingBasisStr = xml::Helper::getAttributeValue(xml, "milliseconds.timingBasis");
     if (!millisecondsTimingBasisStr.empty()) {
-        this->millisecondsTimingBasis = std::stod(millisecondsTimingBasisStr);
+        this->millisecondsTimingBasis = xml::NumberCodec::parseDouble(millisecondsTimingBasisStr, this->millisecondsTimingBasis);
         this->hasMillisecondsTimingBasis = true;
     }
 
     std::string degreeOfCorrelationStr = xml::Helper::getAttributeValue(xml, "degreeOfCorrelation");
     if (!degreeOfCorrelationStr.empty()) {
-        this->degreeOfCorrelation = std::stod(degreeOfCorrelationStr);
+        this->degreeOfCorrelation = xml::NumberCodec::parseDouble(degreeOfCorrelationStr, this->degreeOfCorrelation);
         this->hasDegreeOfCorrelation = true;
     }
 
     std::string maxStepWidthStr = xml::Helper::getAttributeValue(xml, "stepWidth.max");
     if (!maxStepWidthStr.empty()) {
-        this->maxStepWidth = std::stod(maxStepWidthStr);
+        this->maxStepWidth = xml::NumberCodec::parseDouble(maxStepWidthStr, this->maxStepWidth);
         this->hasMaxStepWidth = true;
     }
 
@@ -91,7 +92,7 @@ DistributionData::DistributionData(const Element& xml) : xml(xml) {
         if (std::string(child.name()) == "measurement") {
             std::string valueStr = xml::Helper::getAttributeValue(child, "value");
             if (!valueStr.empty()) {
-                this->distributionList.push_back(std::stod(valueStr));
+                this->distributionList.push_back(xml::NumberCodec::parseDouble(valueStr));
             }
         }
     }
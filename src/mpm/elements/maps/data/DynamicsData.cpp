@@ -1,5 +1,8 @@
 #include "mpm/elements/maps/data/DynamicsData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
+#include "msm/NoteTable.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -21,17 +24,15 @@ DynamicsData::DynamicsData(const Element& xmlElement)
     // Parse date attribute
     auto dateAttr = xml.attribute("date");
     if (dateAttr) {
-        startDate = xml::Helper::parseDouble(dateAttr.value());
+        startDate = xml::NumberCodec::parseDouble(dateAttr.value());
     }
 
     // Parse volume attribute
     auto volumeAttr = xml.attribute("volume");
     if (volumeAttr) {
         volumeString = volumeAttr.value();
-        try {
-            volume = xml::Helper::parseDouble(volumeString);
-        } catch (...) {
-            // Keep as string if not numeric - will need style resolution
+        if (!xml::NumberCodec::tryParse(volumeString, volume)) {
+            volume = 0.0;                           // keep as string if not numeric - will need style resolution
         }
     }
 
@@ -39,17 +40,15 @@ DynamicsData::DynamicsData(const Element& xmlElement)
     auto transitionToAttr = xml.attribute("transition.to");
     if (transitionToAttr) {
         transitionToString = transitionToAttr.value();
-        try {
-            transitionTo = xml::Helper::parseDouble(transitionToString);
-        } catch (...) {
-            // Keep as string if not numeric - will need style resolution
+        if (!xml::NumberCodec::tryParse(transitionToString, transitionTo)) {
+            transitionTo = 0.0;                     // keep as string if not numeric - will need style resolution
         }
     }
 
     // Parse curvature attribute
     auto curvatureAttr = xml.attribute("curvature");
     if (curvatureAttr) {
-        curvature = xml::Helper::parseDouble(curvatureAttr.value());
+        curvature = xml::NumberCodec::parseDouble(curvatureAttr.value());
         // Ensure boundaries as in Java
         curvature = std::max(0.0, std::min(1.0, curvature));
     }
@@ -57,7 +56,7 @@ DynamicsData::DynamicsData(const Element& xmlElement)
     // Parse protraction attribute
     auto protractionAttr = xml.attribute("protraction");
     if (protractionAttr) {
-        protraction = xml::Helper::parseDouble(protractionAttr.value());
+        protraction = xml::NumberCodec::parseDouble(protractionAttr.value());
         // Ensure boundaries as in Java
         protraction = std::max(-1.0, std::min(1.0, protraction));
     }
@@ -215,5 +214,95 @@ std::vector<std::pair<double, double>> DynamicsData::getSubNoteDynamicsSegment(d
     return series;
 }
 
+void DynamicsData::renderSubNoteDynamics(msm::NoteTable& notes, const std::function<double(double)>& toMilliseconds, double minInterval) {
+    if (!controlPointsComputed) {
+        computeInnerControlPointsXPositions();
+    }
+
+    struct Point {
+        double t;
+        double date;
+        double value;
+        double milliseconds;
+    };
+    auto pointAt = [this, &toMilliseconds](double t) {
+        std::pair<double, double> dateDynamics = getDateDynamics(t);
+        return Point{t, dateDynamics.first, dateDynamics.second, toMilliseconds(dateDynamics.first)};
+    };
+
+    Point first = pointAt(0.0);
+    Point last = pointAt(1.0);
+    std::vector<Point> events = {first};
+
+    // depth-first bisection, the left half is processed first, so the points come in date order
+    std::vector<std::pair<Point, Point>> intervals = {{first, last}};
+    while (!intervals.empty()) {
+        auto [a, b] = intervals.back();
+        intervals.pop_back();
+
+        bool withinStep = std::abs(std::round(b.value) - std::round(a.value)) <= 1.0;
+        if (!withinStep && ((b.milliseconds - a.milliseconds) >= (2.0 * minInterval))) {
+            Point middle = pointAt((a.t + b.t) * 0.5);
+            intervals.push_back({middle, b});
+            intervals.push_back({a, middle});
+            continue;
+        }
+
+        // the end of the interval is an event if it changes the controller value and keeps the distance
+        const Point& previous = events.back();
+        if ((std::round(b.value) != std::round(previous.value)) && ((b.milliseconds - previous.milliseconds) >= minInterval)) {
+            events.push_back(b);
+        }
+    }
+
+    // the target volume is always reached, an event too close before it is replaced
+    if (std::round(events.back().value) != std::round(last.value)) {
+        if ((events.size() > 1) && ((last.milliseconds - events.back().milliseconds) < minInterval)) {
+            events.pop_back();
+        }
+        events.push_back(last);
+    }
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        notes.addChannelVolume({events[i].date, events[i].milliseconds, events[i].value, i == 0});
+    }
+}
+
+void DynamicsData::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeString(xmlId);
+    writer.writeString(styleName);
+    writer.writeString(dynamicsDefString);
+    writer.writeDouble(startDate);
+    writer.writeDouble(endDate);
+    writer.writeString(volumeString);
+    writer.writeDouble(volume);
+    writer.writeString(transitionToString);
+    writer.writeDouble(transitionTo);
+    writer.writeDouble(curvature);
+    writer.writeDouble(protraction);
+    writer.writeBool(subNoteDynamics);
+    writer.writeDouble(x1);
+    writer.writeDouble(x2);
+    writer.writeBool(controlPointsComputed);
+}
+
+void DynamicsData::readFromCache(supplementary::BinaryReader& reader) {
+    xmlId = reader.readString();
+    styleName = reader.readString();
+    dynamicsDefString = reader.readString();
+    startDate = reader.readDouble();
+    endDate = reader.readDouble();
+    volumeString = reader.readString();
+    volume = reader.readDouble();
+    transitionToString = reader.readString();
+    transitionTo = reader.readDouble();
+    curvature = reader.readDouble();
+    protraction = reader.readDouble();
+    subNoteDynamics = reader.readBool();
+    x1 = reader.readDouble();
+    x2 = reader.readDouble();
+    controlPointsComputed = reader.readBool();
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
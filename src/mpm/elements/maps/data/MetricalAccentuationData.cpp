@@ -1,5 +1,7 @@
 #include "mpm/elements/maps/data/MetricalAccentuationData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 
 namespace meico {
 namespace mpm {
@@ -10,9 +12,9 @@ MetricalAccentuationData::MetricalAccentuationData() {
 
 MetricalAccentuationData::MetricalAccentuationData(const Element& xmlElement) {
     xml = xmlElement;
-    startDate = xml::Helper::parseDouble(xmlElement.attribute("date").value());
+    startDate = xml::NumberCodec::parseDouble(xmlElement.attribute("date").value());
     accentuationPatternDefName = xmlElement.attribute("name.ref").value();
-    scale = xml::Helper::parseDouble(xmlElement.attribute("scale").value());
+    scale = xml::NumberCodec::parseDouble(xmlElement.attribute("scale").value());
 
     auto loopAttr = xmlElement.attribute("loop");
     if (loopAttr) {
@@ -46,5 +48,27 @@ MetricalAccentuationData MetricalAccentuationData::clone() const {
     return clone;
 }
 
+void MetricalAccentuationData::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeString(xmlId);
+    writer.writeString(styleName);
+    writer.writeString(accentuationPatternDefName);
+    writer.writeDouble(startDate);
+    writer.writeOptional(endDate);
+    writer.writeDouble(scale);
+    writer.writeBool(loop);
+    writer.writeBool(stickToMeasures);
+}
+
+void MetricalAccentuationData::readFromCache(supplementary::BinaryReader& reader) {
+    xmlId = reader.readString();
+    styleName = reader.readString();
+    accentuationPatternDefName = reader.readString();
+    startDate = reader.readDouble();
+    endDate = reader.readOptional();
+    scale = reader.readDouble();
+    loop = reader.readBool();
+    stickToMeasures = reader.readBool();
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
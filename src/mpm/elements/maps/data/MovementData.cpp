@@ -1,5 +1,7 @@
 #include "mpm/elements/maps/data/MovementData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <cmath>
 #include <iostream>
 #include <algorithm>
@@ -17,31 +19,31 @@ MovementData::MovementData(const Element& xml)
     // Parse date attribute
     auto dateAttr = xml.attribute("date");
     if (dateAttr) {
-        startDate = xml::Helper::parseDouble(dateAttr.value());
+        startDate = xml::NumberCodec::parseDouble(dateAttr.value());
     }
 
     // Parse position attribute
     auto positionAttr = xml.attribute("position");
     if (positionAttr) {
-        position = xml::Helper::parseDouble(positionAttr.value());
+        position = xml::NumberCodec::parseDouble(positionAttr.value());
     }
 
     // Parse transition.to attribute
     auto transitionToAttr = xml.attribute("transition.to");
     if (transitionToAttr) {
-        transitionTo = xml::Helper::parseDouble(transitionToAttr.value());
+        transitionTo = xml::NumberCodec::parseDouble(transitionToAttr.value());
     }
 
     // Parse curvature attribute
     auto curvatureAttr = xml.attribute("curvature");
     if (curvatureAttr) {
-        curvature = xml::Helper::parseDouble(curvatureAttr.value());
+        curvature = xml::NumberCodec::parseDouble(curvatureAttr.value());
     }
 
     // Parse protraction attribute
     auto protractionAttr = xml.attribute("protraction");
     if (protractionAttr) {
-        protraction = xml::Helper::parseDouble(protractionAttr.value());
+        protraction = xml::NumberCodec::parseDouble(protractionAttr.value());
     }
 
     // Parse controller attribute
@@ -184,5 +186,33 @@ std::vector<std::pair<double, double>> MovementData::getMovementSegment(double m
     return series;
 }
 
+void MovementData::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeString(xmlId);
+    writer.writeDouble(startDate);
+    writer.writeDouble(endDate);
+    writer.writeDouble(position);
+    writer.writeDouble(transitionTo);
+    writer.writeString(controller);
+    writer.writeDouble(curvature);
+    writer.writeDouble(protraction);
+    writer.writeDouble(x1);
+    writer.writeDouble(x2);
+    writer.writeBool(controlPointsComputed);
+}
+
+void MovementData::readFromCache(supplementary::BinaryReader& reader) {
+    xmlId = reader.readString();
+    startDate = reader.readDouble();
+    endDate = reader.readDouble();
+    position = reader.readDouble();
+    transitionTo = reader.readDouble();
+    controller = reader.readString();
+    curvature = reader.readDouble();
+    protraction = reader.readDouble();
+    x1 = reader.readDouble();
+    x2 = reader.readDouble();
+    controlPointsComputed = reader.readBool();
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
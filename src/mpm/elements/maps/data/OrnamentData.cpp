@@ -1,5 +1,7 @@
 #include "mpm/elements/maps/data/OrnamentData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <algorithm>
 #include <iostream>
 #include <sstream>
@@ -50,7 +52,7 @@ void OrnamentData::parseFromXml(const Element& xml) {
     // Parse date attribute (mandatory)
     std::string dateValue = xml::Helper::getAttributeValue(xml, "date");
     if (!dateValue.empty()) {
-        this->date = std::stod(dateValue);
+        this->date = xml::NumberCodec::parseDouble(dateValue, this->date);
     }
     
     // Parse name.ref attribute (mandatory)
@@ -59,7 +61,7 @@ void OrnamentData::parseFromXml(const Element& xml) {
     // Parse scale attribute (optional)
     std::string scaleValue = xml::Helper::getAttributeValue(xml, "scale");
     if (!scaleValue.empty()) {
-        this->scale = std::stod(scaleValue);
+        this->scale = xml::NumberCodec::parseDouble(scaleValue, this->scale);
     }
     
     // Parse note.order attribute (optional)
@@ -90,7 +92,7 @@ void OrnamentData::parseFromXml(const Element& xml) {
     }
     
     // Parse xml:id attribute (optional)
-    this->xmlId = xml::Helper::getAttributeValue(xml, "id", "http://www.w3.org/XML/1998/namespace");
+    this->xmlId = xml::Helper::getAttributeValue(xml, "xml:id");
 }
 
 std::vector<std::vector<Element>> OrnamentData::apply(const std::vector<std::vector<Element>>& chordSequence) {
@@ -115,5 +117,34 @@ std::vector<std::vector<Element>> OrnamentData::apply(const std::vector<std::vec
     return chordsToAdd;
 }
 
+void OrnamentData::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeString(xmlId);
+    writer.writeString(styleName);
+    writer.writeString(ornamentDefName);
+    writer.writeDouble(date);
+    writer.writeDouble(scale);
+    writer.writeUInt32(static_cast<uint32_t>(noteOrder.size()));
+    for (const auto& entry : noteOrder) {
+        writer.writeString(entry);
+    }
+}
+
+void OrnamentData::readFromCache(supplementary::BinaryReader& reader) {
+    xmlId = reader.readString();
+    styleName = reader.readString();
+    ornamentDefName = reader.readString();
+    date = reader.readDouble();
+    scale = reader.readDouble();
+    uint32_t count = reader.readUInt32();
+    if (count > reader.remaining() / sizeof(uint32_t)) {    // each string has a length prefix, so a larger count is corrupt
+        reader.fail();
+        count = 0;
+    }
+    noteOrder.resize(count);
+    for (auto& entry : noteOrder) {
+        entry = reader.readString();
+    }
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "mpm/elements/maps/data/RubatoData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 
 namespace meico {
 namespace mpm {
@@ -15,7 +17,7 @@ RubatoData::RubatoData(const Element& xml) : RubatoData() {
     
     // Parse date attribute (required)
     if (xml.attribute("date")) {
-        startDate = std::stod(xml.attribute("date").value());
+        startDate = xml::NumberCodec::parseDouble(xml.attribute("date").value(), startDate);
     }
     
     // Parse XML ID
@@ -33,25 +35,25 @@ RubatoData::RubatoData(const Element& xml) : RubatoData() {
     // Parse frameLength attribute
     auto frameLengthAttr = xml.attribute("frameLength");
     if (frameLengthAttr) {
-        frameLength = std::stod(frameLengthAttr.value());
+        frameLength = xml::NumberCodec::parseDouble(frameLengthAttr.value(), frameLength);
     }
     
     // Parse intensity attribute
     auto intensityAttr = xml.attribute("intensity");
     if (intensityAttr) {
-        intensity = std::stod(intensityAttr.value());
+        intensity = xml::NumberCodec::parseDouble(intensityAttr.value(), intensity);
     }
     
     // Parse lateStart attribute
     auto lateStartAttr = xml.attribute("lateStart");
     if (lateStartAttr) {
-        lateStart = std::stod(lateStartAttr.value());
+        lateStart = xml::NumberCodec::parseDouble(lateStartAttr.value(), lateStart);
     }
     
     // Parse earlyEnd attribute
     auto earlyEndAttr = xml.attribute("earlyEnd");
     if (earlyEndAttr) {
-        earlyEnd = std::stod(earlyEndAttr.value());
+        earlyEnd = xml::NumberCodec::parseDouble(earlyEndAttr.value(), earlyEnd);
     }
     
     // Parse loop attribute
@@ -93,5 +95,31 @@ std::unique_ptr<RubatoData> RubatoData::clone() const {
     return std::make_unique<RubatoData>(*this);
 }
 
+void RubatoData::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeString(xmlId);
+    writer.writeString(styleName);
+    writer.writeString(rubatoDefString);
+    writer.writeDouble(startDate);
+    writer.writeDouble(endDate);
+    writer.writeDouble(frameLength);
+    writer.writeDouble(intensity);
+    writer.writeDouble(lateStart);
+    writer.writeDouble(earlyEnd);
+    writer.writeBool(loop);
+}
+
+void RubatoData::readFromCache(supplementary::BinaryReader& reader) {
+    xmlId = reader.readString();
+    styleName = reader.readString();
+    rubatoDefString = reader.readString();
+    startDate = reader.readDouble();
+    endDate = reader.readDouble();
+    frameLength = reader.readDouble();
+    intensity = reader.readDouble();
+    lateStart = reader.readDouble();
+    earlyEnd = reader.readDouble();
+    loop = reader.readBool();
+}
+
 }  // namespace mpm
 }  // namespace meico
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "mpm/elements/maps/data/TempoData.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "supplementary/BinaryStream.h"
 #include <limits>
 
 namespace meico {
@@ -22,21 +24,19 @@ TempoData::TempoData(const Element& xml) : TempoData() {
     // Parse start date
     std::string dateStr = xml::Helper::getAttributeValue(xml, "date");
     if (!dateStr.empty()) {
-        startDate = std::stod(dateStr);
+        startDate = xml::NumberCodec::parseDouble(dateStr, startDate);
     }
     
     // Parse beat length
     std::string beatLengthStr = xml::Helper::getAttributeValue(xml, "beatLength");
     if (!beatLengthStr.empty()) {
-        beatLength = std::stod(beatLengthStr);
+        beatLength = xml::NumberCodec::parseDouble(beatLengthStr, beatLength);
     }
     
     // Parse BPM - can be numeric or string
     std::string bpmStr = xml::Helper::getAttributeValue(xml, "bpm");
     if (!bpmStr.empty()) {
-        try {
-            bpm = std::stod(bpmStr);
-        } catch (const std::invalid_argument&) {
+        if (!xml::NumberCodec::tryParse(bpmStr, bpm)) {
             bpmString = bpmStr;  // Store as string if not numeric
         }
     }
@@ -44,9 +44,7 @@ TempoData::TempoData(const Element& xml) : TempoData() {
     // Parse transition.to - can be numeric or string
     std::string transitionStr = xml::Helper::getAttributeValue(xml, "transition.to");
     if (!transitionStr.empty()) {
-        try {
-            transitionTo = std::stod(transitionStr);
-        } catch (const std::invalid_argument&) {
+        if (!xml::NumberCodec::tryParse(transitionStr, transitionTo)) {
             transitionToString = transitionStr;  // Store as string if not numeric
         }
     }
@@ -54,11 +52,11 @@ TempoData::TempoData(const Element& xml) : TempoData() {
     // Parse meanTempoAt
     std::string meanTempoAtStr = xml::Helper::getAttributeValue(xml, "meanTempoAt");
     if (!meanTempoAtStr.empty()) {
-        meanTempoAt = std::stod(meanTempoAtStr);
+        meanTempoAt = xml::NumberCodec::parseDouble(meanTempoAtStr, meanTempoAt);
     }
     
     // Parse XML ID
-    xmlId = xml::Helper::getAttributeValue(xml, "id", "http://www.w3.org/XML/1998/namespace");
+    xmlId = xml::Helper::getAttributeValue(xml, "xml:id");
 }
 
 std::unique_ptr<TempoData> TempoData::clone() const {
@@ -101,5 +99,35 @@ bool TempoData::isConstantTempo() const {
     return false;
 }
 
+void TempoData::writeToCache(supplementary::BinaryWriter& writer) const {
+    writer.writeString(xmlId);
+    writer.writeString(styleName);
+    writer.writeDouble(startDate);
+    writer.writeDouble(startDateMilliseconds);
+    writer.writeDouble(endDate);
+    writer.writeString(bpmString);
+    writer.writeDouble(bpm);
+    writer.writeString(transitionToString);
+    writer.writeDouble(transitionTo);
+    writer.writeDouble(beatLength);
+    writer.writeDouble(meanTempoAt);
+    writer.writeDouble(exponent);
+}
+
+void TempoData::readFromCache(supplementary::BinaryReader& reader) {
+    xmlId = reader.readString();
+    styleName = reader.readString();
+    startDate = reader.readDouble();
+    startDateMilliseconds = reader.readDouble();
+    endDate = reader.readDouble();
+    bpmString = reader.readString();
+    bpm = reader.readDouble();
+    transitionToString = reader.readString();
+    transitionTo = reader.readDouble();
+    beatLength = reader.readDouble();
+    meanTempoAt = reader.readDouble();
+    exponent = reader.readDouble();
+}
+
 } // namespace mpm
 } // namespace meico
\ No newline at end of file
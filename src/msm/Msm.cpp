@@ -1,5 +1,17 @@
 #include "msm/Msm.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "msm/TimingScale.h"
+#include "msm/NoteTable.h"
+#include "midi/Midi.h"
+#include "midi/SmfWriter.h"
+#include "midi/InstrumentsDictionary.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string_view>
 #include <random>
 #include <iomanip>
 #include <sstream>
@@ -9,6 +21,80 @@ namespace msm {
 
 const int Msm::CONTROL_CHANGE_DENSITY;
 
+namespace {
+
+const int CC_CHANNEL_VOLUME = 7;
+
+/**
+ * The partwise linear compression of velocities into a limited range, see the Java
+ * Msm.computePartwiseCompression(); values within the range are compressed less than values
+ * beyond it
+ */
+class VelocityCompression {
+private:
+    bool active = false;
+    double min = 0.0, max = 127.0;
+    double lowest = 0.0, highest = 0.0;
+    double lowerCompMax = 0.0, upperCompMin = 0.0;
+    double upperRolloff1 = 0.0, upperRolloff2 = 0.0, lowerRolloff1 = 0.0, lowerRolloff2 = 0.0;
+    double upperRaise = 0.0, lowerRaise = 0.0;
+
+public:
+    VelocityCompression(double lowest, double highest, double min, double max)
+        : min(min), max(max), lowest(lowest), highest(highest) {
+        active = (lowest < min) || (highest > max);
+        if (!active) {
+            return;
+        }
+        std::cerr << "Warning: velocity values [" << lowest << ", " << highest << "] break the specified limits ["
+                  << min << ", " << max << "] and will be compressed." << std::endl;
+
+        // the ranges to be compressed are [lowest, lowerCompMax] and [upperCompMin, highest]
+        lowerCompMax = min;
+        upperCompMin = max;
+        if (lowest < min) {
+            lowerCompMax = max - (((max - min) * (max - min)) / (max - lowest));
+        }
+        if (highest > max) {
+            upperCompMin = min + (((max - min) * (max - min)) / (highest - min));
+        }
+        if (lowerCompMax > upperCompMin) {
+            lowerCompMax = (lowerCompMax + upperCompMin) / 2.0;
+            upperCompMin = lowerCompMax;
+        }
+
+        // the higher the rolloff factor, the less the values within [min, max] are compressed
+        double rolloffFactor = 0.66;
+        upperRaise = upperCompMin;
+        lowerRaise = min;
+        if (highest > max) {
+            upperRolloff1 = rolloffFactor;
+            upperRolloff2 = ((1.0 - rolloffFactor) * (max - upperCompMin)) / (highest - max);
+            upperRaise = upperCompMin + (rolloffFactor * (max - upperCompMin));
+        }
+        if (lowest < min) {
+            lowerRolloff1 = ((lowerCompMax - min) * (1.0 - rolloffFactor)) / (min - lowest);
+            lowerRolloff2 = ((lowerCompMax - min) * rolloffFactor) / (lowerCompMax - lowest);
+            lowerRaise = min + ((lowerCompMax - min) * (1.0 - rolloffFactor));
+        }
+    }
+
+    double apply(double x) const {
+        if (!active) {
+            return x;
+        }
+        if (x < lowerCompMax) {
+            return (x >= min) ? (lowerRolloff2 * (x - min)) + lowerRaise : (lowerRolloff1 * (x - lowest)) + min;
+        }
+        if (x > upperCompMin) {
+            return (x <= max) ? (upperRolloff1 * (x - upperCompMin)) + upperCompMin : (upperRolloff2 * (x - max)) + upperRaise;
+        }
+        return x;
+    }
+};
+
+} // namespace
+
 Msm::Msm() : AbstractMsm() {
 }
 
@@ -91,13 +177,13 @@ int Msm::getPPQ() const {
         // Try camelCase first (our generated XML)
         auto ppqAttr = root.attribute("pulsesPerQuarter");
         if (ppqAttr) {
-            return xml::Helper::parseInt(ppqAttr.value(), 720);
+            return xml::NumberCodec::parseInt(ppqAttr.value(), 720);
         }
         
         // Try all lowercase (Bach MSM test data format)
         ppqAttr = root.attribute("pulsesperquarter");
         if (ppqAttr) {
-            return xml::Helper::parseInt(ppqAttr.value(), 720);
+            return xml::NumberCodec::parseInt(ppqAttr.value(), 720);
         }
     }
     return 720; // default PPQ
@@ -109,19 +195,68 @@ void Msm::convertPPQ(int ppq) {
         return; // no conversion needed
     }
     
-    double scaleFactor = static_cast<double>(ppq) / currentPPQ;
     Element root = getRootElement();
     if (!root) {
         return;
     }
     
-    // Update PPQ attribute
-    root.attribute("pulsesPerQuarter").set_value(ppq);
+    // Update PPQ attribute in the spelling that getPPQ() read it from
+    Attribute ppqAttr = root.attribute("pulsesPerQuarter") ? root.attribute("pulsesPerQuarter") : root.attribute("pulsesperquarter");
+    if (ppqAttr) {
+        ppqAttr.set_value(ppq);
+    } else {
+        root.append_attribute("pulsesPerQuarter") = ppq;
+    }
     
-    // Convert all timing attributes (date, date.end, duration)
-    // This is a simplified version - in a full implementation, 
-    // we'd need to recursively traverse and update all timing attributes
-    convertTimingAttributes(root, scaleFactor);
+    // Convert the timing attributes, the index is built in one traversal on first use
+    TimingScale scale(currentPPQ, ppq);
+    for (Attribute attr : getTimingAttributes()) {
+        xml::NumberCodec::setValue(attr, scale.apply(xml::NumberCodec::parseDouble(attr.value())));
+    }
+}
+
+int Msm::getMinimalPPQ() const {
+    int ppq = getPPQ();
+    int64_t divisor = ppq;
+    for (Attribute attr : getTimingAttributes()) {
+        if (divisor == 1) {
+            break;
+        }
+        // rounding is necessary for avoiding numeric problems with triplets
+        int64_t value = std::llround(xml::NumberCodec::parseDouble(attr.value()));
+        divisor = std::gcd(divisor, (value < 0) ? -value : value);
+    }
+    return static_cast<int>(ppq / divisor);
+}
+
+const std::vector<Attribute>& Msm::getTimingAttributes() const {
+    std::lock_guard<std::mutex> lock(timingMutex);
+    if (timingRevision == getRevision()) {
+        return timingAttributes;
+    }
+    
+    timingAttributes.clear();
+    Element root = getRootElement();
+    for (Element element = root; element; ) {
+        for (auto attr : element.attributes()) {
+            std::string_view name = attr.name();
+            if ((name == "date") || (name == "date.end") || (name == "duration")) {
+                timingAttributes.push_back(attr);
+            }
+        }
+        
+        // pre-order traversal without recursion
+        if (element.first_child()) {
+            element = element.first_child();
+            continue;
+        }
+        while (element && (element != root) && !element.next_sibling()) {
+            element = element.parent();
+        }
+        element = (element && (element != root)) ? element.next_sibling() : Element();
+    }
+    timingRevision = getRevision();
+    return timingAttributes;
 }
 
 Element Msm::getGlobal() {
@@ -151,6 +286,222 @@ bool Msm::writeMsm(const std::string& filename) {
     return writeToFile(filename);
 }
 
+std::unique_ptr<midi::Midi> Msm::exportMidi(double bpm, bool generateProgramChanges) const {
+    return renderMidi(getPPQ(), bpm, generateProgramChanges, false, [](size_t, const Element&) -> const NoteTable* { return nullptr; });
+}
+
+std::unique_ptr<midi::Midi> Msm::exportExpressiveMidi(bool generateProgramChanges) const {
+    return renderMidi(getPPQ(), 120.0, generateProgramChanges, true, [](size_t, const Element&) -> const NoteTable* { return nullptr; });
+}
+
+std::unique_ptr<midi::Midi> Msm::renderMidi(int ppq, double bpm, bool generateProgramChanges, bool exportExpressiveMidi,
+                                            const std::function<const NoteTable*(size_t, const Element&)>& partNotes) const {
+    if (isEmpty()) {
+        return nullptr;
+    }
+
+    // get the notes of all parts; parts without notes from the caller are compiled here
+    Element root = getRootElement();
+    TimingScale timeScale(getPPQ(), ppq);
+    std::vector<Element> parts;
+    std::vector<const NoteTable*> tables;
+    std::vector<std::unique_ptr<NoteTable>> compiledTables;
+    size_t noteCount = 0;
+    double lowestVelocity = std::numeric_limits<double>::max();
+    double highestVelocity = std::numeric_limits<double>::lowest();
+    for (auto part : root.children("part")) {
+        const NoteTable* notes = partNotes(parts.size(), part);
+        if (!notes) {
+            auto compiled = std::make_unique<NoteTable>(part);
+            if (!timeScale.isIdentity()) {
+                compiled->convertPPQ(ppq);
+            }
+            if (exportExpressiveMidi) {         // the milliseconds dates of a rendered MSM are read from its notes
+                for (size_t row = 0; row < compiled->size(); ++row) {
+                    Element note = compiled->getElement(row);
+                    auto dateAttr = note.attribute("milliseconds.date");
+                    auto endAttr = note.attribute("milliseconds.date.end");
+                    if (dateAttr && endAttr) {
+                        double date = xml::NumberCodec::parseDouble(dateAttr.value());
+                        compiled->setMilliseconds(row, date, xml::NumberCodec::parseDouble(endAttr.value()) - date);
+                    }
+                }
+            }
+            notes = compiled.get();
+            compiledTables.push_back(std::move(compiled));
+        }
+        parts.push_back(part);
+        tables.push_back(notes);
+        noteCount += notes->size();
+        for (size_t row = 0; exportExpressiveMidi && (row < notes->size()); ++row) {
+            if (notes->hasFlag(row, NoteTable::HAS_VELOCITY) || notes->hasFlag(row, NoteTable::VELOCITY_CHANGED)) {
+                lowestVelocity = std::min(lowestVelocity, notes->getVelocity(row));
+                highestVelocity = std::max(highestVelocity, notes->getVelocity(row));
+            }
+        }
+    }
+
+    // expressive MIDI needs velocities within the MIDI range, they are compressed if necessary
+    VelocityCompression velocities(std::min(lowestVelocity, 0.0), std::max(highestVelocity, 127.0), 0.0, 127.0);
+
+    // each note is a note on, a note off and, if it has an id, a text event with it
+    midi::SmfWriter smf(ppq);
+    smf.reserve((noteCount * 3) + 256, (noteCount * 40) + 1024);
+
+    // the dates of the elements of the maps; in expressive mode these are the milliseconds dates, or the symbolic dates if there are none
+    size_t missingMilliseconds = 0;
+    auto getMapDate = [&](const Element& element) -> int64_t {
+        if (exportExpressiveMidi) {
+            auto millisecondsAttr = element.attribute("milliseconds.date");
+            if (millisecondsAttr) {
+                return std::llround(xml::NumberCodec::parseDouble(millisecondsAttr.value()));
+            }
+            ++missingMilliseconds;
+        }
+        return std::llround(timeScale.apply(xml::NumberCodec::parseDouble(element.attribute("date").value())));
+    };
+    auto addMetaMaps = [&](const Element& dated) {
+        if (!dated) {
+            return;
+        }
+        for (auto marker : dated.child("markerMap").children("marker")) {
+            auto messageAttr = marker.attribute("message");
+            smf.addText(getMapDate(marker), midi::SmfWriter::META_MARKER, messageAttr ? messageAttr.value() : "marker");
+        }
+        for (auto timeSignature : dated.child("timeSignatureMap").children("timeSignature")) {
+            auto numeratorAttr = timeSignature.attribute("numerator");
+            auto denominatorAttr = timeSignature.attribute("denominator");
+            smf.addTimeSignature(getMapDate(timeSignature),
+                                 numeratorAttr ? static_cast<int>(std::lround(xml::NumberCodec::parseDouble(numeratorAttr.value()))) : 4,
+                                 denominatorAttr ? static_cast<int>(std::lround(xml::NumberCodec::parseDouble(denominatorAttr.value()))) : 4);
+        }
+        for (auto keySignature : dated.child("keySignatureMap").children("keySignature")) {
+            int accidentals = 0;                // sharps count positive, flats negative
+            for (auto accidental : keySignature.children("accidental")) {
+                double value = xml::NumberCodec::parseDouble(accidental.attribute("value").value());
+                accidentals += (value > 0.0) ? 1 : ((value < 0.0) ? -1 : 0);
+            }
+            smf.addKeySignature(getMapDate(keySignature), accidentals);
+        }
+    };
+
+    // the first track holds the global tempo, markers, time and key signatures
+    smf.addTrack();
+    Element globalDated = getGlobal().child("dated");
+    if (exportExpressiveMidi) {
+        smf.addTempo(0, 60000.0 / ppq, 0.25);   // one tick is one millisecond
+    } else {
+        // the beat length is taken from the first global time signature, 1/4 by default
+        auto denominatorAttr = globalDated.child("timeSignatureMap").child("timeSignature").attribute("denominator");
+        int denominator = denominatorAttr ? xml::NumberCodec::parseInt(denominatorAttr.value(), 4) : 4;
+        smf.addTempo(0, bpm, 1.0 / ((denominator > 0) ? denominator : 4));
+    }
+    addMetaMaps(globalDated);
+
+    // each part with a MIDI channel becomes a track
+    for (size_t p = 0; p < parts.size(); ++p) {
+        const Element& part = parts[p];
+        auto channelAttr = part.attribute("midi.channel");
+        if (!channelAttr) {
+            continue;
+        }
+        int channel = xml::NumberCodec::parseInt(channelAttr.value(), 0);
+        auto portAttr = part.attribute("midi.port");
+        Element dated = part.child("dated");
+
+        smf.addTrack();
+        smf.addMidiPort(0, portAttr ? xml::NumberCodec::parseInt(portAttr.value(), 0) : 0);
+        smf.addChannelPrefix(0, channel);
+
+        // a programChangeMap with a program change at date 0 replaces the program change from the part name
+        bool initialProgramChange = false;
+        if (generateProgramChanges) {
+            for (auto programChange : dated.child("programChangeMap").children("programChange")) {
+                int64_t date = getMapDate(programChange);
+                initialProgramChange = initialProgramChange || (date == 0);
+                smf.addProgramChange(date, channel, xml::NumberCodec::parseInt(programChange.attribute("value").value(), 0));
+            }
+        }
+        std::string_view name = part.attribute("name").value();
+        if (generateProgramChanges && !initialProgramChange) {
+            smf.addProgramChange(0, channel, midi::InstrumentsDictionary::getProgramChange(name));
+        }
+        if (!name.empty()) {
+            smf.addText(0, midi::SmfWriter::META_TRACK_NAME, name);
+        }
+
+        addMetaMaps(dated);
+
+        // channel volume is exported only in expressive mode, from the rendered table or the part's channelVolumeMap;
+        // several events closer than CONTROL_CHANGE_DENSITY are thinned out, the last one is kept unless they are mandatory
+        if (exportExpressiveMidi) {
+            int64_t previousDate = std::numeric_limits<int64_t>::max();
+            auto addChannelVolume = [&](int64_t date, double value, bool mandatory) {
+                if (!mandatory && (date >= (previousDate - CONTROL_CHANGE_DENSITY))) {
+                    return;
+                }
+                previousDate = date;
+                smf.addControlChange(date, channel, CC_CHANNEL_VOLUME, static_cast<int>(std::lround(value)));
+            };
+            const auto& channelVolume = tables[p]->getChannelVolume();
+            if (!channelVolume.empty()) {
+                for (auto event = channelVolume.rbegin(); event != channelVolume.rend(); ++event) {
+                    addChannelVolume(std::llround(event->millisecondsDate), event->value, event->mandatory);
+                }
+            } else {
+                Element channelVolumeMap = dated.child("channelVolumeMap");
+                for (Element element = channelVolumeMap.last_child(); element; element = element.previous_sibling()) {
+                    if (element.type() == pugi::node_element) {
+                        addChannelVolume(getMapDate(element), xml::NumberCodec::parseDouble(element.attribute("value").value()),
+                                         static_cast<bool>(element.attribute("mandatory")));
+                    }
+                }
+            }
+            // a track with sub-note dynamics starts at the default channel volume unless its first event is at 0,
+            // tracks without channel volume events are left as they are
+            if ((previousDate > 0) && (previousDate != std::numeric_limits<int64_t>::max())) {
+                smf.addControlChange(0, channel, CC_CHANNEL_VOLUME, 100);
+            }
+        }
+
+        // the notes
+        const NoteTable& notes = *tables[p];
+        for (size_t row = 0; row < notes.size(); ++row) {
+            int pitch = static_cast<int>(std::lround(static_cast<float>(notes.getPitch(row))));
+            std::string_view id = notes.getId(row);
+            int64_t date = std::llround(notes.getDate(row));
+            int64_t dateEnd = std::llround(notes.getDate(row) + notes.getDuration(row));
+            int velocity = 100;
+            if (exportExpressiveMidi) {
+                if (notes.hasFlag(row, NoteTable::MILLISECONDS_CHANGED)) {
+                    date = std::llround(notes.getMillisecondsDate(row));
+                    dateEnd = std::llround(notes.getMillisecondsDate(row) + notes.getMillisecondsDuration(row));
+                } else {
+                    ++missingMilliseconds;
+                }
+                if (notes.hasFlag(row, NoteTable::HAS_VELOCITY) || notes.hasFlag(row, NoteTable::VELOCITY_CHANGED)) {
+                    velocity = static_cast<int>(std::lround(static_cast<float>(velocities.apply(notes.getVelocity(row)))));
+                }
+                if (id.empty()) {
+                    id = "unknown";
+                }
+            }
+            if (!id.empty()) {
+                smf.addText(date, midi::SmfWriter::META_TEXT_EVENT, id);
+            }
+            smf.addNoteOn(date, channel, pitch, velocity);
+            smf.addNoteOff(dateEnd, channel, pitch, 0);
+        }
+    }
+
+    if (missingMilliseconds > 0) {
+        std::cerr << "Missing attribute \"milliseconds.date\" in " << missingMilliseconds << " elements. Using attribute \"date\" instead." << std::endl;
+    }
+
+    std::string midiFile = getFile().empty() ? std::string() : xml::Helper::getFilenameWithoutExtension(getFile()) + ".mid";
+    return std::make_unique<midi::Midi>(smf.toBytes(), midiFile);
+}
+
 void Msm::cleanup(std::vector<std::unique_ptr<Msm>>& msmList) {
     msmList.clear();
 }
@@ -192,35 +543,5 @@ std::string Msm::generateUUID() {
     return ss.str();
 }
 
-void Msm::convertTimingAttributes(Element element, double scaleFactor) {
-    if (!element) {
-        return;
-    }
-    
-    // Convert timing attributes for this element
-    auto dateAttr = element.attribute("date");
-    if (dateAttr) {
-        double value = xml::Helper::parseDouble(dateAttr.value());
-        dateAttr.set_value(std::to_string(value * scaleFactor).c_str());
-    }
-    
-    auto dateEndAttr = element.attribute("date.end");
-    if (dateEndAttr) {
-        double value = xml::Helper::parseDouble(dateEndAttr.value());
-        dateEndAttr.set_value(std::to_string(value * scaleFactor).c_str());
-    }
-    
-    auto durationAttr = element.attribute("duration");
-    if (durationAttr) {
-        double value = xml::Helper::parseDouble(durationAttr.value());
-        durationAttr.set_value(std::to_string(value * scaleFactor).c_str());
-    }
-    
-    // Recursively convert child elements
-    for (auto child : element.children()) {
-        convertTimingAttributes(child, scaleFactor);
-    }
-}
-
 } // namespace msm
 } // namespace meico
\ No newline at end of file
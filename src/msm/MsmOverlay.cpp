@@ -0,0 +1,44 @@
+#include "msm/MsmOverlay.h"
+#include "msm/Msm.h"
+#include "msm/MsmStreamWriter.h"
+#include "midi/Midi.h"
+#include "xml/Helper.h"
+#include <sstream>
+
+namespace meico {
+namespace msm {
+
+MsmOverlay::MsmOverlay(const Msm& source, int ppq, std::vector<Element> parts, std::vector<NoteTable> notes)
+    : source(&source), ppq(ppq), file(source.getFile()), parts(std::move(parts)), notes(std::move(notes)) {
+}
+
+bool MsmOverlay::write(MsmStreamWriter& writer) const {
+    writer.writeMsm(*source, ppq, [this](size_t index, const Element&) -> const NoteTable* {
+        return (index < notes.size()) ? &notes[index] : nullptr;
+    });
+    return writer.finish();
+}
+
+std::unique_ptr<Msm> MsmOverlay::materialize() const {
+    // the result is written once and parsed, the source document is never copied or modified
+    std::ostringstream xml;
+    MsmStreamWriter writer(xml, true);
+    write(writer);
+
+    auto result = std::make_unique<Msm>(xml.str(), true);
+    result->setFile(file);
+    return result;
+}
+
+std::unique_ptr<midi::Midi> MsmOverlay::exportExpressiveMidi(bool generateProgramChanges) const {
+    auto result = source->renderMidi(ppq, 120.0, generateProgramChanges, true, [this](size_t index, const Element&) -> const NoteTable* {
+        return (index < notes.size()) ? &notes[index] : nullptr;
+    });
+    if (result) {
+        result->setFile(file.empty() ? std::string() : xml::Helper::getFilenameWithoutExtension(file) + ".mid");
+    }
+    return result;
+}
+
+} // namespace msm
+} // namespace meico
@@ -0,0 +1,354 @@
+#include "msm/MsmStreamReader.h"
+#include "xml/NumberCodec.h"
+#include <cstdlib>
+
+namespace meico {
+namespace msm {
+
+const size_t MsmStreamReader::DEFAULT_BATCH_SIZE;
+const size_t MsmStreamReader::CHUNK_SIZE;
+
+const char* MsmStreamReader::StreamElement::attribute(std::string_view attributeName) const {
+    for (size_t i = 0; i < attributeCount; ++i) {
+        if (attributes[i].first == attributeName) {
+            return attributes[i].second.c_str();
+        }
+    }
+    return nullptr;
+}
+
+static bool isWhitespace(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+/**
+ * Append a unicode code point to a string in UTF-8 encoding
+ * @param codePoint the code point
+ * @param out the string
+ */
+static void appendUtf8(unsigned long codePoint, std::string& out) {
+    if (codePoint < 0x80) {
+        out.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+MsmStreamReader::MsmStreamReader(std::istream& input, size_t batchSize)
+    : input(input), chunk(CHUNK_SIZE), batchSize((batchSize > 0) ? batchSize : 1) {
+    path.reserve(16);
+}
+
+MsmStreamReader::Event MsmStreamReader::next() {
+    if (partEnded) {                                // the part stays accessible during its PART_END event
+        inPart = false;
+        partEnded = false;
+    }
+    notes.clear();
+
+    for (;;) {
+        if (!tagPending) {
+            if (!readTag()) {
+                if (!path.empty()) {
+                    throw ParsingException("Unexpected end of MSM input in element " + path.back());
+                }
+                return notes.isEmpty() ? Event::END : Event::NOTES;
+            }
+
+            if (isScoreNote()) {
+                addNote();
+                if (tagType == TagType::START) {
+                    path.push_back(element.name);
+                }
+                if (notes.size() >= batchSize) {
+                    return Event::NOTES;
+                }
+                continue;
+            }
+
+            if (!notes.isEmpty()) {                 // deliver the notes first, process the tag with the next call
+                tagPending = true;
+                return Event::NOTES;
+            }
+        }
+
+        tagPending = false;
+        Event event;
+        if (process(event)) {
+            return event;
+        }
+    }
+}
+
+void MsmStreamReader::read(Handler& handler) {
+    for (Event event = next(); event != Event::END; event = next()) {
+        switch (event) {
+            case Event::MSM:
+                handler.onMsm(element);
+                break;
+            case Event::PART_BEGIN:
+                handler.onPartBegin(part);
+                break;
+            case Event::PART_END:
+                handler.onPartEnd(part);
+                break;
+            case Event::NOTES:
+                handler.onNotes(part, notes);
+                break;
+            case Event::MAP_ELEMENT:
+                handler.onMapElement(getPart(), mapName, element);
+                break;
+            case Event::END:
+                break;
+        }
+    }
+}
+
+bool MsmStreamReader::get(char& c) {
+    if (chunkPosition == chunkLength) {
+        input.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        chunkLength = static_cast<size_t>(input.gcount());
+        chunkPosition = 0;
+        if (chunkLength == 0) {
+            return false;
+        }
+    }
+    c = chunk[chunkPosition++];
+    return true;
+}
+
+void MsmStreamReader::skipPast(std::string_view terminator) {
+    size_t matched = 0;
+    char c;
+    while (matched < terminator.size()) {
+        if (!get(c)) {
+            throw ParsingException("Unexpected end of MSM input, missing " + std::string(terminator));
+        }
+        if (c == terminator[matched]) {
+            ++matched;
+        } else {
+            // fall back to the longest matching prefix; this is exact for terminators like "-->", "]]>" and "?>"
+            while ((matched > 0) && (c != terminator[matched])) {
+                --matched;
+            }
+            if (c == terminator[matched]) {
+                ++matched;
+            }
+        }
+    }
+}
+
+bool MsmStreamReader::readTag() {
+    char c;
+    for (;;) {
+        do {                                        // skip text content
+            if (!get(c)) {
+                return false;
+            }
+        } while (c != '<');
+
+        if (!get(c)) {
+            throw ParsingException("Unexpected end of MSM input in tag");
+        }
+
+        if (c == '?') {                             // xml declaration or processing instruction
+            skipPast("?>");
+            continue;
+        }
+
+        if (c == '!') {
+            if (!get(c)) {
+                throw ParsingException("Unexpected end of MSM input in tag");
+            }
+            if (c == '-') {                         // comment
+                skipPast("-->");
+            } else if (c == '[') {                  // CDATA section
+                skipPast("]]>");
+            } else {                                // doctype, possibly with an internal subset
+                int depth = 0;
+                while ((c != '>') || (depth > 0)) {
+                    if (c == '[') ++depth;
+                    if (c == ']') --depth;
+                    if (!get(c)) {
+                        throw ParsingException("Unexpected end of MSM input in doctype");
+                    }
+                }
+            }
+            continue;
+        }
+
+        element.name.clear();
+        element.attributeCount = 0;
+
+        if (c == '/') {                             // end tag
+            while (get(c) && (c != '>')) {
+                if (!isWhitespace(c)) {
+                    element.name.push_back(c);
+                }
+            }
+            tagType = TagType::END;
+            return true;
+        }
+
+        do {                                        // start tag, element name
+            element.name.push_back(c);
+            if (!get(c)) {
+                throw ParsingException("Unexpected end of MSM input in tag " + element.name);
+            }
+        } while (!isWhitespace(c) && (c != '/') && (c != '>'));
+
+        for (;;) {                                  // attributes
+            while (isWhitespace(c)) {
+                if (!get(c)) {
+                    throw ParsingException("Unexpected end of MSM input in tag " + element.name);
+                }
+            }
+            if (c == '>') {
+                tagType = TagType::START;
+                return true;
+            }
+            if (c == '/') {
+                if (!get(c) || (c != '>')) {
+                    throw ParsingException("Malformed empty element tag " + element.name);
+                }
+                tagType = TagType::EMPTY;
+                return true;
+            }
+
+            if (element.attributes.size() <= element.attributeCount) {
+                element.attributes.emplace_back();
+            }
+            auto& attribute = element.attributes[element.attributeCount++];
+            attribute.first.clear();
+            while ((c != '=') && !isWhitespace(c)) {
+                attribute.first.push_back(c);
+                if (!get(c)) {
+                    throw ParsingException("Unexpected end of MSM input in tag " + element.name);
+                }
+            }
+            while ((c != '\'') && (c != '"')) {     // skip '=' and whitespace up to the opening quote
+                if ((!isWhitespace(c) && (c != '=')) || !get(c)) {
+                    throw ParsingException("Malformed attribute " + attribute.first + " in tag " + element.name);
+                }
+            }
+            readAttributeValue(c, attribute.second);
+            if (!get(c)) {
+                throw ParsingException("Unexpected end of MSM input in tag " + element.name);
+            }
+        }
+    }
+}
+
+void MsmStreamReader::readAttributeValue(char quote, std::string& value) {
+    value.clear();
+    char c;
+    for (;;) {
+        if (!get(c)) {
+            throw ParsingException("Unexpected end of MSM input in attribute value");
+        }
+        if (c == quote) {
+            return;
+        }
+        if (c != '&') {
+            value.push_back(isWhitespace(c) ? ' ' : c);     // attribute value normalization
+            continue;
+        }
+
+        text.clear();                               // entity or character reference
+        while (get(c) && (c != ';')) {
+            text.push_back(c);
+        }
+        if (text == "lt") value.push_back('<');
+        else if (text == "gt") value.push_back('>');
+        else if (text == "amp") value.push_back('&');
+        else if (text == "quot") value.push_back('"');
+        else if (text == "apos") value.push_back('\'');
+        else if ((text.size() > 1) && (text[0] == '#')) {
+            bool hex = (text[1] == 'x');
+            unsigned long codePoint = std::strtoul(text.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10);
+            appendUtf8(codePoint, value);
+        } else {
+            value.append("&").append(text).append(";");     // unknown entity, keep it as it is
+        }
+    }
+}
+
+bool MsmStreamReader::isScoreNote() const {
+    return (tagType != TagType::END) && !path.empty() && (path.back() == "score") && (element.name == "note");
+}
+
+void MsmStreamReader::addNote() {
+    uint32_t hasFlags = 0;
+    double values[4] = {0.0, 0.0, 0.0, 0.0};
+    static const char* names[4] = {"date", "duration", "midi.pitch", "velocity"};
+    static const uint32_t flags[4] = {NoteTable::HAS_DATE, NoteTable::HAS_DURATION, NoteTable::HAS_PITCH, NoteTable::HAS_VELOCITY};
+
+    for (int i = 0; i < 4; ++i) {
+        const char* value = element.attribute(names[i]);
+        if (value) {
+            values[i] = xml::NumberCodec::parseDouble(value);
+            hasFlags |= flags[i];
+        }
+    }
+
+    const char* id = element.attribute("xml:id");
+    notes.addNote(values[0], values[1], values[2], values[3], id ? std::string_view(id) : std::string_view(), hasFlags);
+}
+
+bool MsmStreamReader::process(Event& event) {
+    if (tagType == TagType::END) {
+        if (path.empty() || (path.back() != element.name)) {
+            throw ParsingException("Unexpected end tag " + element.name + " in MSM input");
+        }
+        path.pop_back();
+        if (inPart && (element.name == "part")) {
+            partEnded = true;
+            event = Event::PART_END;
+            return true;
+        }
+        return false;
+    }
+
+    bool hasEvent = false;
+    size_t depth = path.size();
+
+    if ((depth == 0) && (element.name == "msm")) {
+        const char* ppqValue = element.attribute("pulsesPerQuarter");
+        if (!ppqValue) {
+            ppqValue = element.attribute("pulsesperquarter");                 // the lowercase spelling, accepted as by Msm::getPPQ()
+        }
+        if (ppqValue) {
+            ppq = xml::NumberCodec::parseInt(ppqValue, 720);
+        }
+        notes.setPPQ(ppq);
+        event = Event::MSM;
+        hasEvent = true;
+    } else if ((depth == 1) && (element.name == "part")) {
+        part = element;
+        inPart = true;
+        event = Event::PART_BEGIN;
+        hasEvent = true;
+    } else if ((depth >= 2) && (path[depth - 2] == "dated")) {     // an entry of a map, part/dated/map/entry or global/dated/map/entry
+        mapName = path[depth - 1];
+        event = Event::MAP_ELEMENT;
+        hasEvent = true;
+    }
+
+    if (tagType == TagType::START) {
+        path.push_back(element.name);
+    }
+    return hasEvent;
+}
+
+} // namespace msm
+} // namespace meico
@@ -0,0 +1,411 @@
+#include "msm/MsmStreamWriter.h"
+#include "msm/Msm.h"
+#include "xml/NumberCodec.h"
+#include <algorithm>
+#include <numeric>
+
+namespace meico {
+namespace msm {
+
+const unsigned MsmStreamWriter::NEWLINE;
+const unsigned MsmStreamWriter::INDENT;
+
+MsmStreamWriter::MsmStreamWriter(std::ostream& output, bool compact) : output(output), compact(compact) {
+}
+
+void MsmStreamWriter::writeDeclaration() {
+    output << "<?xml version=\"1.0\"?>";
+    if (!compact) {
+        output << '\n';
+    }
+}
+
+void MsmStreamWriter::closeStartTag() {
+    if (startTagOpen) {
+        output << '>';
+        startTagOpen = false;
+        ++depth;
+        indentFlags = NEWLINE | INDENT;
+    }
+}
+
+void MsmStreamWriter::beginNode() {
+    if (compact) {
+        return;
+    }
+    if (indentFlags & NEWLINE) {
+        output << '\n';
+    }
+    if (indentFlags & INDENT) {
+        for (unsigned i = 0; i < depth; ++i) {
+            output << '\t';
+        }
+    }
+}
+
+void MsmStreamWriter::startElement(std::string_view name) {
+    closeStartTag();
+    beginNode();
+    output << '<' << name;
+    openElements.emplace_back(name);
+    startTagOpen = true;
+}
+
+void MsmStreamWriter::attribute(std::string_view name, std::string_view value) {
+    output << ' ' << name << "=\"";
+    writeEscaped(value, true);
+    output << '"';
+}
+
+void MsmStreamWriter::attribute(std::string_view name, double value) {
+    char buffer[xml::NumberCodec::BUFFER_SIZE];
+    size_t length = xml::NumberCodec::format(value, buffer);
+    attribute(name, std::string_view(buffer, length));
+}
+
+void MsmStreamWriter::startElement(const Element& element) {
+    startElement(std::string_view(element.name()));
+    for (auto attr : element.attributes()) {
+        if (!timeScale.isIdentity() && isTimingAttribute(attr.name())) {
+            attribute(attr.name(), timeScale.apply(xml::NumberCodec::parseDouble(attr.value())));
+        } else {
+            attribute(attr.name(), attr.value());
+        }
+    }
+}
+
+void MsmStreamWriter::endElement() {
+    if (openElements.empty()) {
+        return;
+    }
+
+    if (startTagOpen) {                         // no content, write an empty element tag
+        output << (compact ? "/>" : " />");
+        startTagOpen = false;
+    } else {
+        --depth;
+        beginNode();
+        output << "</" << openElements.back() << '>';
+    }
+    openElements.pop_back();
+    indentFlags = NEWLINE | INDENT;
+}
+
+void MsmStreamWriter::text(std::string_view text) {
+    closeStartTag();
+    writeEscaped(text, false);
+    indentFlags = 0;                            // text content is not followed by a line break, as in pugixml
+}
+
+void MsmStreamWriter::writeEscaped(std::string_view value, bool isAttribute) {
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        char c = value[i];
+        const char* replacement = nullptr;
+        switch (c) {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            case '"': replacement = isAttribute ? "&quot;" : nullptr; break;
+            default: break;
+        }
+
+        unsigned char code = static_cast<unsigned char>(c);
+        bool control = (code < 32) && (isAttribute || ((c != '\t') && (c != '\r') && (c != '\n')));
+        if (!replacement && !control) {
+            continue;
+        }
+
+        output.write(value.data() + start, static_cast<std::streamsize>(i - start));
+        if (replacement) {
+            output << replacement;
+        } else {
+            output << "&#" << static_cast<char>('0' + code / 10) << static_cast<char>('0' + code % 10) << ';';
+        }
+        start = i + 1;
+    }
+    output.write(value.data() + start, static_cast<std::streamsize>(value.size() - start));
+}
+
+void MsmStreamWriter::writeNode(const Element& node, const NoteTable* notes) {
+    switch (node.type()) {
+        case pugi::node_document:
+            for (auto child : node.children()) {
+                writeNode(child, notes);
+            }
+            break;
+
+        case pugi::node_element:
+            if (notes && (node == notes->getScore())) {
+                writeScore(node, *notes);
+                writeChannelVolume(*notes);
+                break;
+            }
+            if (notes && !notes->getChannelVolume().empty() && (std::string_view(node.name()) == "channelVolumeMap")
+                    && (node.parent() == notes->getScore().parent())) {
+                break;                          // replaced by the channel volume of the table, see writeChannelVolume()
+            }
+            startElement(node);
+            for (auto child : node.children()) {
+                writeNode(child, notes);
+            }
+            endElement();
+            break;
+
+        case pugi::node_pcdata:
+            text(node.value());
+            break;
+
+        case pugi::node_cdata:
+            closeStartTag();
+            output << "<![CDATA[" << node.value() << "]]>";
+            indentFlags = 0;
+            break;
+
+        case pugi::node_comment:
+            closeStartTag();
+            beginNode();
+            output << "<!--" << node.value() << "-->";
+            indentFlags = NEWLINE | INDENT;
+            break;
+
+        case pugi::node_pi:
+            closeStartTag();
+            beginNode();
+            output << "<?" << node.name();
+            if (*node.value()) {
+                output << ' ' << node.value();
+            }
+            output << "?>";
+            indentFlags = NEWLINE | INDENT;
+            break;
+
+        case pugi::node_declaration:
+            closeStartTag();
+            beginNode();
+            output << "<?" << node.name();
+            for (auto attr : node.attributes()) {
+                attribute(attr.name(), attr.value());
+            }
+            output << "?>";
+            indentFlags = NEWLINE | INDENT;
+            break;
+
+        case pugi::node_doctype:
+            closeStartTag();
+            beginNode();
+            output << "<!DOCTYPE";
+            if (*node.value()) {
+                output << ' ' << node.value();
+            }
+            output << '>';
+            indentFlags = NEWLINE | INDENT;
+            break;
+
+        default:
+            break;
+    }
+}
+
+void MsmStreamWriter::writeScore(const Element& score, const NoteTable& notes) {
+    startElement(score);
+
+    // the rows were compiled from the note children in document order, other children are copied
+    preparePendingAttributes(notes);
+    size_t row = 0;
+    for (auto child : score.children()) {
+        if ((child.type() == pugi::node_element) && (row < notes.size()) && (child == notes.getElement(row))) {
+            writeNote(notes, row++);
+        } else {
+            writeNode(child);
+        }
+    }
+    pendingInRowOrder = false;
+
+    endElement();
+}
+
+void MsmStreamWriter::writeChannelVolume(const NoteTable& notes) {
+    if (notes.getChannelVolume().empty()) {
+        return;
+    }
+
+    // the same elements and attributes as NoteTable::writeBack() creates
+    startElement(std::string_view("channelVolumeMap"));
+    for (const auto& event : notes.getChannelVolume()) {
+        startElement(std::string_view("volume"));
+        attribute("date", event.date);
+        attribute("value", event.value);
+        if (event.mandatory) {
+            attribute("mandatory", std::string_view("true"));
+        }
+        attribute("milliseconds.date", event.millisecondsDate);
+        endElement();
+    }
+    endElement();
+}
+
+void MsmStreamWriter::setNoteAttribute(std::string_view name, std::string_view value) {
+    for (size_t i = 0; i < noteAttributeCount; ++i) {
+        if (noteAttributes[i].first == name) {
+            noteAttributes[i].second.assign(value);
+            return;
+        }
+    }
+    if (noteAttributes.size() <= noteAttributeCount) {
+        noteAttributes.emplace_back();
+    }
+    noteAttributes[noteAttributeCount].first.assign(name);
+    noteAttributes[noteAttributeCount].second.assign(value);
+    ++noteAttributeCount;
+}
+
+void MsmStreamWriter::writeNote(const NoteTable& notes, size_t row) {
+    char buffer[xml::NumberCodec::BUFFER_SIZE];
+    noteAttributeCount = 0;
+
+    Element element = notes.getElement(row);
+    if (element) {
+        for (auto attr : element.attributes()) {
+            if (!timeScale.isIdentity() && isTimingAttribute(attr.name())) {
+                size_t length = xml::NumberCodec::format(timeScale.apply(xml::NumberCodec::parseDouble(attr.value())), buffer);
+                setNoteAttribute(attr.name(), std::string_view(buffer, length));
+            } else {
+                setNoteAttribute(attr.name(), attr.value());
+            }
+        }
+    } else {                                    // a row without element, e.g. from the streaming reader
+        static const char* names[4] = {"date", "duration", "midi.pitch", "velocity"};
+        static const uint32_t flags[4] = {NoteTable::HAS_DATE, NoteTable::HAS_DURATION, NoteTable::HAS_PITCH, NoteTable::HAS_VELOCITY};
+        double values[4] = {notes.getDate(row), notes.getDuration(row), notes.getPitch(row), notes.getVelocity(row)};
+        for (int i = 0; i < 4; ++i) {
+            if (notes.hasFlag(row, flags[i])) {
+                size_t length = xml::NumberCodec::format(values[i], buffer);
+                setNoteAttribute(names[i], std::string_view(buffer, length));
+            }
+        }
+        if (notes.getIdIndex(row) >= 0) {
+            setNoteAttribute("xml:id", notes.getId(row));
+        }
+    }
+
+    // the changed columns and the pending attributes, in the order writeBack() applies them
+    notes.getChangedAttributes(row, changedAttributes);
+    for (const auto& changed : changedAttributes) {
+        size_t length = xml::NumberCodec::format(changed.second, buffer);
+        setNoteAttribute(changed.first, std::string_view(buffer, length));
+    }
+    const auto& pendingAttributes = notes.getPendingAttributes();
+    if (pendingInRowOrder) {                    // rows are written in ascending order, see preparePendingAttributes()
+        while ((pendingCursor < pendingOrder.size()) && (pendingAttributes[pendingOrder[pendingCursor]].row < row)) {
+            ++pendingCursor;
+        }
+        for (; (pendingCursor < pendingOrder.size()) && (pendingAttributes[pendingOrder[pendingCursor]].row == row); ++pendingCursor) {
+            const auto& pending = pendingAttributes[pendingOrder[pendingCursor]];
+            setNoteAttribute(pending.name, pending.value);
+        }
+    } else {
+        for (const auto& pending : pendingAttributes) {
+            if (pending.row == row) {
+                setNoteAttribute(pending.name, pending.value);
+            }
+        }
+    }
+
+    startElement("note");
+    for (size_t i = 0; i < noteAttributeCount; ++i) {
+        attribute(noteAttributes[i].first, noteAttributes[i].second);
+    }
+    endElement();
+}
+
+void MsmStreamWriter::writeNotes(const NoteTable& notes) {
+    preparePendingAttributes(notes);
+    for (size_t row = 0; row < notes.size(); ++row) {
+        writeNote(notes, row);
+    }
+    pendingInRowOrder = false;
+}
+
+void MsmStreamWriter::preparePendingAttributes(const NoteTable& notes) {
+    const auto& pendingAttributes = notes.getPendingAttributes();
+    pendingOrder.resize(pendingAttributes.size());
+    std::iota(pendingOrder.begin(), pendingOrder.end(), 0);
+    std::stable_sort(pendingOrder.begin(), pendingOrder.end(),
+        [&pendingAttributes](size_t a, size_t b) { return pendingAttributes[a].row < pendingAttributes[b].row; });
+    pendingCursor = 0;
+    pendingInRowOrder = true;
+}
+
+void MsmStreamWriter::writeMsm(const Msm& msm) {
+    const Document& document = msm.getDocument();
+    bool hasDeclaration = false;
+    for (auto child : document.children()) {
+        hasDeclaration = hasDeclaration || (child.type() == pugi::node_declaration);
+    }
+    if (!hasDeclaration) {
+        writeDeclaration();
+    }
+    writeNode(document);
+}
+
+void MsmStreamWriter::writeMsm(const Msm& msm, int ppq, const std::function<const NoteTable*(size_t, const Element&)>& partNotes) {
+    setTimeScale(TimingScale(msm.getPPQ(), ppq));
+
+    const Document& document = msm.getDocument();
+    bool hasDeclaration = false;
+    for (auto child : document.children()) {
+        hasDeclaration = hasDeclaration || (child.type() == pugi::node_declaration);
+    }
+    if (!hasDeclaration) {
+        writeDeclaration();
+    }
+
+    // Everything but the notes of the parts is copied, the notes come from the tables
+    Element root = msm.getRootElement();
+    size_t partIndex = 0;
+    for (auto node : document.children()) {
+        if (node != root) {
+            writeNode(node);
+            continue;
+        }
+
+        startElement(std::string_view(root.name()));
+        for (auto attr : root.attributes()) {
+            if (!timeScale.isIdentity() && (std::string_view(attr.name()) == "pulsesPerQuarter")) {
+                attribute(attr.name(), static_cast<double>(ppq));
+            } else {
+                attribute(attr.name(), attr.value());
+            }
+        }
+
+        for (auto child : root.children()) {
+            if ((child.type() != pugi::node_element) || (std::string_view(child.name()) != "part")) {
+                writeNode(child);
+                continue;
+            }
+            writeNode(child, partNotes(partIndex++, child));
+        }
+
+        endElement();
+    }
+}
+
+bool MsmStreamWriter::finish() {
+    while (!openElements.empty()) {
+        endElement();
+    }
+    if ((indentFlags & NEWLINE) && !compact) {
+        output << '\n';
+    }
+    indentFlags = INDENT;
+    output.flush();
+    return output.good();
+}
+
+bool MsmStreamWriter::isTimingAttribute(std::string_view name) {
+    return (name == "date") || (name == "date.end") || (name == "duration");
+}
+
+} // namespace msm
+} // namespace meico
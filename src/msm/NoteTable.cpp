@@ -0,0 +1,329 @@
+#include "msm/NoteTable.h"
+#include "msm/TimingScale.h"
+#include "xml/Helper.h"
+#include "xml/NumberCodec.h"
+#include "xml/XmlBase.h"
+#include <algorithm>
+#include <numeric>
+
+namespace meico {
+namespace msm {
+
+const uint32_t NoteTable::HAS_DATE;
+const uint32_t NoteTable::HAS_DURATION;
+const uint32_t NoteTable::HAS_PITCH;
+const uint32_t NoteTable::HAS_VELOCITY;
+const uint32_t NoteTable::DATE_CHANGED;
+const uint32_t NoteTable::DURATION_CHANGED;
+const uint32_t NoteTable::VELOCITY_CHANGED;
+const uint32_t NoteTable::TEMPO_CHANGED;
+const uint32_t NoteTable::MILLISECONDS_CHANGED;
+
+NoteTable::NoteTable(Element msmPart) {
+    score = findScore(msmPart);
+    if (!score) {
+        return;
+    }
+
+    // the same spellings as Msm::getPPQ()
+    Element root = msmPart.parent();
+    auto ppqAttr = root.attribute("pulsesPerQuarter") ? root.attribute("pulsesPerQuarter") : root.attribute("pulsesperquarter");
+    if (ppqAttr) {
+        ppq = xml::NumberCodec::parseInt(ppqAttr.value(), 720);
+    }
+
+    for (auto note : score.children("note")) {
+        addNote(note);
+    }
+}
+
+Element NoteTable::findScore(const Element& msmPart) {
+    if (!msmPart) {
+        return Element();
+    }
+
+    // First try: part -> dated -> score (for some MSM structures)
+    Element scoreElement = xml::Helper::getFirstChildElement(msmPart, "dated");
+    if (scoreElement) {
+        scoreElement = xml::Helper::getFirstChildElement(scoreElement, "score");
+    }
+
+    // If not found, try: part -> header -> dated -> score (for Bach MSM structure)
+    if (!scoreElement) {
+        auto headerElement = xml::Helper::getFirstChildElement(msmPart, "header");
+        if (headerElement) {
+            auto datedElement = xml::Helper::getFirstChildElement(headerElement, "dated");
+            if (datedElement) {
+                scoreElement = xml::Helper::getFirstChildElement(datedElement, "score");
+            }
+        }
+    }
+
+    return scoreElement;
+}
+
+void NoteTable::addNote(const Element& note) {
+    uint32_t rowFlags = 0;
+
+    auto dateAttr = note.attribute("date");
+    auto durationAttr = note.attribute("duration");
+    auto pitchAttr = note.attribute("midi.pitch");
+    auto velocityAttr = note.attribute("velocity");
+    auto idAttr = note.attribute("xml:id");
+
+    if (dateAttr) rowFlags |= HAS_DATE;
+    if (durationAttr) rowFlags |= HAS_DURATION;
+    if (pitchAttr) rowFlags |= HAS_PITCH;
+    if (velocityAttr) rowFlags |= HAS_VELOCITY;
+
+    elements.push_back(note);
+    date.push_back(dateAttr ? xml::NumberCodec::parseDouble(dateAttr.value()) : 0.0);
+    duration.push_back(durationAttr ? xml::NumberCodec::parseDouble(durationAttr.value()) : 0.0);
+    pitch.push_back(pitchAttr ? xml::NumberCodec::parseDouble(pitchAttr.value()) : 0.0);
+    velocity.push_back(velocityAttr ? xml::NumberCodec::parseDouble(velocityAttr.value()) : 0.0);
+    tempo.push_back(0.0);
+    millisecondsDate.push_back(0.0);
+    millisecondsDuration.push_back(0.0);
+
+    if (idAttr) {
+        idIndex.push_back(internId(idAttr.value()));
+    } else {
+        idIndex.push_back(-1);
+    }
+
+    flags.push_back(rowFlags);
+    rowsById.clear();
+}
+
+void NoteTable::addNote(double date, double duration, double pitch, double velocity, std::string_view id, uint32_t hasFlags) {
+    elements.emplace_back();
+    this->date.push_back(date);
+    this->duration.push_back(duration);
+    this->pitch.push_back(pitch);
+    this->velocity.push_back(velocity);
+    tempo.push_back(0.0);
+    millisecondsDate.push_back(0.0);
+    millisecondsDuration.push_back(0.0);
+
+    if (!id.empty()) {
+        idIndex.push_back(internId(id));
+    } else {
+        idIndex.push_back(-1);
+    }
+
+    flags.push_back(hasFlags & (DATE_CHANGED - 1));
+    rowsById.clear();
+}
+
+void NoteTable::append(const NoteTable& other) {
+    size_t offset = size();
+    int32_t idOffset = static_cast<int32_t>(idRanges.size());
+    uint32_t poolOffset = static_cast<uint32_t>(idPool.size());
+
+    elements.insert(elements.end(), other.elements.begin(), other.elements.end());
+    date.insert(date.end(), other.date.begin(), other.date.end());
+    duration.insert(duration.end(), other.duration.begin(), other.duration.end());
+    pitch.insert(pitch.end(), other.pitch.begin(), other.pitch.end());
+    velocity.insert(velocity.end(), other.velocity.begin(), other.velocity.end());
+    tempo.insert(tempo.end(), other.tempo.begin(), other.tempo.end());
+    millisecondsDate.insert(millisecondsDate.end(), other.millisecondsDate.begin(), other.millisecondsDate.end());
+    millisecondsDuration.insert(millisecondsDuration.end(), other.millisecondsDuration.begin(), other.millisecondsDuration.end());
+    flags.insert(flags.end(), other.flags.begin(), other.flags.end());
+    idPool += other.idPool;
+    for (const IdRange& range : other.idRanges) {
+        idRanges.push_back({range.offset + poolOffset, range.length});
+    }
+    for (int32_t index : other.idIndex) {
+        idIndex.push_back((index < 0) ? -1 : index + idOffset);
+    }
+    for (const auto& pending : other.pendingAttributes) {
+        pendingAttributes.push_back({pending.row + offset, pending.name, pending.value});
+    }
+    channelVolume.insert(channelVolume.end(), other.channelVolume.begin(), other.channelVolume.end());
+    rowsById.clear();
+}
+
+void NoteTable::clear() {
+    elements.clear();
+    date.clear();
+    duration.clear();
+    pitch.clear();
+    velocity.clear();
+    tempo.clear();
+    millisecondsDate.clear();
+    millisecondsDuration.clear();
+    idIndex.clear();
+    flags.clear();
+    idPool.clear();
+    idRanges.clear();
+    rowsById.clear();
+    pendingAttributes.clear();
+    channelVolume.clear();
+}
+
+int32_t NoteTable::internId(std::string_view id) {
+    idRanges.push_back({static_cast<uint32_t>(idPool.size()), static_cast<uint32_t>(id.size())});
+    idPool.append(id);
+    return static_cast<int32_t>(idRanges.size() - 1);
+}
+
+std::string_view NoteTable::getId(size_t row) const {
+    int32_t index = idIndex[row];
+    if (index < 0) {
+        return std::string_view();
+    }
+    const IdRange& range = idRanges[index];
+    return std::string_view(idPool.data() + range.offset, range.length);
+}
+
+long NoteTable::findRow(std::string_view id) const {
+    auto idOfRow = [this](size_t row) { return getId(row); };
+    if (!rowsById.isBuilt()) {
+        rowsById.build(size(), idOfRow);
+    }
+    return rowsById.find(id, idOfRow);
+}
+
+std::vector<size_t> NoteTable::getRowsInDateOrder() const {
+    std::vector<size_t> rows(size());
+    std::iota(rows.begin(), rows.end(), 0);
+
+    // scores are usually already in date order
+    if (!std::is_sorted(date.begin(), date.end())) {
+        std::stable_sort(rows.begin(), rows.end(), [this](size_t a, size_t b) { return date[a] < date[b]; });
+    }
+
+    return rows;
+}
+
+void NoteTable::convertPPQ(int ppq) {
+    if (ppq == this->ppq) {
+        return;
+    }
+
+    TimingScale scale(this->ppq, ppq);
+    for (size_t row = 0; row < flags.size(); ++row) {
+        if (flags[row] & HAS_DATE) {
+            setDate(row, scale.apply(date[row]));
+        }
+        if (flags[row] & HAS_DURATION) {
+            setDuration(row, scale.apply(duration[row]));
+        }
+    }
+    for (auto& event : channelVolume) {
+        event.date = scale.apply(event.date);
+    }
+    this->ppq = ppq;
+}
+
+void NoteTable::setDate(size_t row, double value) {
+    date[row] = value;
+    flags[row] |= HAS_DATE | DATE_CHANGED;
+}
+
+void NoteTable::setDuration(size_t row, double value) {
+    duration[row] = value;
+    flags[row] |= HAS_DURATION | DURATION_CHANGED;
+}
+
+void NoteTable::setVelocity(size_t row, double value) {
+    velocity[row] = value;
+    flags[row] |= HAS_VELOCITY | VELOCITY_CHANGED;
+}
+
+void NoteTable::setTempo(size_t row, double value) {
+    tempo[row] = value;
+    flags[row] |= TEMPO_CHANGED;
+}
+
+void NoteTable::setMilliseconds(size_t row, double dateMs, double durationMs) {
+    millisecondsDate[row] = dateMs;
+    millisecondsDuration[row] = durationMs;
+    flags[row] |= MILLISECONDS_CHANGED;
+}
+
+void NoteTable::addAttribute(size_t row, const std::string& name, const std::string& value) {
+    pendingAttributes.push_back({row, name, value});
+}
+
+void NoteTable::getChangedAttributes(size_t row, std::vector<std::pair<const char*, double>>& attributes) const {
+    attributes.clear();
+    uint32_t rowFlags = flags[row];
+    if (rowFlags & DATE_CHANGED) {
+        attributes.emplace_back("date", date[row]);
+    }
+    if (rowFlags & DURATION_CHANGED) {
+        attributes.emplace_back("duration", duration[row]);
+    }
+    if (rowFlags & VELOCITY_CHANGED) {
+        attributes.emplace_back("velocity", velocity[row]);
+    }
+    if (rowFlags & TEMPO_CHANGED) {
+        attributes.emplace_back("tempo", tempo[row]);
+    }
+    if (rowFlags & MILLISECONDS_CHANGED) {
+        attributes.emplace_back("milliseconds.date", millisecondsDate[row]);
+        attributes.emplace_back("milliseconds.date.end", millisecondsDate[row] + millisecondsDuration[row]);
+    }
+}
+
+void NoteTable::writeBack() {
+    std::vector<std::pair<const char*, double>> changed;
+    for (size_t row = 0; row < flags.size(); ++row) {
+        if (flags[row] < DATE_CHANGED) {    // nothing changed in this row
+            continue;
+        }
+
+        getChangedAttributes(row, changed);
+        for (const auto& attribute : changed) {
+            writeAttribute(elements[row], attribute.first, attribute.second);
+        }
+
+        flags[row] &= (DATE_CHANGED - 1);   // the row is in sync with the xml again
+    }
+
+    for (const auto& pending : pendingAttributes) {
+        writeAttribute(elements[pending.row], pending.name.c_str(), pending.value);
+    }
+    pendingAttributes.clear();
+
+    if (!channelVolume.empty() && score) {
+        Element dated = score.parent();
+        dated.remove_child("channelVolumeMap");
+        Element map = dated.insert_child_after("channelVolumeMap", score);
+        for (const auto& event : channelVolume) {
+            Element volume = map.append_child("volume");
+            writeAttribute(volume, "date", event.date);
+            writeAttribute(volume, "value", event.value);
+            if (event.mandatory) {
+                writeAttribute(volume, "mandatory", std::string("true"));
+            }
+            writeAttribute(volume, "milliseconds.date", event.millisecondsDate);
+        }
+        channelVolume.clear();
+    }
+}
+
+void NoteTable::writeBack(xml::XmlBase& document) {
+    writeBack();
+    document.markModified();
+}
+
+void NoteTable::writeAttribute(Element note, const char* name, double value) {
+    auto attr = note.attribute(name);
+    if (!attr) {
+        attr = note.append_attribute(name);
+    }
+    xml::NumberCodec::setValue(attr, value);
+}
+
+void NoteTable::writeAttribute(Element note, const char* name, const std::string& value) {
+    auto attr = note.attribute(name);
+    if (!attr) {
+        attr = note.append_attribute(name);
+    }
+    attr.set_value(value.c_str());
+}
+
+} // namespace msm
+} // namespace meico
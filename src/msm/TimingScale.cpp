@@ -0,0 +1,37 @@
+#include "msm/TimingScale.h"
+#include <cmath>
+#include <numeric>
+
+namespace meico {
+namespace msm {
+
+static const double EXACT_INTEGER_LIMIT = 9007199254740992.0;    // 2^53, up to here doubles hold integers exactly
+
+TimingScale::TimingScale(int fromPPQ, int toPPQ) {
+    if ((fromPPQ <= 0) || (toPPQ <= 0)) {
+        return;                                     // no valid resolution, leave the values as they are
+    }
+    int64_t divisor = std::gcd(static_cast<int64_t>(fromPPQ), static_cast<int64_t>(toPPQ));
+    numerator = toPPQ / divisor;
+    denominator = fromPPQ / divisor;
+}
+
+double TimingScale::apply(double value) const {
+    if (isIdentity()) {
+        return value;
+    }
+
+    // integers are multiplied exactly and divided once, the result is exact if it is an integer
+    double integral;
+    if ((std::modf(value, &integral) == 0.0) && (std::fabs(value) * numerator <= EXACT_INTEGER_LIMIT)) {
+        int64_t product = static_cast<int64_t>(value) * numerator;
+        if (product % denominator == 0) {
+            return static_cast<double>(product / denominator);
+        }
+        return static_cast<double>(product) / denominator;
+    }
+    return (value * numerator) / denominator;
+}
+
+} // namespace msm
+} // namespace meico
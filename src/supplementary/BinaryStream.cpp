@@ -0,0 +1,40 @@
+#include "supplementary/BinaryStream.h"
+
+namespace meico {
+namespace supplementary {
+
+void BinaryWriter::writeString(std::string_view value) {
+    writeUInt32(static_cast<uint32_t>(value.size()));
+    buffer.append(value.data(), value.size());
+}
+
+size_t BinaryWriter::reserveUInt64() {
+    size_t position = buffer.size();
+    writeUInt64(0);
+    return position;
+}
+
+void BinaryWriter::patchUInt64(size_t position, uint64_t value) {
+    if (position + sizeof(value) <= buffer.size()) {
+        std::memcpy(&buffer[position], &value, sizeof(value));
+    }
+}
+
+std::string_view BinaryReader::readString() {
+    uint32_t size = readUInt32();
+    const char* bytes = readBytes(size);
+    return bytes ? std::string_view(bytes, size) : std::string_view();
+}
+
+const char* BinaryReader::readBytes(size_t count) {
+    if (failed || (count > length - position)) {
+        failed = true;
+        return nullptr;
+    }
+    const char* bytes = data + position;
+    position += count;
+    return bytes;
+}
+
+} // namespace supplementary
+} // namespace meico
@@ -0,0 +1,114 @@
+#include "supplementary/ThreadPool.h"
+
+namespace meico {
+namespace supplementary {
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    concurrency = (threads == 0) ? 1 : threads;
+
+    for (unsigned i = 1; i < concurrency; ++i) {        // the calling thread is the first one
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::createThreadPool(unsigned threads) {
+    return std::make_shared<ThreadPool>(threads);
+}
+
+size_t ThreadPool::size() const {
+    return concurrency;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> run(runMutex);
+
+    if (workers.empty() || (count == 1)) {              // nothing to distribute
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->count = count;
+        next = 0;
+        active = workers.size();
+        error = nullptr;
+        ++generation;
+    }
+    wake.notify_all();
+
+    work();
+
+    std::exception_ptr thrown;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; });
+        this->task = nullptr;
+        thrown = error;
+        error = nullptr;
+    }
+
+    if (thrown) {
+        std::rethrow_exception(thrown);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen] { return stopping || (generation != seen); });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        work();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) {
+                done.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::work() {
+    for (size_t i = next++; i < count; i = next++) {
+        try {
+            (*task)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+}
+
+} // namespace supplementary
+} // namespace meico
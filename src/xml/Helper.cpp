@@ -1,4 +1,5 @@
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
 #include <fstream>
 #include <algorithm>
 #include <cctype>
@@ -64,11 +65,7 @@ bool Helper::writeStringToFile(const std::string& content, const std::string& fi
 }
 
 double Helper::parseDouble(const std::string& str, double defaultValue) {
-    try {
-        return std::stod(str);
-    } catch (const std::exception&) {
-        return defaultValue;
-    }
+    return NumberCodec::parseDouble(str, defaultValue);
 }
 
 bool Helper::parseBoolean(const std::string& str, bool defaultValue) {
@@ -83,33 +80,19 @@ bool Helper::parseBoolean(const std::string& str, bool defaultValue) {
 }
 
 int Helper::parseInt(const std::string& str, int defaultValue) {
-    try {
-        return std::stoi(str);
-    } catch (const std::exception&) {
-        return defaultValue;
-    }
+    return NumberCodec::parseInt(str, defaultValue);
 }
 
 short Helper::parseShort(const std::string& str, short defaultValue) {
-    try {
-        int value = std::stoi(str);
-        if (value >= std::numeric_limits<short>::min() && value <= std::numeric_limits<short>::max()) {
-            return static_cast<short>(value);
-        }
-        return defaultValue;
-    } catch (const std::exception&) {
-        return defaultValue;
+    int value;
+    if (NumberCodec::tryParse(str, value) && value >= std::numeric_limits<short>::min() && value <= std::numeric_limits<short>::max()) {
+        return static_cast<short>(value);
     }
+    return defaultValue;
 }
 
 bool Helper::isNumeric(const std::string& str) {
-    if (str.empty()) {
-        return false;
-    }
-    
-    char* end = nullptr;
-    std::strtod(str.c_str(), &end);
-    return end == str.c_str() + str.size();
+    return NumberCodec::isNumber(str);
 }
 
 std::string Helper::trim(const std::string& str) {
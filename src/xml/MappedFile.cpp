@@ -0,0 +1,49 @@
+#include "xml/MappedFile.h"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define MEICO_MEMORY_MAPPING
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace meico {
+namespace xml {
+
+MappedFile::~MappedFile() {
+#ifdef MEICO_MEMORY_MAPPING
+    munmap(address, length);
+#endif
+}
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& filePath) {
+#ifdef MEICO_MEMORY_MAPPING
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat status;
+    if ((fstat(fd, &status) != 0) || !S_ISREG(status.st_mode) || (status.st_size <= 0)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);                                    // the mapping stays valid without the descriptor
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);         // the readers go through the file front to back
+
+    return std::shared_ptr<MappedFile>(new MappedFile(static_cast<char*>(mapped), size));
+#else
+    (void)filePath;
+    return nullptr;
+#endif
+}
+
+} // namespace xml
+} // namespace meico
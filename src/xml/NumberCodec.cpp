@@ -0,0 +1,114 @@
+#include "xml/NumberCodec.h"
+#include <charconv>
+#include <cmath>
+
+namespace meico {
+namespace xml {
+
+const size_t NumberCodec::BUFFER_SIZE;
+
+/**
+ * Skip leading whitespace and a leading '+', std::from_chars accepts neither
+ * @param first the start of the string
+ * @param last the end of the string
+ * @return the start of the number
+ */
+static const char* skipPrefix(const char* first, const char* last) {
+    while ((first != last) && ((*first == ' ') || (*first == '\t') || (*first == '\n') || (*first == '\r'))) {
+        ++first;
+    }
+    if ((first != last) && (*first == '+') && ((first + 1) != last) && (first[1] != '-')) {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * Parse a number of any type supported by std::from_chars
+ * @param text the string
+ * @param value receives the parsed value
+ * @param end receives the position behind the number
+ * @return true if a number was parsed
+ */
+template<typename T>
+static bool parseNumber(std::string_view text, T& value, const char*& end) {
+    const char* last = text.data() + text.size();
+    const char* first = skipPrefix(text.data(), last);
+    T result;
+    auto [ptr, error] = std::from_chars(first, last, result);
+    if (error != std::errc()) {
+        return false;
+    }
+    value = result;
+    end = ptr;
+    return true;
+}
+
+bool NumberCodec::tryParse(std::string_view text, double& value) {
+    const char* end;
+    return parseNumber(text, value, end);
+}
+
+bool NumberCodec::tryParse(std::string_view text, int& value) {
+    const char* end;
+    return parseNumber(text, value, end);
+}
+
+bool NumberCodec::tryParse(std::string_view text, long& value) {
+    const char* end;
+    return parseNumber(text, value, end);
+}
+
+double NumberCodec::parseDouble(std::string_view text, double defaultValue) {
+    tryParse(text, defaultValue);
+    return defaultValue;
+}
+
+int NumberCodec::parseInt(std::string_view text, int defaultValue) {
+    tryParse(text, defaultValue);
+    return defaultValue;
+}
+
+long NumberCodec::parseLong(std::string_view text, long defaultValue) {
+    tryParse(text, defaultValue);
+    return defaultValue;
+}
+
+bool NumberCodec::isNumber(std::string_view text) {
+    double value;
+    const char* end;
+    return parseNumber(text, value, end) && (end == text.data() + text.size());
+}
+
+size_t NumberCodec::format(double value, char* buffer) {
+    char* last = buffer + BUFFER_SIZE - 1;
+    double magnitude = std::fabs(value);
+
+    // fixed notation is what the xml files usually contain, but it would be very long for extreme magnitudes
+    std::to_chars_result result = ((value == 0.0) || ((magnitude >= 1e-6) && (magnitude < 1e21)))
+                                  ? std::to_chars(buffer, last, value, std::chars_format::fixed)
+                                  : std::to_chars(buffer, last, value, std::chars_format::scientific);
+    *result.ptr = '\0';
+    return static_cast<size_t>(result.ptr - buffer);
+}
+
+size_t NumberCodec::format(long value, char* buffer) {
+    std::to_chars_result result = std::to_chars(buffer, buffer + BUFFER_SIZE - 1, value);
+    *result.ptr = '\0';
+    return static_cast<size_t>(result.ptr - buffer);
+}
+
+std::string NumberCodec::toString(double value) {
+    char buffer[BUFFER_SIZE];
+    size_t length = format(value, buffer);
+    return std::string(buffer, length);
+}
+
+bool NumberCodec::setValue(Attribute attribute, double value) {
+    char buffer[BUFFER_SIZE];
+    format(value, buffer);
+    return attribute.set_value(buffer);
+}
+
+} // namespace xml
+} // namespace meico
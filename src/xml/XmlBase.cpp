@@ -1,4 +1,5 @@
 #include "xml/XmlBase.h"
+#include "xml/MappedFile.h"
 #include <sstream>
 #include <functional>
 
@@ -37,11 +38,18 @@ XmlBase::XmlBase(std::istream& inputStream) : file(""), isValid(false) {
 
 void XmlBase::readFromFile(const std::string& filePath, bool validate, const std::string& schema) {
     this->file = filePath;
-    
-    pugi::xml_parse_result result = data.load_file(filePath.c_str());
+
+    // parse the file in place from a memory mapping, fall back to pugixml's own file loading
+    std::shared_ptr<MappedFile> mapping = MappedFile::open(filePath);
+    pugi::xml_parse_result result = mapping ? data.load_buffer_inplace(mapping->data(), mapping->size())
+                                            : data.load_file(filePath.c_str());
+    markModified();
     if (!result) {
+        data.reset();                                // a partial tree may point into the mapping that is released here
+        mappedFile.reset();
         throw ParsingException("Failed to parse XML file: " + std::string(result.description()));
     }
+    mappedFile = mapping;                            // the previous mapping, if any, is no longer referenced by the document
     
     parseFromResult(result);
     
@@ -54,6 +62,8 @@ void XmlBase::readFromFile(const std::string& filePath, bool validate, const std
 
 void XmlBase::readFromString(const std::string& xmlString, bool validate, const std::string& schema) {
     pugi::xml_parse_result result = data.load_string(xmlString.c_str());
+    markModified();
+    mappedFile.reset();
     if (!result) {
         throw ParsingException("Failed to parse XML string: " + std::string(result.description()));
     }
@@ -70,6 +80,10 @@ void XmlBase::readFromInputStream(std::istream& inputStream, bool validate, cons
     readFromString(xmlString, validate, schema);
 }
 
+bool XmlBase::isMemoryMapped() const {
+    return mappedFile != nullptr;
+}
+
 bool XmlBase::isEmpty() const {
     return data.first_child().empty();
 }
@@ -96,6 +110,50 @@ void XmlBase::setDocument(const Document& document) {
     for (auto node : document.children()) {
         data.append_copy(node);
     }
+    mappedFile.reset();
+    markModified();
+}
+
+uint64_t XmlBase::getRevision() const {
+    return revision;
+}
+
+void XmlBase::markModified() {
+    ++revision;
+}
+
+void XmlBase::buildIdIndex() const {
+    auto keyOf = [this](size_t index) { return std::string_view(idEntries[index].id); };
+    idEntries.clear();
+    Element root = getRootElement();
+    for (Element element = root; element; ) {
+        Attribute idAttr = element.attribute("xml:id");
+        if (idAttr) {
+            idEntries.push_back({element, idAttr.value()});
+        }
+
+        // pre-order traversal without recursion
+        if (element.first_child()) {
+            element = element.first_child();
+            continue;
+        }
+        while (element && (element != root) && !element.next_sibling()) {
+            element = element.parent();
+        }
+        element = (element && (element != root)) ? element.next_sibling() : Element();
+    }
+    elementsById.build(idEntries.size(), keyOf);
+    idRevision = revision;
+}
+
+Element XmlBase::getElementById(std::string_view id) const {
+    std::lock_guard<std::mutex> lock(idMutex);
+    if (idRevision != revision) {
+        buildIdIndex();
+    }
+
+    long index = elementsById.find(id, [this](size_t i) { return std::string_view(idEntries[i].id); });
+    return (index < 0) ? Element() : idEntries[index].element;
 }
 
 Element XmlBase::getRootElement() {
@@ -138,6 +196,9 @@ int XmlBase::removeAllElements(const std::string& localName) {
         }
     }
     
+    if (count > 0) {
+        markModified();
+    }
     return count;
 }
 
@@ -159,6 +220,9 @@ int XmlBase::removeAllAttributes(const std::string& attributeName) {
     };
     
     removeAttrRecursive(root);
+    if (count > 0) {
+        markModified();
+    }
     return count;
 }
 
@@ -1,9 +1,23 @@
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <set>
+#include <tuple>
+#include <atomic>
+#include <thread>
 #include "xml/XmlBase.h"
 #include "xml/Helper.h"
+#include "xml/NumberCodec.h"
 #include "msm/AbstractMsm.h"
 #include "msm/Msm.h"
+#include "msm/NoteTable.h"
+#include "msm/MsmStreamReader.h"
+#include "msm/MsmStreamWriter.h"
+#include "msm/MsmOverlay.h"
+#include "midi/Midi.h"
 #include "mpm/Mpm.h"
+#include "mpm/PerformanceCache.h"
+#include "mpm/PerformanceStream.h"
 #include "mpm/elements/Performance.h"
 #include "mpm/elements/Global.h"
 #include "mpm/elements/Part.h"
@@ -19,7 +33,10 @@
 #include "mpm/elements/maps/AsynchronyMap.h"
 #include "mpm/elements/maps/ImprecisionMap.h"
 #include "mpm/elements/metadata/Metadata.h"
+#include "supplementary/Timeline.h"
+#include "supplementary/ThreadPool.h"
 #include "mpm/MpmTestUtils.h"
+#include "capi/meico.h"
 
 using namespace meico;
 
@@ -50,6 +67,17 @@ int main() {
         std::string filename = "/path/to/file.ext";
         std::string withoutExt = xml::Helper::getFilenameWithoutExtension(filename);
         std::cout << "✓ Helper function test: " << withoutExt << std::endl;
+
+        // Test the numeric codec: shortest round-trip output and lenient parsing
+        bool roundTrip = true;
+        for (double value : {720.0, 0.1, 1.0 / 3.0, -2.5e-9, 123456789.125, 1e300}) {
+            roundTrip = roundTrip && (xml::NumberCodec::parseDouble(xml::NumberCodec::toString(value)) == value);
+        }
+        double unparsed = -1.0;
+        std::cout << "✓ NumberCodec: " << xml::NumberCodec::toString(720.0) << ", " << xml::NumberCodec::toString(0.1) << ", "
+                  << xml::NumberCodec::toString(1e-7) << ", round trip " << (roundTrip ? "exact" : "FAILED")
+                  << ", parsed \" +12.5\" as " << xml::NumberCodec::parseDouble(" +12.5")
+                  << ", \"Allegro\" is " << (xml::NumberCodec::tryParse("Allegro", unparsed) ? "numeric" : "not numeric") << std::endl;
         
         // Test AbstractMsm
         msm::AbstractMsm abstractMsm;
@@ -70,12 +98,90 @@ int main() {
         // Test MSM cloning
         auto clonedMsm = msm->clone();
         std::cout << "✓ MSM cloning successful: " << clonedMsm->getTitle() << std::endl;
+
+        // Test the exact PPQ conversion and the minimal PPQ of a score with triplets
+        msm::Msm tripletMsm(R"(<msm title="Triplets" pulsesPerQuarter="720"><part name="Piano" number="1"><dated><score>
+    <note date="0" duration="240" midi.pitch="60"/><note date="240" duration="240" midi.pitch="62"/><note date="480" duration="1200" midi.pitch="64"/>
+</score></dated></part></msm>)", true);
+        std::string tripletsBefore = tripletMsm.toXml();
+        int minimalPPQ = tripletMsm.getMinimalPPQ();
+        tripletMsm.convertPPQ(1000);
+        std::string tripletDate = tripletMsm.getRootElement().child("part").child("dated").child("score").last_child().attribute("date").value();
+        tripletMsm.convertPPQ(minimalPPQ);
+        tripletMsm.convertPPQ(720);
+        std::cout << "✓ Minimal PPQ of triplets: " << minimalPPQ << ", date 480 at 1000 ppq: " << tripletDate
+                  << ", converted back exactly: " << (tripletMsm.toXml() == tripletsBefore ? "yes" : "no") << std::endl;
+
+        // Test the xml:id indices of a note table and of the document
+        msm::Msm idMsm(R"(<msm title="Ids" pulsesPerQuarter="720"><part name="Piano" number="1"><dated><score>
+    <note xml:id="n1" date="0" duration="720" midi.pitch="60"/><note date="720" duration="720" midi.pitch="62"/><note xml:id="n3" date="1440" duration="720" midi.pitch="64"/>
+</score></dated></part></msm>)", true);
+        msm::NoteTable idTable(idMsm.getRootElement().child("part"));
+        Element noteN3 = idMsm.getElementById("n3");
+        bool foundBeforeRemoval = static_cast<bool>(noteN3);
+        noteN3.parent().remove_child(noteN3);
+        idMsm.markModified();
+        std::cout << "✓ Note n3 in row " << idTable.findRow("n3") << ", unknown id row " << idTable.findRow("n2")
+                  << ", element n3 found: " << (foundBeforeRemoval ? "yes" : "no") << ", after removal: " << (idMsm.getElementById("n3") ? "yes" : "no")
+                  << ", n1 pitch " << idMsm.getElementById("n1").attribute("midi.pitch").value() << std::endl;
+        msm::NoteTable idWriteTable(idMsm.getRootElement().child("part"));
+        idWriteTable.addAttribute(1, "xml:id", "n2");
+        idWriteTable.writeBack(idMsm);
+        Element noteN2 = idMsm.getElementById("n2");
+        if (!noteN2) {
+            std::cerr << "An id written back by a note table is not found" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Id written back by a note table found, n2 pitch " << noteN2.attribute("midi.pitch").value() << std::endl;
         
         // Test MPM creation
         auto mpm = mpm::Mpm::createMpm();
         std::cout << "✓ MPM created successfully" << std::endl;
         std::cout << "✓ MPM has " << mpm->size() << " performances" << std::endl;
         
+        // Test the lazy performance index of a multi-performance MPM
+        mpm::Mpm multiPerformanceMpm(R"(<mpm>
+    <performance name="Slow" xml:id="slow" pulsesPerQuarter="480"/>
+    <performance name="Fast" xml:id="fast" pulsesPerQuarter="960"/>
+    <performance name="Rubato" xml:id="rubato" pulsesPerQuarter="720"/>
+</mpm>)", true);
+        size_t materializedBefore = 0;
+        for (size_t i = 0; i < multiPerformanceMpm.size(); ++i) {
+            materializedBefore += multiPerformanceMpm.isPerformanceMaterialized(i) ? 1 : 0;
+        }
+        const mpm::Performance* fastPerformance = multiPerformanceMpm.getPerformance("Fast");
+        std::cout << "✓ Indexed " << multiPerformanceMpm.size() << " performances (" << materializedBefore << " materialized), \""
+                  << multiPerformanceMpm.getPerformanceName(2) << "\" has id " << multiPerformanceMpm.getPerformanceId(2)
+                  << ", \"Fast\" materialized at " << (fastPerformance ? fastPerformance->getPPQ() : 0) << " ppq, others materialized: "
+                  << (multiPerformanceMpm.isPerformanceMaterialized(0) || multiPerformanceMpm.isPerformanceMaterialized(2) ? "yes" : "no") << std::endl;
+
+        // Test parsing the global and part maps of a performance
+        mpm::Mpm mapsMpm(R"(<mpm>
+    <performance name="Maps" pulsesPerQuarter="720">
+        <global>
+            <dated>
+                <tempoMap><tempo date="0.0" bpm="120.0" beatLength="0.25"/></tempoMap>
+                <dynamicsMap><dynamics date="0.0" volume="80.0"/></dynamicsMap>
+                <unknownMap/>
+            </dated>
+        </global>
+        <part name="Piano" number="1" midi.channel="0" midi.port="0">
+            <dated>
+                <imprecisionMap.timing/>
+                <asynchronyMap><asynchrony date="0.0" milliseconds.offset="-20.0"/></asynchronyMap>
+            </dated>
+        </part>
+        <part name="Incomplete" number="2"/>
+    </performance>
+</mpm>)", true);
+        const mpm::Performance* mapsPerformance = mapsMpm.getPerformance("Maps");
+        const mpm::Part* pianoPart = mapsPerformance->getPart(0);
+        auto pianoImprecision = static_cast<const mpm::ImprecisionMap*>(pianoPart->getDated()->getMap(mpm::Mpm::IMPRECISION_MAP_TIMING));
+        auto globalTempo = static_cast<const mpm::TempoMap*>(mapsPerformance->getGlobal()->getDated()->getMap(mpm::Mpm::TEMPO_MAP));
+        std::cout << "✓ Parsed " << mapsPerformance->getGlobal()->getDated()->getMapCount() << " global maps at " << globalTempo->getTempoAt(0.0)
+                  << " bpm, " << mapsPerformance->getPartCount() << " part \"" << pianoPart->getName() << "\" with "
+                  << pianoPart->getDated()->getMapCount() << " maps, imprecision domain \"" << (pianoImprecision ? pianoImprecision->getDomain() : "") << "\"" << std::endl;
+
         // Test MpmTestUtils
         auto testMsm = test::MpmTestUtils::createSimpleMsm();
         std::cout << "✓ Test MSM created: " << testMsm->getTitle() << std::endl;
@@ -84,6 +190,188 @@ int main() {
         auto multiPartMsm = test::MpmTestUtils::createMultiPartMsm();
         std::cout << "✓ Multi-part MSM created: " << multiPartMsm->getTitle() << std::endl;
         
+        // Test the compiled note table of an MSM part
+        auto tableMsm = test::MpmTestUtils::createSimpleMsm();
+        Element tablePart = tableMsm->getRootElement().child("part");
+        msm::NoteTable noteTable(tablePart);
+        std::cout << "✓ NoteTable compiled " << noteTable.size() << " notes" << std::endl;
+        if (!noteTable.isEmpty()) {
+            noteTable.setVelocity(0, 42.0);
+            noteTable.writeBack();
+            msm::NoteTable reread(tablePart);
+            std::cout << "✓ NoteTable write-back velocity: " << reread.getVelocity(0) << std::endl;
+        }
+
+        // Test loading an MSM file in place from a memory mapping
+        std::string mappedPath = (std::filesystem::temp_directory_path() / "meico-test-mapped.msm").string();
+        if (tableMsm->writeToFile(mappedPath)) {
+            msm::Msm mappedMsm(mappedPath);
+            msm::NoteTable mappedTable(mappedMsm.getRootElement().child("part"));
+            mappedTable.setVelocity(0, 64.0);
+            mappedTable.writeBack();
+            msm::NoteTable mappedReread(mappedMsm.getRootElement().child("part"));
+            std::cout << "✓ Loaded MSM file (" << (mappedMsm.isMemoryMapped() ? "memory mapped" : "copied") << ") with "
+                      << mappedReread.size() << " notes, edited velocity: " << mappedReread.getVelocity(0) << std::endl;
+
+            // a file that fails to parse leaves an empty document, not one that points into the released mapping
+            {
+                std::ofstream brokenFile(mappedPath);
+                brokenFile << "<msm title=\"Broken\"><part name=\"Piano\"><dated><score><note date=\"0\"";
+            }
+            bool brokenRejected = false;
+            try {
+                mappedMsm.readFromFile(mappedPath);
+            } catch (const std::exception&) {
+                brokenRejected = true;
+            }
+            if (!brokenRejected || mappedMsm.getRootElement() || mappedMsm.isMemoryMapped()) {
+                std::cerr << "A file that failed to parse left a document behind" << std::endl;
+                return 1;
+            }
+            std::cout << "✓ Failed file parse leaves an empty, unmapped document" << std::endl;
+            std::filesystem::remove(mappedPath);
+        }
+
+        // Test the streaming MSM reader against the note tables compiled from the DOM
+        {
+            auto streamedMsm = test::MpmTestUtils::createMultiPartMsm();
+            Element streamedGlobal = streamedMsm->getGlobal().child("dated");
+            Element sequencingMap = streamedGlobal ? streamedGlobal.child("sequencingMap") : Element();
+            if (!sequencingMap && streamedGlobal) {
+                sequencingMap = streamedGlobal.append_child("sequencingMap");
+            }
+            sequencingMap.append_child("marker").append_attribute("date") = "0";
+            std::istringstream streamInput("<!-- streamed -->" + streamedMsm->toXml());
+            msm::MsmStreamReader reader(streamInput, 3);
+            std::vector<msm::NoteTable> streamedTables;
+            size_t batches = 0;
+            size_t mapElements = 0;
+            for (auto event = reader.next(); event != msm::MsmStreamReader::Event::END; event = reader.next()) {
+                if (event == msm::MsmStreamReader::Event::PART_BEGIN) {
+                    streamedTables.emplace_back();
+                } else if (event == msm::MsmStreamReader::Event::NOTES) {
+                    streamedTables.back().append(reader.getNotes());
+                    ++batches;
+                } else if (event == msm::MsmStreamReader::Event::MAP_ELEMENT) {
+                    ++mapElements;
+                }
+            }
+            size_t partIndex = 0;
+            for (auto part : streamedMsm->getRootElement().children("part")) {
+                msm::NoteTable domTable(part);
+                const msm::NoteTable& streamedTable = streamedTables.at(partIndex++);
+                for (size_t row = 0; row < domTable.size(); ++row) {
+                    if ((streamedTable.size() != domTable.size()) || (streamedTable.getDate(row) != domTable.getDate(row))
+                            || (streamedTable.getPitch(row) != domTable.getPitch(row)) || (streamedTable.getVelocity(row) != domTable.getVelocity(row))
+                            || (streamedTable.getFlags(row) != domTable.getFlags(row))) {
+                        std::cerr << "Streamed notes differ from the DOM notes in part " << partIndex << std::endl;
+                        return 1;
+                    }
+                }
+            }
+            std::cout << "✓ Streamed MSM: " << streamedTables.size() << " parts, " << batches << " note batches, "
+                      << mapElements << " map elements" << std::endl;
+
+            std::istringstream lowercaseInput(R"(<msm title="Lowercase" pulsesperquarter="480"><part name="Piano" number="1"><dated><score>
+    <note date="480" duration="480" midi.pitch="60"/>
+</score></dated></part></msm>)");
+            msm::MsmStreamReader lowercaseReader(lowercaseInput);
+            while ((lowercaseReader.next() != msm::MsmStreamReader::Event::END) && (lowercaseReader.getPPQ() != 480)) {}
+            if (lowercaseReader.getPPQ() != 480) {
+                std::cerr << "The streaming reader ignores the lowercase ppq attribute" << std::endl;
+                return 1;
+            }
+            std::cout << "✓ Streamed MSM with lowercase ppq attribute: " << lowercaseReader.getPPQ() << " ppq" << std::endl;
+        }
+        
+        // Test the sorted timeline container
+        supplementary::Timeline<int> timeline;
+        for (int i = 9; i >= 0; --i) {
+            timeline.insert(i * 100.0, i);
+        }
+        auto timelineRange = timeline.rangeOf(200.0, 500.0);
+        auto timelineCursor = timeline.cursor();
+        for (double date = -50.0; date < 1100.0; date += 25.0) {
+            if (timelineCursor.indexBeforeAt(date) != timeline.indexBeforeAt(date)) {
+                std::cerr << "Timeline cursor and binary search differ at " << date << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "✓ Timeline lookups: before/at 250 -> " << timeline.indexBeforeAt(250.0)
+                  << ", after 250 -> " << timeline.indexAfter(250.0)
+                  << ", range [200, 500) -> " << timelineRange.first << ".." << timelineRange.second << std::endl;
+        
+        // Test bulk loading against one-by-one insertion
+        auto singleDynamicsMap = mpm::DynamicsMap::createDynamicsMap();
+        auto bulkDynamicsMap = mpm::DynamicsMap::createDynamicsMap();
+        std::vector<std::unique_ptr<mpm::DynamicsData>> dynamicsBatch;
+        for (int i = 0; i < 1000; ++i) {
+            double date = ((i * 7919) % 1000) * 60.0;       // unsorted dates
+            singleDynamicsMap->addDynamics(date, std::to_string(40 + (i % 80)), std::to_string(40 + ((i + 1) % 80)), 0.3, 0.1);
+            auto data = std::make_unique<mpm::DynamicsData>();
+            data->startDate = date;
+            data->volume = 40 + (i % 80);
+            data->transitionTo = 40 + ((i + 1) % 80);
+            data->curvature = 0.3;
+            data->protraction = 0.1;
+            dynamicsBatch.push_back(std::move(data));
+        }
+        bulkDynamicsMap->addDynamics(std::move(dynamicsBatch));
+        for (double date = 0.0; date < 60000.0; date += 45.0) {
+            if (singleDynamicsMap->getDynamicsAt(date) != bulkDynamicsMap->getDynamicsAt(date)) {
+                std::cerr << "Bulk loaded dynamics differ at " << date << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "✓ Bulk loaded dynamics map matches one-by-one insertion" << std::endl;
+
+        // Test that entries at the same date keep the order in which they were added, by insertion as well as by batch
+        supplementary::Timeline<int> sameDateTimeline;
+        sameDateTimeline.insert(100.0, 1);
+        sameDateTimeline.insert(100.0, 2);
+        sameDateTimeline.insertAll({{100.0, 3}, {100.0, 4}});
+        sameDateTimeline.insert(100.0, 5);
+        sameDateTimeline.insert(50.0, 0);
+        auto sameDateSingleMap = mpm::DynamicsMap::createDynamicsMap();
+        auto sameDateBulkMap = mpm::DynamicsMap::createDynamicsMap();
+        std::vector<std::unique_ptr<mpm::DynamicsData>> sameDateBatch;
+        for (const char* volume : {"40", "80"}) {
+            sameDateSingleMap->addDynamics(480.0, volume, "", 0.0, 0.0);
+            auto data = std::make_unique<mpm::DynamicsData>();
+            data->startDate = 480.0;
+            data->volume = xml::NumberCodec::parseDouble(volume);
+            sameDateBatch.push_back(std::move(data));
+        }
+        sameDateBulkMap->addDynamics(std::move(sameDateBatch));
+        std::string sameDateOrder;
+        for (const auto& entry : sameDateTimeline) {
+            sameDateOrder += std::to_string(entry.getValue());
+        }
+        if ((sameDateOrder != "012345") || (sameDateSingleMap->getDynamicsAt(480.0) != sameDateBulkMap->getDynamicsAt(480.0))) {
+            std::cerr << "Entries at the same date are ordered differently by insertion and by batch: " << sameDateOrder << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Same-date entries in insertion order: " << sameDateOrder << ", dynamics at 480: " << sameDateSingleMap->getDynamicsAt(480.0) << std::endl;
+
+        // Test note-targeted articulations, they are found by the note's id
+        auto targetedMsm = test::MpmTestUtils::createSimpleMsm();
+        Element targetedPart = targetedMsm->getRootElement().child("part");
+        msm::NoteTable::findScore(targetedPart).child("note").next_sibling("note").append_attribute("xml:id") = "n2";
+        msm::NoteTable targetedTable(targetedPart);
+        auto targetedArticulationMap = mpm::ArticulationMap::createArticulationMap();
+        targetedArticulationMap->addArticulation(480.0, nullptr, 0.0, 1.0, nullptr, 0.0, 0.0, std::make_shared<double>(30.0), 1.0, 0.0, 0.0, 0.0, 0.0, "#n2");
+        targetedArticulationMap->addArticulation(960.0, nullptr, 0.0, 1.0, nullptr, 0.0, 0.0, std::make_shared<double>(70.0), 1.0, 0.0, 0.0, 0.0, 0.0);
+        msm::NoteTable untargetedTable(targetedPart);
+        targetedArticulationMap->applyToNoteTable(targetedTable);
+        if ((targetedTable.size() != 4) || (targetedTable.getVelocity(1) != 30.0) || (targetedTable.getVelocity(2) != 70.0)
+            || (targetedTable.getVelocity(0) != untargetedTable.getVelocity(0)) || (targetedTable.getVelocity(3) != untargetedTable.getVelocity(3))
+            || targetedTable.hasFlag(0, msm::NoteTable::VELOCITY_CHANGED) || targetedTable.hasFlag(3, msm::NoteTable::VELOCITY_CHANGED)) {
+            std::cerr << "Note-targeted articulation changed the wrong notes" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Note-targeted articulation velocities: " << targetedTable.getVelocity(0) << ", " << targetedTable.getVelocity(1)
+                  << ", " << targetedTable.getVelocity(2) << ", " << targetedTable.getVelocity(3) << std::endl;
+        
         // Print a test MSM for verification
         test::MpmTestUtils::printMsm(*testMsm, "Test MSM Structure");
         
@@ -177,7 +465,51 @@ int main() {
                      << ", startDate:" << tempoDataAt720->startDate
                      << ", endDate:" << tempoDataAt720->endDate << std::endl;
         }
-        
+
+        // Test the compiled milliseconds timing against integrating the segments one after the other
+        double expectedMs = mpm::TempoMap::computeDiffTiming(480.0, 720, testTempoMap->getTempoDataOf(0))
+                          + mpm::TempoMap::computeDiffTiming(960.0, 720, testTempoMap->getTempoDataOf(1))
+                          + mpm::TempoMap::computeDiffTiming(1200.0, 720, testTempoMap->getTempoDataOf(2));
+        double compiledMs = testTempoMap->getMillisecondsAt(1200.0, 720);
+        if (std::abs(compiledMs - expectedMs) > 1e-9) {
+            std::cerr << "Compiled tempo timing differs: " << compiledMs << " vs. " << expectedMs << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Milliseconds at dates 480, 960, 1200: " << testTempoMap->getMillisecondsAt(480.0, 720) << ", "
+                  << testTempoMap->getMillisecondsAt(960.0, 720) << ", " << compiledMs << std::endl;
+
+        // Test the inverse mapping from milliseconds to ticks
+        auto seekTempoMap = mpm::TempoMap::createTempoMap();
+        seekTempoMap->addTempo(720.0, "60", "150", 0.25, 0.3);
+        seekTempoMap->addTempo(2880.0, "150", "90", 0.25, 0.6);
+        seekTempoMap->addTempo(5040.0, 90.0);
+        for (double date = 0.0; date < 7200.0; date += 37.0) {
+            double seekMs = seekTempoMap->getMillisecondsAt(date, 720);
+            if (std::abs(seekTempoMap->getDateAtMilliseconds(seekMs, 720) - date) > 1e-6) {
+                std::cerr << "Inverse tempo mapping differs at " << date << ": " << seekTempoMap->getDateAtMilliseconds(seekMs, 720) << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "✓ Date at 1000, 2000, 4000 ms: " << seekTempoMap->getDateAtMilliseconds(1000.0, 720) << ", "
+                  << seekTempoMap->getDateAtMilliseconds(2000.0, 720) << ", " << seekTempoMap->getDateAtMilliseconds(4000.0, 720) << std::endl;
+
+        // Test Gauss-Legendre against Simpson integration of a long, curved accelerando
+        mpm::TempoData accelerando;
+        accelerando.startDate = 0.0;
+        accelerando.endDate = 720.0 * 64;
+        accelerando.bpm = 60.0;
+        accelerando.transitionTo = 180.0;
+        accelerando.meanTempoAt = 0.3;
+        double gaussError = 0.0;
+        double gaussMs = mpm::TempoMap::integrateTempoTransition(720.0 * 48, 720, &accelerando, gaussError);
+        double simpsonMs = mpm::TempoMap::computeDiffTiming(720.0 * 48, 720, &accelerando, mpm::TempoMap::Integration::SIMPSON);
+        if ((gaussError > 0.01) || (std::abs(gaussMs - simpsonMs) > 1.0)) {     // Simpson is less accurate at the curved start of the transition
+            std::cerr << "Gauss-Legendre and Simpson integration differ: " << gaussMs << " vs. " << simpsonMs << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Tempo transition integration: Gauss-Legendre " << gaussMs << " ms (error < " << gaussError
+                  << "), Simpson " << simpsonMs << " ms" << std::endl;
+
         // Verify transformation worked
         bool hasVelocityChanges = test::MpmTestUtils::verifyMsmModifications(*resultMsm, {"velocity"});
         if (hasVelocityChanges) {
@@ -264,6 +596,34 @@ int main() {
         if (ornamentRetrievedData) {
             std::cout << "✓ Ornament data retrieval working - ornament: " << ornamentRetrievedData->ornamentDefName << " at date: " << ornamentRetrievedData->date << std::endl;
         }
+
+        // Test ornament application to a chord
+        auto chordMsm = test::MpmTestUtils::createSimpleMsm();
+        Element chordPart = chordMsm->getRootElement().child("part");
+        Element chordNote = msm::NoteTable::findScore(chordPart).append_child("note");
+        chordNote.append_attribute("date") = "960.0";
+        chordNote.append_attribute("midi.pitch") = "67";
+        chordNote.append_attribute("duration") = "480.0";
+        msm::NoteTable chordTable(chordPart);
+        mpm::OrnamentationMap::Report ornamentReport;
+        testOrnamentationMap->applyToNoteTable(chordTable, ornamentReport);
+        std::cout << "✓ Ornament report: " << ornamentReport.ornaments << " ornaments, " << ornamentReport.chords
+                  << " chords, " << ornamentReport.notes << " notes" << std::endl;
+
+        // Notes whose dates differ less than the tolerance belong to the same chord as the ornament
+        Element nearChordNote = msm::NoteTable::findScore(chordPart).append_child("note");
+        nearChordNote.append_attribute("date") = "960.0000001";
+        nearChordNote.append_attribute("midi.pitch") = "72";
+        nearChordNote.append_attribute("duration") = "480.0";
+        msm::NoteTable nearChordTable(chordPart);
+        mpm::OrnamentationMap::Report nearChordReport;
+        testOrnamentationMap->applyToNoteTable(nearChordTable, nearChordReport);
+        if ((nearChordReport.chords != ornamentReport.chords) || (nearChordReport.notes != ornamentReport.notes + 1)) {
+            std::cerr << "Ornamented chords differ with a note within the date tolerance" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Ornamented chord with a note within the date tolerance: " << nearChordReport.notes << " notes in "
+                  << nearChordReport.chords << " chords" << std::endl;
         
         std::cout << "\n🎉 All tests passed! OrnamentationMap has been successfully implemented!" << std::endl;
         
@@ -365,6 +725,355 @@ int main() {
         
         std::cout << "✓ Tuning imprecision detune unit: " << testTuningImprecisionMap->getDetuneUnit() << std::endl;
         
+        // Test that the fused map pipeline renders the same result as the sequential one
+        std::cout << "\nTesting fused map application..." << std::endl;
+        auto combinedMpm = test::MpmTestUtils::createMpmWithCombinedMaps();
+        auto* combinedPerformance = combinedMpm->getPerformance(0);
+        combinedPerformance->setMapApplication(mpm::Performance::MapApplication::SEQUENTIAL);
+        auto sequentialResult = combinedPerformance->perform(*multiPartMsm);
+        combinedPerformance->setMapApplication(mpm::Performance::MapApplication::FUSED);
+        auto fusedResult = combinedPerformance->perform(*multiPartMsm);
+        if (sequentialResult->toXml() != fusedResult->toXml()) {
+            std::cerr << "Fused and sequential map application differ" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Fused map application matches sequential application" << std::endl;
+
+        // Test concurrent part rendering against serial rendering
+        combinedPerformance->setThreadPool(supplementary::ThreadPool::createThreadPool(4));
+        auto concurrentResult = combinedPerformance->perform(*multiPartMsm);
+        combinedPerformance->setThreadPool(nullptr);
+        if (concurrentResult->toXml() != fusedResult->toXml()) {
+            std::cerr << "Concurrent and serial part rendering differ" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Concurrent part rendering matches serial rendering" << std::endl;
+
+        // Test streaming the rendered performance against writing the rendered document
+        std::ostringstream streamedOutput;
+        msm::MsmStreamWriter streamWriter(streamedOutput);
+        combinedPerformance->perform(*multiPartMsm, streamWriter);
+        std::ostringstream compactOutput;
+        msm::MsmStreamWriter compactWriter(compactOutput, true);
+        combinedPerformance->perform(*multiPartMsm, compactWriter);
+        msm::Msm compactMsm(compactOutput.str(), true);
+        combinedPerformance->setPPQ(480);
+        auto convertedResult = combinedPerformance->perform(*multiPartMsm);
+        std::ostringstream convertedOutput;
+        msm::MsmStreamWriter convertedWriter(convertedOutput);
+        combinedPerformance->perform(*multiPartMsm, convertedWriter);
+        combinedPerformance->setPPQ(720);
+        if ((streamedOutput.str() != fusedResult->toXml()) || (compactMsm.toXml() != fusedResult->toXml())
+                || (convertedOutput.str() != convertedResult->toXml())) {
+            std::cerr << "Streamed performance differs from the rendered document" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Streamed performance matches the rendered document (" << compactOutput.str().size() << " bytes compact, "
+                  << streamedOutput.str().size() << " bytes indented)" << std::endl;
+
+        // Test rendering into overlays of the unaltered score against the rendered documents
+        std::string scoreBefore = multiPartMsm->toXml();
+        auto overlay = combinedPerformance->performOverlay(*multiPartMsm);
+        combinedPerformance->setPPQ(480);
+        auto convertedOverlay = combinedPerformance->performOverlay(*multiPartMsm);
+        combinedPerformance->setPPQ(720);
+        std::ostringstream overlayOutput;
+        msm::MsmStreamWriter overlayWriter(overlayOutput);
+        overlay->write(overlayWriter);
+        if ((overlay->materialize()->toXml() != fusedResult->toXml()) || (overlayOutput.str() != fusedResult->toXml())
+                || (convertedOverlay->materialize()->toXml() != convertedResult->toXml()) || (multiPartMsm->toXml() != scoreBefore)) {
+            std::cerr << "Performance overlay differs from the rendered document" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Performance overlays match the rendered documents, " << overlay->getPartCount() << " parts, score unaltered" << std::endl;
+
+        // Test the Standard MIDI File export from the overlay against the export from the rendered document
+        auto expressiveMidi = overlay->exportExpressiveMidi();
+        auto materializedMidi = overlay->materialize()->exportExpressiveMidi();
+        auto rawMidi = multiPartMsm->exportMidi(90.0);
+        if (!expressiveMidi || !materializedMidi || !rawMidi || (expressiveMidi->getData() != materializedMidi->getData())) {
+            std::cerr << "Expressive MIDI of the overlay differs from the rendered document" << std::endl;
+            return 1;
+        }
+        const uint8_t emptyTextEvent[] = {0xFF, 0x01, 0x00};
+        if (std::search(rawMidi->getData().begin(), rawMidi->getData().end(), std::begin(emptyTextEvent), std::end(emptyTextEvent)) != rawMidi->getData().end()) {
+            std::cerr << "Raw MIDI contains empty text events for notes without an id" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Expressive MIDI: " << expressiveMidi->size() << " bytes, " << expressiveMidi->getTrackCount() << " tracks at "
+                  << expressiveMidi->getPPQ() << " ppq, raw MIDI: " << rawMidi->size() << " bytes, starts with "
+                  << std::string(rawMidi->getData().begin(), rawMidi->getData().begin() + 4) << std::endl;
+
+        // Test the channel volume events of sub-note dynamics
+        msm::Msm crescendoMsm(R"(<msm title="Crescendo" pulsesPerQuarter="720"><part name="Piano" number="1" midi.channel="0" midi.port="0"><dated><score>
+    <note date="0" duration="720" midi.pitch="60"/><note date="1440" duration="720" midi.pitch="62"/><note date="2880" duration="720" midi.pitch="64"/><note date="5760" duration="720" midi.pitch="65"/>
+</score></dated></part></msm>)", true);
+        mpm::Mpm crescendoMpm(R"(<mpm><performance name="Crescendo" pulsesPerQuarter="720"><global><dated>
+    <tempoMap><tempo date="0.0" bpm="120.0" beatLength="0.25"/></tempoMap>
+    <dynamicsMap><dynamics date="0.0" volume="30.0" transition.to="110.0" subNoteDynamics="true"/><dynamics date="5760.0" volume="90.0"/></dynamicsMap>
+</dated></global></performance></mpm>)", true);
+        const mpm::Performance* crescendoPerformance = crescendoMpm.getPerformance("Crescendo");
+        auto crescendoOverlay = crescendoPerformance->performOverlay(crescendoMsm);
+        auto crescendoResult = crescendoPerformance->perform(crescendoMsm);
+        const auto& channelVolume = crescendoOverlay->getNoteTable(0).getChannelVolume();
+        double minimalDistance = 1e9;
+        for (size_t i = 1; i + 1 < channelVolume.size(); ++i) {
+            minimalDistance = std::min(minimalDistance, channelVolume[i].millisecondsDate - channelVolume[i - 1].millisecondsDate);
+        }
+        mpm::DynamicsData crescendoData;
+        crescendoData.volume = 30.0;
+        crescendoData.transitionTo = 110.0;
+        crescendoData.transitionToString = "110.0";
+        crescendoData.endDate = 5760.0;
+        size_t bisectedCount = crescendoData.getSubNoteDynamicsSegment(2.0).size();
+        auto crescendoMidi = crescendoOverlay->exportExpressiveMidi();
+        if (channelVolume.empty() || (crescendoResult->toXml() != crescendoOverlay->materialize()->toXml())
+                || (crescendoMidi->getData() != crescendoResult->exportExpressiveMidi()->getData())) {
+            std::cerr << "Sub-note dynamics differ between overlay and rendered document" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Sub-note dynamics: " << channelVolume.size() << " channel volume events (bisection with step 2: " << bisectedCount
+                  << "), " << channelVolume.front().value << " -> " << channelVolume[channelVolume.size() - 2].value << " -> " << channelVolume.back().value
+                  << ", minimal distance " << (minimalDistance >= msm::Msm::CONTROL_CHANGE_DENSITY ? ">= " : "< ") << msm::Msm::CONTROL_CHANGE_DENSITY
+                  << " ms, note velocities " << crescendoOverlay->getNoteTable(0).getVelocity(1) << " and " << crescendoOverlay->getNoteTable(0).getVelocity(3)
+                  << ", MIDI " << crescendoMidi->size() << " bytes" << std::endl;
+
+        // Test the MIDI import against the exported MIDI and with running status in a format 0 file
+        auto importedMsm = rawMidi->exportMsm();
+        auto reexportedMidi = importedMsm ? importedMsm->exportMidi(90.0) : nullptr;
+        if (!reexportedMidi || (reexportedMidi->getData() != rawMidi->getData())) {
+            std::cerr << "MIDI import does not reproduce the exported MIDI" << std::endl;
+            return 1;
+        }
+        midi::Midi formatZeroMidi(std::vector<uint8_t>{
+            'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xE0, 'M', 'T', 'r', 'k', 0, 0, 0, 32,
+            0x00, 0xFF, 0x59, 0x02, 0xFE, 0x00,         // key signature with 2 flats
+            0x00, 0xC1, 0x28,                           // program change to violin on channel 1
+            0x00, 0x91, 60, 90, 0x00, 64, 80,           // two note ons, the second with running status
+            0x83, 0x60, 60, 0x00,                       // note off by velocity 0 after 480 ticks
+            0x00, 0x81, 64, 0x00,                       // note off
+            0x00, 0x91, 67, 70,                         // a note without note off
+            0x60, 0xFF, 0x2F, 0x00});
+        auto formatZeroMsm = formatZeroMidi.exportMsm();
+        Element formatZeroPart = formatZeroMsm->getRootElement().child("part");
+        Element lastNote = formatZeroPart.child("dated").child("score").last_child();
+        std::cout << "✓ MIDI import: " << importedMsm->getRootElement().select_nodes("part/dated/score/note").size() << " notes in "
+                  << importedMsm->getRootElement().select_nodes("part").size() << " parts, reexported identically; format 0: \""
+                  << formatZeroPart.attribute("name").value() << "\" on channel " << formatZeroPart.attribute("midi.channel").value() << ", "
+                  << formatZeroMsm->getGlobal().child("dated").child("keySignatureMap").child("keySignature").select_nodes("accidental").size()
+                  << " flats, last note duration " << lastNote.attribute("duration").value() << std::endl;
+
+        // Test the spelling of imported notes by the key signature of the conductor track that is in force at each note
+        midi::Midi spellingMidi(std::vector<uint8_t>{
+            'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0x01, 0xE0,
+            'M', 'T', 'r', 'k', 0, 0, 0, 17,
+            0x00, 0xFF, 0x59, 0x02, 0xFE, 0x00,         // key signature with 2 flats
+            0x83, 0x60, 0xFF, 0x59, 0x02, 0x00, 0x00,   // C major after 480 ticks
+            0x00, 0xFF, 0x2F, 0x00,
+            'M', 'T', 'r', 'k', 0, 0, 0, 32,
+            0x00, 0x90, 70, 80, 0x81, 0x70, 0x80, 70, 0x00,     // pitch 70 in the flat key
+            0x81, 0x70, 0x90, 70, 80, 0x81, 0x70, 0x80, 70, 0x00,   // pitch 70 in C major
+            0x00, 0x90, 61, 80, 0x81, 0x70, 0x80, 61, 0x00,     // pitch 61 in C major
+            0x00, 0xFF, 0x2F, 0x00});
+        auto spellingMsm = spellingMidi.exportMsm();
+        std::string spelling;
+        for (auto note : spellingMsm->getRootElement().select_nodes("part/dated/score/note")) {
+            spelling += std::string(spelling.empty() ? "" : " ") + note.node().attribute("pitchname").value()
+                        + note.node().attribute("accidentals").value();
+        }
+        if (spelling != "B-1 A1 C1") {
+            std::cerr << "Imported notes are not spelled by the key signature in force: " << spelling << std::endl;
+            return 1;
+        }
+        std::cout << "✓ MIDI import spelling by the key in force: " << spelling << std::endl;
+
+        // Test pulling the events of the performance in time slices against the rendered overlay
+        auto performanceStream = combinedPerformance->performStream(*multiPartMsm);
+        performanceStream->setWindowLength(240.0);
+        std::vector<mpm::PerformanceStream::Event> streamedEvents;
+        size_t firstSliceEvents = performanceStream->next(100.0, streamedEvents);
+        size_t firstSliceWindows = performanceStream->getRenderedWindowCount();
+        size_t slices = 1;
+        for (; !performanceStream->isFinished(); ++slices) {
+            performanceStream->next(100.0, streamedEvents);
+        }
+        std::multiset<std::tuple<double, int, int, int>> expectedNotes;
+        std::multiset<std::tuple<double, int, int, int>> streamedNotes;
+        for (size_t p = 0; p < overlay->getPartCount(); ++p) {
+            const msm::NoteTable& notes = overlay->getNoteTable(p);
+            for (size_t row = 0; row < notes.size(); ++row) {
+                expectedNotes.emplace(notes.getMillisecondsDate(row), static_cast<int>(p), static_cast<int>(std::lround(notes.getPitch(row))),
+                                      static_cast<int>(std::lround(static_cast<float>(notes.getVelocity(row)))));
+            }
+        }
+        for (const auto& event : streamedEvents) {
+            if (event.type == mpm::PerformanceStream::EventType::NOTE_ON) {
+                streamedNotes.emplace(event.milliseconds, event.part, event.data1, event.data2);
+            }
+        }
+        bool timeOrdered = std::is_sorted(streamedEvents.begin(), streamedEvents.end(), [](const auto& a, const auto& b) {
+            return a.milliseconds < b.milliseconds;
+        });
+        if (!timeOrdered || (streamedNotes != expectedNotes)) {
+            std::cerr << "Streamed events differ from the rendered overlay" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Performance stream: " << streamedEvents.size() << " events in " << slices << " slices of 100 ms, first slice "
+                  << firstSliceEvents << " events after " << firstSliceWindows << " of " << performanceStream->getRenderedWindowCount()
+                  << " windows, notes match the overlay" << std::endl;
+
+        // Test the C interface: the flat note arrays hold the notes of the overlay sorted by onset
+        std::string capiMsmXml = R"(<msm title="Duet" pulsesPerQuarter="720">
+<part name="Violin" number="1" midi.channel="0" midi.port="0"><dated><score>
+    <note date="0" duration="720" midi.pitch="76" velocity="80"/><note date="720" duration="720" midi.pitch="74"/><note date="1440" duration="1440" midi.pitch="72"/>
+</score></dated></part>
+<part name="Cello" number="2" midi.channel="1" midi.port="0"><dated><score>
+    <note date="0" duration="1440" midi.pitch="48"/><note date="1440" duration="1440" midi.pitch="43"/>
+</score></dated></part></msm>)";
+        std::string capiMpmXml = R"(<mpm><performance name="Duet" pulsesPerQuarter="720">
+<global><dated>
+    <tempoMap><tempo date="0.0" bpm="100.0" transition.to="60.0" beatLength="0.25"/><tempo date="2880.0" bpm="60.0" beatLength="0.25"/></tempoMap>
+    <dynamicsMap><dynamics date="0.0" volume="60.0" transition.to="90.0"/><dynamics date="1440.0" volume="90.0"/></dynamicsMap>
+</dated></global>
+<part name="Cello" number="2" midi.channel="1" midi.port="0"><dated>
+    <dynamicsMap><dynamics date="0.0" volume="70.0"/></dynamicsMap>
+</dated></part></performance></mpm>)";
+        msm::Msm capiReferenceMsm(capiMsmXml, true);
+        mpm::Mpm capiReferenceMpm(capiMpmXml, true);
+        auto capiOverlay = capiReferenceMpm.getPerformance("Duet")->performOverlay(capiReferenceMsm);
+        std::multiset<std::tuple<double, int, int, int>> capiExpectedNotes;
+        for (size_t p = 0; p < capiOverlay->getPartCount(); ++p) {
+            const msm::NoteTable& notes = capiOverlay->getNoteTable(p);
+            for (size_t row = 0; row < notes.size(); ++row) {
+                bool hasVelocity = notes.hasFlag(row, msm::NoteTable::HAS_VELOCITY) || notes.hasFlag(row, msm::NoteTable::VELOCITY_CHANGED);
+                capiExpectedNotes.emplace(notes.getMillisecondsDate(row), static_cast<int>(p), static_cast<int>(std::lround(notes.getPitch(row))),
+                                          static_cast<int>(std::lround(hasVelocity ? notes.getVelocity(row) : 100.0)));
+            }
+        }
+        meico_msm* capiMsm = meico_msm_load(capiMsmXml.data(), capiMsmXml.size());
+        meico_mpm* capiMpm = meico_mpm_load(capiMpmXml.data(), capiMpmXml.size());
+        std::string capiPerformanceName = (meico_mpm_performance_count(capiMpm) == 1) ? meico_mpm_performance_name(capiMpm, 0) : "";
+        meico_rendering* rendering = meico_render_by_name(capiMpm, capiPerformanceName.c_str(), capiMsm);
+        if (!rendering) {
+            std::cerr << "C interface rendering failed: " << meico_last_error() << std::endl;
+            return 1;
+        }
+
+        // the handles are only read while rendering, so they can be rendered from several threads at once
+        std::atomic<int> capiMismatches{0};
+        std::vector<std::thread> capiThreads;
+        for (int t = 0; t < 4; ++t) {
+            capiThreads.emplace_back([&]() {
+                size_t expectedCount = 0;
+                const double* expectedOnsets = meico_rendering_onsets(rendering, &expectedCount);
+                for (int i = 0; i < 25; ++i) {
+                    meico_rendering* concurrentRendering = meico_render(capiMpm, 0, capiMsm);
+                    size_t concurrentCount = 0;
+                    const double* concurrentOnsets = meico_rendering_onsets(concurrentRendering, &concurrentCount);
+                    if (!concurrentRendering || (concurrentCount != expectedCount)
+                        || !std::equal(concurrentOnsets, concurrentOnsets + concurrentCount, expectedOnsets)) {
+                        ++capiMismatches;
+                    }
+                    meico_rendering_free(concurrentRendering);
+                }
+            });
+        }
+        for (auto& thread : capiThreads) {
+            thread.join();
+        }
+        meico_mpm_free(capiMpm);
+        meico_msm_free(capiMsm);
+        if (capiMismatches > 0) {
+            std::cerr << "Concurrent C interface renderings differ in " << capiMismatches << " cases" << std::endl;
+            return 1;
+        }
+        size_t onsetCount = 0, durationCount = 0, pitchCount = 0, velocityCount = 0, partIndexCount = 0;
+        const double* onsets = meico_rendering_onsets(rendering, &onsetCount);
+        const double* durations = meico_rendering_durations(rendering, &durationCount);
+        const double* pitches = meico_rendering_pitches(rendering, &pitchCount);
+        const double* velocities = meico_rendering_velocities(rendering, &velocityCount);
+        const uint32_t* partIndices = meico_rendering_parts(rendering, &partIndexCount);
+        size_t noteCount = meico_rendering_note_count(rendering);
+        std::multiset<std::tuple<double, int, int, int>> renderedNotes;
+        for (size_t i = 0; i < noteCount; ++i) {
+            renderedNotes.emplace(onsets[i], static_cast<int>(partIndices[i]), static_cast<int>(std::lround(pitches[i])),
+                                  static_cast<int>(std::lround(velocities[i])));
+        }
+        if ((onsetCount != noteCount) || (durationCount != noteCount) || (pitchCount != noteCount) || (velocityCount != noteCount)
+            || (partIndexCount != noteCount) || !std::is_sorted(onsets, onsets + noteCount) || (renderedNotes != capiExpectedNotes)
+            || !std::all_of(durations, durations + noteCount, [](double duration) { return duration > 0.0; })
+            || (meico_rendering_part_count(rendering) != capiOverlay->getPartCount())) {
+            std::cerr << "C interface notes differ from the rendered overlay" << std::endl;
+            return 1;
+        }
+        double firstOnset = onsets[0];
+        std::string firstPartName = meico_rendering_part_name(rendering, partIndices[0]);
+        int firstPartChannel = meico_rendering_part_channel(rendering, partIndices[0]);
+        meico_rendering_free(rendering);
+        meico_msm* invalidMsm = meico_msm_load("<msm", 4);
+        std::string loadError = meico_last_error();
+        if (invalidMsm || loadError.empty() || meico_render(nullptr, 0, nullptr)) {
+            std::cerr << "C interface accepted invalid input" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ C API: \"" << capiPerformanceName << "\" rendered " << noteCount << " notes in " << capiOverlay->getPartCount() << " parts sorted by onset, first at "
+                  << firstOnset << " ms in part \"" << firstPartName << "\" on channel " << firstPartChannel << ", invalid input reported: " << loadError
+                  << ", 100 concurrent renderings equal" << std::endl;
+
+        // Test the timing of an MSM whose ppq is given by the all lowercase attribute
+        std::string lowercaseMsmXml = R"(<msm title="Lowercase" pulsesperquarter="480"><part name="Piano" number="1" midi.channel="0" midi.port="0"><dated><score>
+    <note date="480" duration="480" midi.pitch="60"/>
+</score></dated></part></msm>)";
+        std::string lowercaseMpmXml = R"(<mpm><performance name="Lowercase" pulsesPerQuarter="480"><global><dated>
+    <tempoMap><tempo date="0.0" bpm="60.0" beatLength="0.25"/></tempoMap>
+</dated></global></performance></mpm>)";
+        msm::Msm lowercaseMsm(lowercaseMsmXml, true);
+        mpm::Mpm lowercaseMpm(lowercaseMpmXml, true);
+        auto lowercaseOverlay = lowercaseMpm.getPerformance("Lowercase")->performOverlay(lowercaseMsm);
+        meico_msm* lowercaseCapiMsm = meico_msm_load(lowercaseMsmXml.data(), lowercaseMsmXml.size());
+        meico_mpm* lowercaseCapiMpm = meico_mpm_load(lowercaseMpmXml.data(), lowercaseMpmXml.size());
+        meico_rendering* lowercaseRendering = meico_render(lowercaseCapiMpm, 0, lowercaseCapiMsm);
+        const msm::NoteTable& lowercaseNotes = lowercaseOverlay->getNoteTable(0);
+        bool lowercaseTimed = lowercaseRendering && (meico_rendering_note_count(lowercaseRendering) == 1)
+                              && (std::abs(meico_rendering_onsets(lowercaseRendering, nullptr)[0] - 1000.0) < 1e-6)
+                              && (std::abs(lowercaseNotes.getMillisecondsDate(0) - 1000.0) < 1e-6)
+                              && (std::abs(lowercaseNotes.getMillisecondsDuration(0) - 1000.0) < 1e-6);
+        meico_rendering_free(lowercaseRendering);
+        meico_mpm_free(lowercaseCapiMpm);
+        meico_msm_free(lowercaseCapiMsm);
+        if (!lowercaseTimed) {
+            std::cerr << "An MSM with the lowercase ppq attribute is timed wrong: " << lowercaseNotes.getMillisecondsDate(0) << " ms" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Lowercase ppq attribute: note at date 480 at " << lowercaseNotes.getMillisecondsDate(0) << " ms for "
+                  << lowercaseNotes.getMillisecondsDuration(0) << " ms" << std::endl;
+
+        // Test the binary performance cache: the cached performance renders the same result and a stale cache is rejected
+        std::string cachePath = (std::filesystem::temp_directory_path() / "meico-test-performance.cache").string();
+        std::string cachedMpmPath = (std::filesystem::temp_directory_path() / "meico-test-performance.mpm").string();
+        mpm::PerformanceCache::writeToFile(*combinedPerformance, cachePath, 42);
+        auto cachedPerformance = mpm::PerformanceCache::readFromFile(cachePath, 42);
+        auto staleCache = mpm::PerformanceCache::readFromFile(cachePath, 43);
+        if (!cachedPerformance || staleCache || (cachedPerformance->perform(*multiPartMsm)->toXml() != fusedResult->toXml())) {
+            std::cerr << "Cached performance differs from the compiled performance" << std::endl;
+            return 1;
+        }
+        {
+            std::ofstream cachedMpmFile(cachedMpmPath);
+            cachedMpmFile << "<mpm><performance name=\"Cached Performance\" pulsesPerQuarter=\"480\"/></mpm>";
+        }
+        std::filesystem::remove(cachePath);
+        auto compiledPerformance = mpm::PerformanceCache::load(cachedMpmPath, cachePath);     // compiles the MPM and writes the cache
+        auto loadedPerformance = mpm::PerformanceCache::load(cachedMpmPath, cachePath);       // reads the cache
+        if (!compiledPerformance || !loadedPerformance) {
+            std::cerr << "Performance cache could not be loaded" << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Performance cache renders like the compiled performance, loaded \"" << loadedPerformance->getName()
+                  << "\" at " << loadedPerformance->getPPQ() << " ppq" << std::endl;
+        std::filesystem::remove(cachePath);
+        std::filesystem::remove(cachedMpmPath);
+        
         std::cout << "\n🎉 All tests passed! ImprecisionMap has been successfully implemented!" << std::endl;
         
         std::cout << "\n🎆 ALL NINE MAPS SUCCESSFULLY IMPLEMENTED! 🎆" << std::endl;
@@ -273,5 +273,49 @@ std::unique_ptr<mpm::Mpm> MpmTestUtils::createMpmWithRubatoMap() {
     return mpm;
 }
 
+std::unique_ptr<mpm::Mpm> MpmTestUtils::createMpmWithCombinedMaps() {
+    auto mpm = createBasicMpm();
+    
+    if (mpm->size() > 0) {
+        auto* performance = mpm->getPerformance(0);
+        if (performance && performance->getGlobal()) {
+            auto dated = performance->getGlobal()->getDated();
+            
+            auto articulationMap = mpm::ArticulationMap::createArticulationMap();
+            mpm::ArticulationData accentData;
+            accentData.date = 480.0;
+            accentData.relativeDuration = 0.8;
+            accentData.absoluteVelocityChange = 12.0;
+            articulationMap->addArticulation(accentData);
+            dated->addMap(std::move(articulationMap));
+            
+            auto rubatoMap = mpm::RubatoMap::createRubatoMap();
+            rubatoMap->addRubato(0.0, 960.0, 1.3, 0.0, 1.0, true, "rub");
+            dated->addMap(std::move(rubatoMap));
+            
+            // A map that cannot be swept splits the fused run
+            auto movementMap = mpm::MovementMap::createMovementMap();
+            movementMap->addMovement(0.0, "sustain", 0.0, 1.0, 0.5, 0.0, "pedal");
+            dated->addMap(std::move(movementMap));
+            
+            auto dynamicsMap = mpm::DynamicsMap::createDynamicsMap();
+            dynamicsMap->addDynamics(0.0, "50", "100", 0.4, 0.2);
+            dynamicsMap->addDynamics(1440.0, "100");
+            dated->addMap(std::move(dynamicsMap));
+            
+            auto accentuationMap = mpm::MetricalAccentuationMap::createMetricalAccentuationMap();
+            accentuationMap->addAccentuationPattern(0.0, "basicPattern", 8.0, true, true);
+            dated->addMap(std::move(accentuationMap));
+            
+            auto tempoMap = mpm::TempoMap::createTempoMap();
+            tempoMap->addTempo(0.0, "90", "120", 0.25, 0.5, "accel");
+            tempoMap->addTempo(1440.0, 120.0, 0.25);
+            dated->addMap(std::move(tempoMap));
+        }
+    }
+    
+    return mpm;
+}
+
 } // namespace test
 } // namespace meico
\ No newline at end of file
@@ -63,6 +63,13 @@ public:
      */
     static std::unique_ptr<mpm::Mpm> createMpmWithRubatoMap();
 
+    /**
+     * Creates an MPM document whose global dated environment combines several maps
+     * (articulation, rubato, a movement map in between, dynamics, metrical accentuation, tempo).
+     * @return MPM document with combined maps
+     */
+    static std::unique_ptr<mpm::Mpm> createMpmWithCombinedMaps();
+
     /**
      * Applies an MPM performance to an MSM and returns the result.
      * @param msm The input MSM